@@ -0,0 +1,34 @@
+#shader vertex
+#version 330 core 
+
+layout(location = 0) in vec4 position;
+layout(location = 1) in vec2 texCoord;
+//Per instance, a mat4 attribute takes the 4 locations 2 to 5
+layout(location = 2) in mat4 model;
+
+out vec2 v_TexCoord;
+
+uniform mat4 u_ViewProj;
+
+void main() 
+{ 
+	gl_Position = u_ViewProj * model * position; 
+	v_TexCoord = texCoord;
+};
+
+
+#shader fragment
+#version 330 core
+
+
+layout(location = 0) out vec4 color; 
+
+in vec2 v_TexCoord;
+
+uniform sampler2D u_Texture;
+
+void main() 
+{ 
+	vec4 texColor = texture(u_Texture, v_TexCoord);
+	color = texColor; 
+};
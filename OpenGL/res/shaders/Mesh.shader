@@ -0,0 +1,38 @@
+#shader vertex
+#version 330 core 
+
+layout(location = 0) in vec3 position;
+layout(location = 1) in vec2 texCoord;
+layout(location = 2) in vec3 normal;
+
+out vec2 v_TexCoord;
+out vec3 v_Normal;
+
+uniform mat4 u_MVP;
+
+void main() 
+{ 
+	gl_Position = u_MVP * vec4(position, 1.0); 
+	v_TexCoord = texCoord;
+	v_Normal = normal;
+};
+
+
+#shader fragment
+#version 330 core
+
+
+layout(location = 0) out vec4 color; 
+
+in vec2 v_TexCoord;
+in vec3 v_Normal;
+
+uniform sampler2D u_Texture;
+uniform vec3 u_LightDirection;
+
+void main() 
+{ 
+	float diffuse = max(dot(normalize(v_Normal), -u_LightDirection), 0.0);
+	vec4 texColor = texture(u_Texture, v_TexCoord);
+	color = vec4(texColor.rgb * (0.2 + 0.8 * diffuse), texColor.a); 
+};
@@ -0,0 +1,44 @@
+#shader vertex
+#version 330 core 
+#extension GL_ARB_shader_draw_parameters : enable
+
+layout(location = 0) in vec4 position;
+layout(location = 1) in vec2 texCoord;
+
+out vec2 v_TexCoord;
+
+uniform mat4 u_ViewProj;
+//Offset and scale of each draw, indexed by the draw id
+uniform vec4 u_DrawData[256];
+//Set by Renderer::DrawIndirect, 0 with multi draw indirect and the index of the draw in the fallback loop
+uniform int u_DrawID;
+
+#ifdef GL_ARB_shader_draw_parameters
+#define DRAW_ID (gl_DrawIDARB + u_DrawID)
+#else
+#define DRAW_ID u_DrawID
+#endif
+
+void main() 
+{ 
+	vec4 drawData = u_DrawData[DRAW_ID];
+	gl_Position = u_ViewProj * vec4(position.xy * drawData.z + drawData.xy, position.z, 1.0); 
+	v_TexCoord = texCoord;
+};
+
+
+#shader fragment
+#version 330 core
+
+
+layout(location = 0) out vec4 color; 
+
+in vec2 v_TexCoord;
+
+uniform sampler2D u_Texture;
+
+void main() 
+{ 
+	vec4 texColor = texture(u_Texture, v_TexCoord);
+	color = texColor; 
+};
@@ -0,0 +1,37 @@
+#shader vertex
+#version 330 core 
+
+layout(location = 0) in vec4 position;
+layout(location = 1) in vec2 texCoord;
+
+out vec2 v_TexCoord;
+out vec4 v_Color;
+
+//Same inputs as ObjectBlock.shader, set one by one with glUniform*
+uniform mat4 u_ViewProjection;
+uniform mat4 u_Model;
+uniform vec4 u_Color;
+
+void main() 
+{ 
+	gl_Position = u_ViewProjection * u_Model * position; 
+	v_TexCoord = texCoord;
+	v_Color = u_Color;
+};
+
+
+#shader fragment
+#version 330 core
+
+
+layout(location = 0) out vec4 color; 
+
+in vec2 v_TexCoord;
+in vec4 v_Color;
+
+uniform sampler2D u_Texture;
+
+void main() 
+{ 
+	color = texture(u_Texture, v_TexCoord) * v_Color; 
+};
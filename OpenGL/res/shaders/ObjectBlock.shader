@@ -0,0 +1,51 @@
+#shader vertex
+#version 330 core 
+
+layout(location = 0) in vec4 position;
+layout(location = 1) in vec2 texCoord;
+
+out vec2 v_TexCoord;
+out vec4 v_Color;
+
+//Updated once per frame, see UniformBuffer
+layout(std140) uniform Camera
+{
+	mat4 u_ViewProjection;
+	vec3 u_CameraPosition;
+	float u_Time;
+};
+
+//One range of a UniformRingBuffer per draw. The members after u_Color aren't read, std140 keeps them active so the
+//benchmark can check the packing of matrices and arrays against the driver's offsets
+layout(std140) uniform Object
+{
+	mat4 u_Model;
+	vec4 u_Color;
+	mat3 u_Normal;
+	float u_Fade[2];
+	vec2 u_UvOffset;
+};
+
+void main() 
+{ 
+	gl_Position = u_ViewProjection * u_Model * position; 
+	v_TexCoord = texCoord;
+	v_Color = u_Color;
+};
+
+
+#shader fragment
+#version 330 core
+
+
+layout(location = 0) out vec4 color; 
+
+in vec2 v_TexCoord;
+in vec4 v_Color;
+
+uniform sampler2D u_Texture;
+
+void main() 
+{ 
+	color = texture(u_Texture, v_TexCoord) * v_Color; 
+};
@@ -6,55 +6,164 @@
 #include "Renderer.h"
 
 #include <GLFW/glfw3.h>
+#include <chrono>
+#include <cstdlib>
 #include <iostream>
+#include <memory>
 #include <string>
+#include <vector>
 
 #include "VertexBuffer.h"
 #include "VertexBufferLayout.h"
 #include "IndexBuffer.h"
 #include "VertexArray.h"
+#include "VertexFormatCache.h"
 #include "Shader.h"
 #include "Texture.h"
+#include "Framebuffer.h"
+#include "HeadlessContext.h"
+#include "Benchmark.h"
+#include "CacheDirectory.h"
+#include "GLTraceReplay.h"
 
 #include "glm/glm.hpp"
 #include "glm/gtc/matrix_transform.hpp"
 
 
 
-int main(void)
+/* @brief: The offscreen target has to go before the context that owns it
+*/
+static int Shutdown(std::unique_ptr<Framebuffer>& target, HeadlessContext& headless, int result)
 {
-    GLFWwindow* window;
-
-    /* Initialize the library */
-    if (!glfwInit())
-        return -1;
-
-    glfwWindowHint(GLFW_CONTEXT_VERSION_MAJOR, 3);
-    glfwWindowHint(GLFW_CONTEXT_VERSION_MINOR, 3);
-    glfwWindowHint(GLFW_OPENGL_PROFILE, GLFW_OPENGL_CORE_PROFILE);
-
+    target.reset();
+    VertexFormatCache::Get().Clear();
+    headless.Destroy();
+    glfwTerminate();
+    return result;
+}
 
-    /* Create a windowed mode window and its OpenGL context */
-    window = glfwCreateWindow(640, 480, "Hello World", NULL, NULL);
-    if (!window)
+int main(int argc, char** argv)
+{
+    GLFWwindow* window = nullptr;
+    HeadlessContext headless;
+    std::unique_ptr<Framebuffer> target;
+
+    /* Command line modes, the scene is shown when none is given:
+         --headless [frames]    renders the scene offscreen for a number of frames (1000 by default) and prints frame times
+         --bench-<name>         runs a benchmark offscreen (e.g. --bench-batch)
+         --trace <file>         records the GL calls of the scene to file (builds with OGL_TRACE only)
+         --replay <file>        replays a trace offscreen and prints the cost of each call type
+         --profile <file>       writes a Chrome trace of the scene to file and prints the scope timings */
+    std::string mode = argc > 1 ? argv[1] : "";
+    std::string modeArg = argc > 2 ? argv[2] : "";
+    bool benchmark = mode.compare(0, 8, "--bench-") == 0;
+    //Offscreen modes don't open a window, they run in a headless context and draw into a framebuffer
+    bool hidden = benchmark || mode == "--replay" || mode == "--headless";
+    int headlessFrames = mode == "--headless" && !modeArg.empty() ? std::atoi(modeArg.c_str()) : 1000;
+
+    if (benchmark && !BenchmarkNeedsContext(mode))
+        return RunBenchmark(mode);
+
+#ifdef OGL_DEBUG
+    //Needed for the driver to report errors through KHR_debug
+    bool debugContext = true;
+#else
+    bool debugContext = false;
+#endif
+
+    if (hidden)
     {
-        glfwTerminate();
-        return -1;
+        //No vsync there, nothing gets presented
+        if (!headless.Create(3, 3, debugContext))
+            return -1;
+        LOG(headless.GetBackendName());
     }
+    else
+    {
+        /* Initialize the library */
+        if (!glfwInit())
+            return -1;
+
+        glfwWindowHint(GLFW_CONTEXT_VERSION_MAJOR, 3);
+        glfwWindowHint(GLFW_CONTEXT_VERSION_MINOR, 3);
+        glfwWindowHint(GLFW_OPENGL_PROFILE, GLFW_OPENGL_CORE_PROFILE);
+        glfwWindowHint(GLFW_OPENGL_DEBUG_CONTEXT, debugContext ? GLFW_TRUE : GLFW_FALSE);
+
+        /* Create a windowed mode window and its OpenGL context */
+        window = glfwCreateWindow(640, 480, "Hello World", NULL, NULL);
+        if (!window)
+        {
+            glfwTerminate();
+            return -1;
+        }
 
-    /* Make the window's context current */
-    glfwMakeContextCurrent(window);
-
-
-    glfwSwapInterval(1);
+        /* Make the window's context current */
+        glfwMakeContextCurrent(window);
+        glfwSwapInterval(1);
+    }
 
     //Verify that glew init succeeds, which makes the link between the openGL implementation of the hardware and the standard function calls.
-    if (glewInit() != GLEW_OK) {
+    //A GLX-built glew can't find a display under EGL, the GL entry points are loaded by then so it's fine
+    GLenum glewStatus = glewInit();
+    if (glewStatus != GLEW_OK && !(hidden && glewStatus == GLEW_ERROR_NO_GLX_DISPLAY)) {
         LOG("Error! glew init went wrong.");
     }
     else {
         LOG(glGetString(GL_VERSION));
+#ifdef OGL_DEBUG
+        if (!GLEnableDebugOutput(GLDebugSeverity::Low, true))
+            LOG("KHR_debug unavailable, falling back to glGetError checks.");
+#endif
+        //Before any buffer, vertex array or texture gets created, they're edited the way they were created
+        if (GLSelectDirectStateAccess())
+        {
+            LOG("Direct state access enabled.");
+        }
+    }
+
+    if (hidden)
+    {
+        //Without a window there is no default framebuffer to draw into
+        target.reset(new Framebuffer(640, 480));
+        if (!target->IsComplete())
+        {
+            LOG("Error! the offscreen framebuffer is incomplete.");
+            return Shutdown(target, headless, -1);
+        }
+        target->Bind();
     }
+
+    //What uploads fastest differs a lot between drivers, it's measured once per driver
+    if (mode != "--replay")
+        SelectUploadStrategy(GetCacheDirectory() + "/upload_strategy.txt");
+
+    if (benchmark)
+        return Shutdown(target, headless, RunBenchmark(mode));
+
+    if (mode == "--replay")
+    {
+        GLTraceReplay replay;
+        if (!replay.Load(modeArg))
+        {
+            std::cout << "Couldn't read trace '" << modeArg << "'" << std::endl;
+            return Shutdown(target, headless, -1);
+        }
+        replay.Run();
+        replay.PrintStats();
+        return Shutdown(target, headless, 0);
+    }
+
+#ifdef OGL_TRACE
+    if (mode == "--trace" && !GLTrace::Begin(modeArg))
+        std::cout << "Couldn't open trace '" << modeArg << "'" << std::endl;
+#endif
+
+    if (mode == "--profile")
+    {
+        Profiler::Get().SetEnabled(true);
+        Profiler::Get().StartCapture();
+    }
+
     {
         //Vertices position for our triangle
         float positions[] = {
@@ -105,9 +214,12 @@ int main(void)
         *****************************************************************/
 
         Renderer renderer;
-        while (!glfwWindowShouldClose(window))
+        std::vector<double> frameTimes;
+        auto frameStart = std::chrono::high_resolution_clock::now();
+        while (window ? !glfwWindowShouldClose(window) : (int)frameTimes.size() < headlessFrames)
         {
             /* Render here */
+            Profiler::Get().BeginFrame();
 
             renderer.Clear();
             //Giving the location and value, we are setting the uniform
@@ -115,15 +227,41 @@ int main(void)
 
             renderer.Draw(va, ib, shader);
 
-            /* Swap front and back buffers */
-            glfwSwapBuffers(window);
-
-            /* Poll for and process events */
-            glfwPollEvents();
+            Profiler::Get().EndFrame();
+            BufferUploader::Get().EndFrame();
+
+            if (window)
+            {
+                /* Swap front and back buffers */
+                glfwSwapBuffers(window);
+
+                /* Poll for and process events */
+                glfwPollEvents();
+            }
+            else
+            {
+                //Nothing is presented, waiting for the GPU is what makes the frame times honest
+                GLCall(glFinish());
+                auto frameEnd = std::chrono::high_resolution_clock::now();
+                frameTimes.push_back(std::chrono::duration<double, std::milli>(frameEnd - frameStart).count());
+                frameStart = frameEnd;
+            }
         }
+
+        if (!window)
+            PrintFrameTimes("Headless", frameTimes);
     }
 
+#ifdef OGL_TRACE
+    GLTrace::End();
+#endif
+    if (mode == "--profile")
+    {
+        Profiler::Get().PrintSummary();
+        if (!Profiler::Get().WriteChromeTrace(modeArg))
+            std::cout << "Couldn't write profile '" << modeArg << "'" << std::endl;
+    }
 
-    glfwTerminate();
-    return 0;
+
+    return Shutdown(target, headless, 0);
 }
\ No newline at end of file
@@ -0,0 +1,144 @@
+#include "BatchRenderer.h"
+#include "VertexBufferLayout.h"
+
+#include <cstring>
+
+static const unsigned char s_WhitePixel[4] = { 255, 255, 255, 255 };
+
+BatchRenderer::BatchRenderer(const Renderer& renderer, const std::string& shaderPath, unsigned int maxQuads)
+    : m_Renderer(renderer), m_MaxQuads(maxQuads),
+      m_VertexBuffer(maxQuads * 4 * sizeof(QuadVertex), StreamingVertexBuffer::MaxRegions),
+      m_IndexBuffer(GenerateQuadIndices(maxQuads).data(), maxQuads * 6),
+      m_Shader(shaderPath),
+      m_WhiteTexture(1, 1, s_WhitePixel),
+      m_TextureSlotCount(0)
+{
+    constexpr auto layout = MakeVertexLayout<QuadVertex>(
+        VERTEX_ATTRIBUTE(QuadVertex, Position),
+        VERTEX_ATTRIBUTE(QuadVertex, Color),
+        VERTEX_ATTRIBUTE(QuadVertex, TexCoord),
+        VERTEX_ATTRIBUTE(QuadVertex, TexIndex));
+    m_VertexArray.AddBuffer(m_VertexBuffer.GetVertexBuffer(), layout);
+
+    m_Vertices.reserve(maxQuads * 4);
+
+    //Every sampler of the array points to the texture unit with the same index
+    int samplers[MaxTextureSlots];
+    for (unsigned int i = 0; i < MaxTextureSlots; i++)
+        samplers[i] = i;
+
+    m_Shader.Bind();
+    m_Shader.SetUniform1iv("u_Textures", MaxTextureSlots, samplers);
+    m_ViewProjection = m_Shader.GetUniformHandle("u_ViewProj");
+
+    m_VertexArray.Unbind();
+    m_VertexBuffer.Unbind();
+    m_IndexBuffer.Unbind();
+    m_Shader.Unbind();
+}
+
+/* @brief: Every quad uses the same 2 triangles so the index buffer is built once and shared by all the batches
+*/
+std::vector<unsigned int> BatchRenderer::GenerateQuadIndices(unsigned int maxQuads)
+{
+    std::vector<unsigned int> indices(maxQuads * 6);
+    unsigned int offset = 0;
+    for (unsigned int i = 0; i < indices.size(); i += 6)
+    {
+        indices[i + 0] = offset + 0;
+        indices[i + 1] = offset + 1;
+        indices[i + 2] = offset + 2;
+
+        indices[i + 3] = offset + 2;
+        indices[i + 4] = offset + 3;
+        indices[i + 5] = offset + 0;
+
+        offset += 4;
+    }
+    return indices;
+}
+
+void BatchRenderer::Begin(const glm::mat4& viewProjection)
+{
+    m_Shader.Bind();
+    m_Shader.SetUniformMat4f(m_ViewProjection, viewProjection);
+
+    m_Vertices.clear();
+    //Slot 0 is always the white texture used by untextured quads
+    m_TextureSlots[0] = &m_WhiteTexture;
+    m_TextureSlotCount = 1;
+}
+
+void BatchRenderer::End()
+{
+    Flush();
+    m_VertexBuffer.EndFrame();
+}
+
+void BatchRenderer::Flush()
+{
+    if (m_Vertices.empty())
+        return;
+
+    //Each batch goes after the previous ones in the streaming buffer, the draw picks it up through the base vertex
+    unsigned int size = (unsigned int)(m_Vertices.size() * sizeof(QuadVertex));
+    memcpy(m_VertexBuffer.Map(size), m_Vertices.data(), size);
+    int baseVertex = (int)(m_VertexBuffer.Unmap() / sizeof(QuadVertex));
+
+    for (unsigned int i = 0; i < m_TextureSlotCount; i++)
+        m_TextureSlots[i]->Bind(i);
+
+    unsigned int quadCount = (unsigned int)m_Vertices.size() / 4;
+    m_Renderer.Draw(m_VertexArray, m_IndexBuffer, m_Shader, quadCount * 6, baseVertex);
+
+    m_Stats.DrawCalls++;
+    m_Stats.QuadCount += quadCount;
+
+    m_Vertices.clear();
+    m_TextureSlotCount = 1;
+}
+
+/* @brief: Returns the slot of the texture in the current batch, flushing first if every slot is already taken
+*/
+float BatchRenderer::GetTextureIndex(const Texture& texture)
+{
+    for (unsigned int i = 1; i < m_TextureSlotCount; i++)
+    {
+        if (m_TextureSlots[i]->GetRendererID() == texture.GetRendererID())
+            return (float)i;
+    }
+
+    if (m_TextureSlotCount == MaxTextureSlots)
+        Flush();
+
+    m_TextureSlots[m_TextureSlotCount] = &texture;
+    return (float)m_TextureSlotCount++;
+}
+
+void BatchRenderer::PushQuad(const glm::vec2& position, const glm::vec2& size, const glm::vec4& color, float texIndex)
+{
+    if (m_Vertices.size() == m_MaxQuads * 4)
+        Flush();
+
+    m_Vertices.push_back({ { position.x,          position.y,          0.0f }, color, { 0.0f, 0.0f }, texIndex });
+    m_Vertices.push_back({ { position.x + size.x, position.y,          0.0f }, color, { 1.0f, 0.0f }, texIndex });
+    m_Vertices.push_back({ { position.x + size.x, position.y + size.y, 0.0f }, color, { 1.0f, 1.0f }, texIndex });
+    m_Vertices.push_back({ { position.x,          position.y + size.y, 0.0f }, color, { 0.0f, 1.0f }, texIndex });
+}
+
+void BatchRenderer::DrawQuad(const glm::vec2& position, const glm::vec2& size, const glm::vec4& color)
+{
+    PushQuad(position, size, color, 0.0f);
+}
+
+void BatchRenderer::DrawQuad(const glm::vec2& position, const glm::vec2& size, const Texture& texture, const glm::vec4& tint)
+{
+    //The slot has to be resolved before the vertex capacity check, a flush there would drop the texture from the batch otherwise
+    float texIndex = GetTextureIndex(texture);
+    if (m_Vertices.size() == m_MaxQuads * 4)
+    {
+        Flush();
+        texIndex = GetTextureIndex(texture);
+    }
+    PushQuad(position, size, tint, texIndex);
+}
@@ -0,0 +1,62 @@
+#pragma once
+#include <string>
+#include <vector>
+
+#include "Renderer.h"
+#include "StreamingVertexBuffer.h"
+#include "Texture.h"
+
+#include "glm/glm.hpp"
+
+struct QuadVertex {
+	glm::vec3 Position;
+	glm::vec4 Color;
+	glm::vec2 TexCoord;
+	float TexIndex;
+};
+
+/* Accumulates quads into a single dynamic vertex buffer and draws them with one call per batch.
+   A batch is flushed when its vertex storage or its texture slots are full, or when End() is called. */
+class BatchRenderer {
+public:
+	static const unsigned int MaxTextureSlots = 16;
+
+	struct Stats {
+		unsigned int DrawCalls = 0;
+		unsigned int QuadCount = 0;
+	};
+
+private:
+	const Renderer& m_Renderer;
+	unsigned int m_MaxQuads;
+
+	VertexArray m_VertexArray;
+	StreamingVertexBuffer m_VertexBuffer;
+	IndexBuffer m_IndexBuffer;
+	Shader m_Shader;
+	UniformHandle m_ViewProjection;
+	Texture m_WhiteTexture;
+
+	std::vector<QuadVertex> m_Vertices;
+	const Texture* m_TextureSlots[MaxTextureSlots];
+	unsigned int m_TextureSlotCount;
+
+	Stats m_Stats;
+
+	static std::vector<unsigned int> GenerateQuadIndices(unsigned int maxQuads);
+	float GetTextureIndex(const Texture& texture);
+	void PushQuad(const glm::vec2& position, const glm::vec2& size, const glm::vec4& color, float texIndex);
+	void Flush();
+
+public:
+	BatchRenderer(const Renderer& renderer, const std::string& shaderPath, unsigned int maxQuads = 10000);
+
+	void Begin(const glm::mat4& viewProjection);
+	void DrawQuad(const glm::vec2& position, const glm::vec2& size, const glm::vec4& color);
+	void DrawQuad(const glm::vec2& position, const glm::vec2& size, const Texture& texture, const glm::vec4& tint = glm::vec4(1.0f));
+	void End();
+
+	inline const Stats& GetStats() const { return m_Stats; }
+	inline void ResetStats() { m_Stats = Stats(); }
+	inline const StreamingVertexBuffer& GetVertexBuffer() const { return m_VertexBuffer; }
+};
@@ -0,0 +1,2049 @@
+#include "Benchmark.h"
+#include "Renderer.h"
+#include "BatchRenderer.h"
+#include "VertexBufferLayout.h"
+#include "Texture.h"
+#include "CommandBuffer.h"
+#include "StreamingVertexBuffer.h"
+#include "GpuBufferArena.h"
+#include "MeshOptimizer.h"
+#include "VertexQuantization.h"
+#include "LodMesh.h"
+#include "ResourcePool.h"
+#include "VertexFormatCache.h"
+#include "ShaderBinaryCache.h"
+#include "ShaderCompileQueue.h"
+#include "UniformBuffer.h"
+
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <cstddef>
+#include <cstring>
+#include <fstream>
+#include <iostream>
+#include <iterator>
+#include <memory>
+#include <thread>
+#include <unordered_map>
+#include <vector>
+
+#include "glm/glm.hpp"
+#include "glm/gtc/matrix_transform.hpp"
+
+class Timer {
+private:
+    std::chrono::high_resolution_clock::time_point m_Start;
+public:
+    Timer() : m_Start(std::chrono::high_resolution_clock::now()) {}
+
+    double ElapsedMs() const
+    {
+        return std::chrono::duration<double, std::milli>(std::chrono::high_resolution_clock::now() - m_Start).count();
+    }
+};
+
+/* @brief: Draws quadCount textured quads per frame, once with one Renderer::Draw per quad like Application.cpp does
+           for its single quad, then through the BatchRenderer. CPU time is the submission time, GPU work is waited on
+           with glFinish outside of it.
+*/
+static int BenchmarkBatchRenderer(unsigned int quadCount, unsigned int frames)
+{
+    Renderer renderer;
+    Texture texture("res/textures/clouds.png");
+    glm::mat4 proj = glm::ortho(0.0f, 1000.0f, 0.0f, 1000.0f, -1.0f, 1.0f);
+
+    std::cout << "Batch benchmark: " << quadCount << " quads, " << frames << " frames" << std::endl;
+
+    {
+        float positions[] = {
+            0.0f, 0.0f, 0.0f, 0.0f, 0.0f,
+            1.0f, 0.0f, 0.0f, 1.0f, 0.0f,
+            1.0f, 1.0f, 0.0f, 1.0f, 1.0f,
+            0.0f, 1.0f, 0.0f, 0.0f, 1.0f
+        };
+        unsigned int indices[] = { 0, 1, 2, 2, 3, 0 };
+
+        VertexArray va;
+        VertexBuffer vb(positions, 5 * 4 * sizeof(float));
+        VertexBufferLayout layout;
+        layout.Push<float>(3);
+        layout.Push<float>(2);
+        va.AddBuffer(vb, layout);
+        IndexBuffer ib(indices, 6);
+
+        Shader shader("res/shaders/Basic.shader");
+        shader.Bind();
+        shader.SetUniform1i("u_Texture", 0);
+        texture.Bind();
+
+        GLStateCache::Get().ResetCounters();
+        double cpuMs = 0.0;
+        for (unsigned int frame = 0; frame < frames; frame++)
+        {
+            Timer timer;
+            renderer.Clear();
+            for (unsigned int i = 0; i < quadCount; i++)
+            {
+                glm::vec3 translation((float)(i % 1000), (float)((i / 1000) % 1000), 0.0f);
+                shader.SetUniformMat4f("u_MVP", glm::translate(proj, translation));
+                renderer.Draw(va, ib, shader);
+            }
+            cpuMs += timer.ElapsedMs();
+            GLCall(glFinish());
+        }
+        std::cout << "  Renderer::Draw per quad: " << quadCount << " draw calls, "
+            << cpuMs / frames << " CPU ms/frame, "
+            << GLStateCache::Get().GetSkippedCalls() / frames << " redundant binds skipped/frame" << std::endl;
+    }
+
+    {
+        BatchRenderer batch(renderer, "res/shaders/Batch.shader");
+
+        GLStateCache::Get().ResetCounters();
+        double cpuMs = 0.0;
+        for (unsigned int frame = 0; frame < frames; frame++)
+        {
+            batch.ResetStats();
+            Timer timer;
+            renderer.Clear();
+            batch.Begin(proj);
+            for (unsigned int i = 0; i < quadCount; i++)
+            {
+                glm::vec2 position((float)(i % 1000), (float)((i / 1000) % 1000));
+                batch.DrawQuad(position, glm::vec2(1.0f), texture);
+            }
+            batch.End();
+            cpuMs += timer.ElapsedMs();
+            GLCall(glFinish());
+        }
+        std::cout << "  BatchRenderer:           " << batch.GetStats().DrawCalls << " draw calls, "
+            << cpuMs / frames << " CPU ms/frame, "
+            << GLStateCache::Get().GetSkippedCalls() / frames << " redundant binds skipped/frame, "
+            << batch.GetVertexBuffer().GetStallCount() << " streaming stalls" << std::endl;
+    }
+
+    return 0;
+}
+
+/* @brief: Draws instanceCount copies of the textured quad of Application.cpp, first with one Renderer::Draw per copy,
+           then with a single Renderer::DrawInstanced fed by a per-instance buffer of model matrices.
+*/
+static int BenchmarkInstancing(unsigned int instanceCount, unsigned int frames)
+{
+    Renderer renderer;
+    Texture texture("res/textures/clouds.png");
+    glm::mat4 proj = glm::ortho(0.0f, 1000.0f, 0.0f, 1000.0f, -1.0f, 1.0f);
+
+    float positions[] = {
+        0.0f, 0.0f, 0.0f, 0.0f, 0.0f,
+        1.0f, 0.0f, 0.0f, 1.0f, 0.0f,
+        1.0f, 1.0f, 0.0f, 1.0f, 1.0f,
+        0.0f, 1.0f, 0.0f, 0.0f, 1.0f
+    };
+    unsigned int indices[] = { 0, 1, 2, 2, 3, 0 };
+
+    std::vector<glm::mat4> models(instanceCount);
+    for (unsigned int i = 0; i < instanceCount; i++)
+        models[i] = glm::translate(glm::mat4(1.0f), glm::vec3((float)(i % 1000), (float)((i / 1000) % 1000), 0.0f));
+
+    std::cout << "Instancing benchmark: " << instanceCount << " quads, " << frames << " frames" << std::endl;
+
+    VertexBuffer vb(positions, 5 * 4 * sizeof(float));
+    VertexBufferLayout layout;
+    layout.Push<float>(3);
+    layout.Push<float>(2);
+    IndexBuffer ib(indices, 6);
+    texture.Bind();
+
+    {
+        VertexArray va;
+        va.AddBuffer(vb, layout);
+
+        Shader shader("res/shaders/Basic.shader");
+        shader.Bind();
+        shader.SetUniform1i("u_Texture", 0);
+
+        double cpuMs = 0.0;
+        for (unsigned int frame = 0; frame < frames; frame++)
+        {
+            Timer timer;
+            renderer.Clear();
+            for (unsigned int i = 0; i < instanceCount; i++)
+            {
+                shader.SetUniformMat4f("u_MVP", proj * models[i]);
+                renderer.Draw(va, ib, shader);
+            }
+            cpuMs += timer.ElapsedMs();
+            GLCall(glFinish());
+        }
+        std::cout << "  Renderer::Draw per quad: " << instanceCount << " draw calls, "
+            << cpuMs / frames << " CPU ms/frame" << std::endl;
+    }
+
+    {
+        VertexBuffer instanceVb(models.data(), instanceCount * (unsigned int)sizeof(glm::mat4));
+        VertexBufferLayout instanceLayout;
+        for (int column = 0; column < 4; column++)
+            instanceLayout.PushInstanced<float>(4);
+
+        VertexArray va;
+        va.AddBuffer(vb, layout);
+        va.AddBuffer(instanceVb, instanceLayout, 2);
+
+        Shader shader("res/shaders/Instanced.shader");
+        shader.Bind();
+        shader.SetUniform1i("u_Texture", 0);
+        shader.SetUniformMat4f("u_ViewProj", proj);
+
+        double cpuMs = 0.0;
+        for (unsigned int frame = 0; frame < frames; frame++)
+        {
+            Timer timer;
+            renderer.Clear();
+            renderer.DrawInstanced(va, ib, shader, instanceCount);
+            cpuMs += timer.ElapsedMs();
+            GLCall(glFinish());
+        }
+        std::cout << "  Renderer::DrawInstanced: 1 draw call, " << cpuMs / frames << " CPU ms/frame" << std::endl;
+    }
+
+    return 0;
+}
+
+/* @brief: Draws meshCount separate meshes per frame, first each with its own VertexArray/IndexBuffer and a
+           Renderer::Draw, then packed in one shared vertex/index buffer and issued with Renderer::DrawIndirect
+           (multi draw indirect, or its glDrawElementsInstancedBaseVertex fallback). The indirect timing includes
+           rebuilding and uploading the command array every frame.
+*/
+static int BenchmarkMultiDrawIndirect(unsigned int meshCount, unsigned int frames)
+{
+    Renderer renderer;
+    Texture texture("res/textures/clouds.png");
+    glm::mat4 proj = glm::ortho(0.0f, 16.0f, 0.0f, 16.0f, -1.0f, 1.0f);
+    texture.Bind();
+
+    std::cout << "Multi draw indirect benchmark: " << meshCount << " meshes, " << frames << " frames, "
+        << (IndirectDrawBuffer::IsMultiDrawSupported() ? "glMultiDrawElementsIndirect" : "glDrawElementsInstancedBaseVertex fallback")
+        << std::endl;
+
+    float quad[] = {
+        0.0f, 0.0f, 0.0f, 0.0f, 0.0f,
+        1.0f, 0.0f, 0.0f, 1.0f, 0.0f,
+        1.0f, 1.0f, 0.0f, 1.0f, 1.0f,
+        0.0f, 1.0f, 0.0f, 0.0f, 1.0f
+    };
+    unsigned int quadIndices[] = { 0, 1, 2, 2, 3, 0 };
+
+    VertexBufferLayout layout;
+    layout.Push<float>(3);
+    layout.Push<float>(2);
+
+    {
+        std::vector<std::unique_ptr<VertexArray>> vertexArrays;
+        std::vector<std::unique_ptr<VertexBuffer>> vertexBuffers;
+        std::vector<std::unique_ptr<IndexBuffer>> indexBuffers;
+        for (unsigned int i = 0; i < meshCount; i++)
+        {
+            vertexArrays.emplace_back(new VertexArray());
+            vertexBuffers.emplace_back(new VertexBuffer(quad, sizeof(quad)));
+            vertexArrays.back()->AddBuffer(*vertexBuffers.back(), layout);
+            indexBuffers.emplace_back(new IndexBuffer(quadIndices, 6));
+        }
+
+        Shader shader("res/shaders/Basic.shader");
+        shader.Bind();
+        shader.SetUniform1i("u_Texture", 0);
+
+        double cpuMs = 0.0;
+        for (unsigned int frame = 0; frame < frames; frame++)
+        {
+            Timer timer;
+            renderer.Clear();
+            for (unsigned int i = 0; i < meshCount; i++)
+            {
+                glm::vec3 translation((float)(i % 16), (float)((i / 16) % 16), 0.0f);
+                shader.SetUniformMat4f("u_MVP", glm::scale(glm::translate(proj, translation), glm::vec3(0.9f)));
+                renderer.Draw(*vertexArrays[i], *indexBuffers[i], shader);
+            }
+            cpuMs += timer.ElapsedMs();
+            GLCall(glFinish());
+        }
+        std::cout << "  Renderer::Draw per mesh: " << cpuMs / frames << " CPU ms/frame" << std::endl;
+    }
+
+    {
+        std::vector<float> vertices;
+        std::vector<unsigned int> indices;
+        std::vector<glm::vec4> drawData;
+        for (unsigned int i = 0; i < meshCount; i++)
+        {
+            vertices.insert(vertices.end(), quad, quad + 20);
+            indices.insert(indices.end(), quadIndices, quadIndices + 6);
+            drawData.push_back(glm::vec4((float)(i % 16), (float)((i / 16) % 16), 0.9f, 0.0f));
+        }
+
+        VertexArray va;
+        VertexBuffer vb(vertices.data(), (unsigned int)(vertices.size() * sizeof(float)));
+        va.AddBuffer(vb, layout);
+        IndexBuffer ib(indices.data(), (unsigned int)indices.size());
+
+        Shader shader("res/shaders/MultiDraw.shader");
+        shader.Bind();
+        shader.SetUniform1i("u_Texture", 0);
+        shader.SetUniformMat4f("u_ViewProj", proj);
+        GLCall(glUniform4fv(shader.GetUniformLocation("u_DrawData"), (int)drawData.size(), &drawData[0][0]));
+
+        IndirectDrawBuffer commands;
+        double cpuMs = 0.0;
+        for (unsigned int frame = 0; frame < frames; frame++)
+        {
+            Timer timer;
+            renderer.Clear();
+            commands.Clear();
+            for (unsigned int i = 0; i < meshCount; i++)
+                commands.AddDraw(6, i * 6, i * 4);
+            commands.Upload();
+            renderer.DrawIndirect(va, ib, shader, commands);
+            cpuMs += timer.ElapsedMs();
+            GLCall(glFinish());
+        }
+        std::cout << "  Renderer::DrawIndirect:  " << cpuMs / frames << " CPU ms/frame" << std::endl;
+    }
+
+    return 0;
+}
+
+//Small deterministic generator so every run sorts the same data
+static unsigned int NextRandom(unsigned int& state)
+{
+    state = state * 1664525u + 1013904223u;
+    return state >> 8;
+}
+
+static unsigned int CountStateChanges(const DrawQueue& queue)
+{
+    unsigned int changes = 0;
+    unsigned int program = 0, texture = 0;
+    for (unsigned int i = 0; i < queue.GetSize(); i++)
+    {
+        const DrawItem& item = queue.GetSortedItem(i);
+        if (item.Program != program) changes++;
+        if (item.Textures[0] != texture) changes++;
+        program = item.Program;
+        texture = item.Textures[0];
+    }
+    return changes;
+}
+
+/* @brief: Submits itemCount draws with random layer/program/texture/depth and a matrix uniform each, then sorts them.
+           Nothing is executed so it doesn't need a GL context.
+*/
+static int BenchmarkDrawQueue(unsigned int itemCount, unsigned int iterations)
+{
+    std::cout << "Draw queue benchmark: " << itemCount << " items, " << iterations << " iterations" << std::endl;
+
+    DrawQueue queue;
+    UniformBlob uniforms;
+    glm::mat4 mvp(1.0f);
+
+    double submitMs = 0.0, sortMs = 0.0;
+    unsigned int unsortedChanges = 0, sortedChanges = 0;
+    for (unsigned int iteration = 0; iteration < iterations; iteration++)
+    {
+        unsigned int seed = 1234;
+        queue.Clear();
+
+        Timer submitTimer;
+        for (unsigned int i = 0; i < itemCount; i++)
+        {
+            DrawItem item = {};
+            item.Program = 1 + NextRandom(seed) % 64;
+            item.VertexArray = 1 + NextRandom(seed) % 1024;
+            item.IndexBuffer = item.VertexArray;
+            item.IndexCount = 6;
+            item.IndexType = GL_UNSIGNED_SHORT;
+            item.Textures[0] = 1 + NextRandom(seed) % 256;
+            float depth = (NextRandom(seed) % 10000) / 10000.0f;
+            item.SortKey = DrawQueue::MakeSortKey(NextRandom(seed) % 4, item.Program, item.Textures[0], depth);
+
+            uniforms.Clear();
+            uniforms.SetUniformMat4f(0, mvp);
+            queue.Submit(item, &uniforms);
+        }
+        submitMs += submitTimer.ElapsedMs();
+
+        Timer sortTimer;
+        queue.Sort();
+        sortMs += sortTimer.ElapsedMs();
+
+        if (iteration == 0)
+        {
+            for (unsigned int i = 1; i < queue.GetSize(); i++)
+                ASSERT(queue.GetSortedItem(i - 1).SortKey <= queue.GetSortedItem(i).SortKey);
+        }
+
+        sortedChanges = CountStateChanges(queue);
+    }
+
+    //Submission order is what a renderer without the queue would have executed
+    {
+        unsigned int seed = 1234, program = 0, texture = 0;
+        for (unsigned int i = 0; i < itemCount; i++)
+        {
+            unsigned int itemProgram = 1 + NextRandom(seed) % 64;
+            NextRandom(seed);
+            unsigned int itemTexture = 1 + NextRandom(seed) % 256;
+            NextRandom(seed);
+            NextRandom(seed);
+            if (itemProgram != program) unsortedChanges++;
+            if (itemTexture != texture) unsortedChanges++;
+            program = itemProgram;
+            texture = itemTexture;
+        }
+    }
+
+    std::cout << "  Submit: " << submitMs / iterations << " ms, sort: " << sortMs / iterations << " ms" << std::endl;
+    std::cout << "  Program/texture changes: " << unsortedChanges << " in submission order, "
+        << sortedChanges << " in key order" << std::endl;
+    return 0;
+}
+
+/* @brief: Records the same scene traversal on 1 thread and on threadCount threads, replays both into a
+           RecordingCommandBackend and checks the merged streams are identical. Doesn't need a GL context.
+*/
+static int BenchmarkCommandRecording(unsigned int objectCount, unsigned int threadCount)
+{
+    std::cout << "Command recording benchmark: " << objectCount << " objects, 1 vs "
+        << threadCount << " threads" << std::endl;
+
+    //Stand-in for the per object work (culling, matrix updates...) done while traversing the scene
+    auto recordObject = [](CommandBuffer& commands, unsigned int object) {
+        glm::mat4 model = glm::translate(glm::mat4(1.0f), glm::vec3((float)(object % 1000), (float)(object / 1000), 0.0f));
+        glm::mat4 mvp = glm::ortho(0.0f, 1000.0f, 0.0f, 1000.0f, -1.0f, 1.0f) * model;
+        commands.UseProgram(1 + object % 8);
+        commands.BindVertexArray(1 + object % 64);
+        commands.BindIndexBuffer(1 + object % 64);
+        commands.BindTexture(0, 1 + object % 32);
+        commands.SetUniformMat4f(0, mvp);
+        commands.DrawIndexed(6, GL_UNSIGNED_SHORT);
+    };
+
+    ParallelCommandRecorder serial, parallel;
+
+    Timer serialTimer;
+    serial.Record(objectCount, 1, recordObject);
+    double serialMs = serialTimer.ElapsedMs();
+
+    Timer parallelTimer;
+    parallel.Record(objectCount, threadCount, recordObject);
+    double parallelMs = parallelTimer.ElapsedMs();
+
+    RecordingCommandBackend serialReplay, parallelReplay;
+    Timer replayTimer;
+    serial.Replay(serialReplay);
+    double replayMs = replayTimer.ElapsedMs();
+    parallel.Replay(parallelReplay);
+
+    bool identical = serialReplay.GetCommands().size() == parallelReplay.GetCommands().size();
+    for (size_t i = 0; identical && i < serialReplay.GetCommands().size(); i++)
+        identical = serialReplay.GetCommands()[i] == parallelReplay.GetCommands()[i];
+
+    std::cout << "  Record: " << serialMs << " ms on 1 thread, " << parallelMs << " ms on " << threadCount << " threads" << std::endl;
+    std::cout << "  Replay: " << serialReplay.GetCommands().size() << " commands in " << replayMs << " ms, merged stream "
+        << (identical ? "identical" : "DIFFERENT") << std::endl;
+    return identical ? 0 : 1;
+}
+
+/* @brief: Optimizes a UV sphere of about vertexCount vertices whose triangles come in random order, the way
+           they do out of some exporters, and prints the cache stats before and after. Checks each pass keeps the
+           triangles with their winding, the ACMR reached, the vertex remap and the cache stats of a known order.
+           Doesn't need a GL context.
+*/
+static int BenchmarkMeshOptimizer(unsigned int rings, unsigned int segments)
+{
+    struct MeshVertex {
+        float Position[3];
+        unsigned int Id;
+    };
+
+    std::vector<MeshVertex> vertices;
+    for (unsigned int r = 0; r <= rings; r++)
+    {
+        float theta = 3.14159265f * r / rings;
+        for (unsigned int s = 0; s <= segments; s++)
+        {
+            float phi = 2.0f * 3.14159265f * s / segments;
+            MeshVertex vertex = { { std::sin(theta) * std::cos(phi), std::cos(theta), std::sin(theta) * std::sin(phi) },
+                (unsigned int)vertices.size() };
+            vertices.push_back(vertex);
+        }
+    }
+
+    std::vector<unsigned int> triangles;
+    for (unsigned int r = 0; r < rings; r++)
+    {
+        for (unsigned int s = 0; s < segments; s++)
+        {
+            unsigned int a = r * (segments + 1) + s, b = a + segments + 1;
+            unsigned int quad[6] = { a, b, a + 1, a + 1, b, b + 1 };
+            triangles.insert(triangles.end(), quad, quad + 6);
+        }
+    }
+
+    unsigned int seed = 1;
+    unsigned int triangleCount = (unsigned int)triangles.size() / 3;
+    for (unsigned int t = triangleCount - 1; t > 0; t--)
+    {
+        unsigned int other = NextRandom(seed) % (t + 1);
+        for (unsigned int k = 0; k < 3; k++)
+            std::swap(triangles[t * 3 + k], triangles[other * 3 + k]);
+    }
+
+    //Triangles by the ids of their vertices, rotated to start at the smallest so the winding is kept
+    auto canonicalTriangles = [](const std::vector<unsigned int>& indices, const std::vector<MeshVertex>& vertices) {
+        std::vector<unsigned long long> result;
+        for (size_t t = 0; t < indices.size(); t += 3)
+        {
+            unsigned int ids[3] = { vertices[indices[t]].Id, vertices[indices[t + 1]].Id, vertices[indices[t + 2]].Id };
+            unsigned int first = ids[0] < ids[1] ? (ids[0] < ids[2] ? 0 : 2) : (ids[1] < ids[2] ? 1 : 2);
+            unsigned long long key = 0;
+            for (unsigned int k = 0; k < 3; k++)
+                key = key * (1 << 21) + ids[(first + k) % 3];
+            result.push_back(key);
+        }
+        std::sort(result.begin(), result.end());
+        return result;
+    };
+    std::vector<unsigned long long> before = canonicalTriangles(triangles, vertices);
+
+    std::cout << "Mesh optimizer benchmark: " << vertices.size() << " vertices, " << triangleCount << " shuffled triangles, cache of "
+        << MeshOptimizer::DefaultCacheSize << std::endl;
+
+    //The first two passes on their own, vertices stay where they are
+    std::vector<unsigned int> passes(triangles);
+    MeshOptimizer::OptimizeVertexCache(&passes[0], (unsigned int)passes.size(), (unsigned int)vertices.size());
+    bool vertexCacheKept = canonicalTriangles(passes, vertices) == before;
+    MeshOptimizer::OptimizeOverdraw(&passes[0], (unsigned int)passes.size(), &vertices[0], (unsigned int)vertices.size(),
+        sizeof(MeshVertex), 0);
+    bool overdrawKept = canonicalTriangles(passes, vertices) == before;
+
+    unsigned int vertexCount = (unsigned int)vertices.size();
+    MeshOptimizerReport report = MeshOptimizer::Optimize(&triangles[0], (unsigned int)triangles.size(), &vertices[0], vertexCount,
+        sizeof(MeshVertex), 0);
+    vertices.resize(vertexCount);
+    report.Print();
+
+    bool identical = canonicalTriangles(triangles, vertices) == before;
+    std::cout << "  Triangles " << (identical ? "identical" : "DIFFERENT") << ", kept by the vertex cache pass "
+        << (vertexCacheKept ? "yes" : "NO") << ", by the overdraw pass " << (overdrawKept ? "yes" : "NO") << std::endl;
+
+    //Tipsify gets a regular grid well under 1 vertex per triangle with a cache of 16, a shuffled one starts near 3
+    const float maxAcmr = 0.8f;
+    bool acmr = report.After.Acmr < maxAcmr && report.Before.Acmr > 2.5f;
+    std::cout << "  ACMR " << (acmr ? "under " : "NOT UNDER ") << maxAcmr << std::endl;
+
+    //Every vertex is used and kept once, in the order the indices first use them
+    std::vector<bool> seen(vertexCount, false);
+    bool remap = true;
+    unsigned int nextFirstUse = 0;
+    for (unsigned int index : triangles)
+    {
+        remap = remap && index < vertexCount && index <= nextFirstUse;
+        if (index == nextFirstUse)
+            nextFirstUse++;
+    }
+    for (const MeshVertex& vertex : vertices)
+    {
+        remap = remap && vertex.Id < seen.size() && !seen[vertex.Id];
+        if (vertex.Id < seen.size())
+            seen[vertex.Id] = true;
+    }
+    remap = remap && nextFirstUse == vertexCount;
+
+    //Unreferenced vertices are dropped, the others follow the first use
+    MeshVertex small[5] = {};
+    for (unsigned int i = 0; i < 5; i++)
+        small[i].Id = i;
+    unsigned int smallIndices[6] = { 4, 2, 0, 0, 2, 3 };
+    unsigned int smallCount = MeshOptimizer::OptimizeVertexFetch(small, smallIndices, 6, 5, sizeof(MeshVertex));
+    const unsigned int expectedIds[4] = { 4, 2, 0, 3 };
+    const unsigned int expectedIndices[6] = { 0, 1, 2, 2, 1, 3 };
+    remap = remap && smallCount == 4 && memcmp(smallIndices, expectedIndices, sizeof(smallIndices)) == 0;
+    for (unsigned int i = 0; i < 4; i++)
+        remap = remap && small[i].Id == expectedIds[i];
+    std::cout << "  Vertex fetch remap " << (remap ? "consistent" : "INCONSISTENT") << std::endl;
+
+    //Two triangles sharing an edge: 4 misses over 2 triangles
+    unsigned int pair[6] = { 0, 1, 2, 2, 1, 3 };
+    VertexCacheStats pairStats = MeshOptimizer::AnalyzeVertexCache(pair, 6, 4);
+    bool stats = pairStats.Acmr == 2.0f && pairStats.Atvr == 1.0f;
+    std::cout << "  Cache stats of a known order " << (stats ? "match" : "DON'T MATCH") << std::endl;
+
+    bool passed = identical && vertexCacheKept && overdrawKept && acmr && remap && stats;
+    return passed ? 0 : 1;
+}
+
+bool BenchmarkNeedsContext(const std::string& name)
+{
+    return name != "--bench-drawqueue" && name != "--bench-commands" && name != "--bench-meshopt";
+}
+
+/* @brief: Rewrites batchCount batches of quads every frame and draws each one right after its upload, first through a
+           VertexBuffer refilled with glBufferSubData, then through a StreamingVertexBuffer orphaning its storage, then
+           persistently mapped when the driver supports it. CPU time includes writing the vertices.
+*/
+static int BenchmarkStreaming(unsigned int batchCount, unsigned int quadsPerBatch, unsigned int frames)
+{
+    Renderer renderer;
+    glm::mat4 proj = glm::ortho(0.0f, 1000.0f, 0.0f, 1000.0f, -1.0f, 1.0f);
+    unsigned int batchSize = quadsPerBatch * 4 * sizeof(QuadVertex);
+
+    std::cout << "Streaming benchmark: " << batchCount << " batches of " << quadsPerBatch << " quads, " << frames << " frames" << std::endl;
+
+    std::vector<unsigned int> indices(quadsPerBatch * 6);
+    for (unsigned int i = 0; i < quadsPerBatch; i++)
+    {
+        unsigned int quad[] = { 0, 1, 2, 2, 3, 0 };
+        for (unsigned int j = 0; j < 6; j++)
+            indices[i * 6 + j] = i * 4 + quad[j];
+    }
+    IndexBuffer ib(indices.data(), (unsigned int)indices.size());
+
+    const unsigned char white[4] = { 255, 255, 255, 255 };
+    Texture texture(1, 1, white);
+    texture.Bind(0);
+    Shader shader("res/shaders/Batch.shader");
+    shader.Bind();
+    shader.SetUniformMat4f("u_ViewProj", proj);
+
+    VertexBufferLayout layout;
+    layout.Push<float>(3);
+    layout.Push<float>(4);
+    layout.Push<float>(2);
+    layout.Push<float>(1);
+
+    auto writeBatch = [quadsPerBatch](QuadVertex* vertices, unsigned int frame, unsigned int batch) {
+        for (unsigned int i = 0; i < quadsPerBatch; i++)
+        {
+            float x = (float)((i + frame) % 1000), y = (float)(batch % 1000);
+            vertices[i * 4 + 0] = { glm::vec3(x, y, 0.0f), glm::vec4(1.0f), glm::vec2(0.0f, 0.0f), 0.0f };
+            vertices[i * 4 + 1] = { glm::vec3(x + 1.0f, y, 0.0f), glm::vec4(1.0f), glm::vec2(1.0f, 0.0f), 0.0f };
+            vertices[i * 4 + 2] = { glm::vec3(x + 1.0f, y + 1.0f, 0.0f), glm::vec4(1.0f), glm::vec2(1.0f, 1.0f), 0.0f };
+            vertices[i * 4 + 3] = { glm::vec3(x, y + 1.0f, 0.0f), glm::vec4(1.0f), glm::vec2(0.0f, 1.0f), 0.0f };
+        }
+    };
+
+    {
+        //Updated and drawn several times a frame: Dynamic, never mapped
+        VertexArray va;
+        VertexBuffer vb(batchSize, BufferUsage::Dynamic);
+        va.AddBuffer(vb, layout);
+        std::vector<QuadVertex> vertices(quadsPerBatch * 4);
+
+        double cpuMs = 0.0;
+        for (unsigned int frame = 0; frame < frames; frame++)
+        {
+            Timer timer;
+            renderer.Clear();
+            for (unsigned int batch = 0; batch < batchCount; batch++)
+            {
+                writeBatch(vertices.data(), frame, batch);
+                vb.SetData(vertices.data(), batchSize);
+                renderer.Draw(va, ib, shader, quadsPerBatch * 6);
+            }
+            cpuMs += timer.ElapsedMs();
+        }
+        GLCall(glFinish());
+        std::cout << "  VertexBuffer::SetData:        " << cpuMs / frames << " CPU ms/frame" << std::endl;
+    }
+
+    for (int persistent = 0; persistent < 2; persistent++)
+    {
+        if (persistent && !StreamingVertexBuffer::IsPersistentMappingSupported())
+        {
+            std::cout << "  Persistent mapping unsupported" << std::endl;
+            break;
+        }
+
+        VertexArray va;
+        StreamingVertexBuffer vb(batchSize * batchCount, 3, persistent != 0);
+        va.AddBuffer(vb.GetVertexBuffer(), layout);
+
+        double cpuMs = 0.0;
+        for (unsigned int frame = 0; frame < frames; frame++)
+        {
+            Timer timer;
+            renderer.Clear();
+            for (unsigned int batch = 0; batch < batchCount; batch++)
+            {
+                writeBatch((QuadVertex*)vb.Map(batchSize), frame, batch);
+                int baseVertex = (int)(vb.Unmap() / sizeof(QuadVertex));
+                renderer.Draw(va, ib, shader, quadsPerBatch * 6, baseVertex);
+            }
+            vb.EndFrame();
+            cpuMs += timer.ElapsedMs();
+        }
+        GLCall(glFinish());
+        std::cout << (persistent ? "  Streaming, persistent mapping: " : "  Streaming, orphaning:         ")
+            << cpuMs / frames << " CPU ms/frame, " << vb.GetStallCount() << " stalls (" << vb.GetStallMs() << " ms)" << std::endl;
+    }
+
+    return 0;
+}
+
+/* @brief: Updates chunkCount chunks of a buffer created with the strategy every frame, each chunk being drawn as points
+           right after its update so the driver has to deal with buffers in use. Returns the ms per frame, GPU included.
+*/
+static double TimeUploadStrategy(UploadStrategy strategy, Shader& shader, unsigned int chunkSize, unsigned int chunkCount, unsigned int frames)
+{
+    UploadStrategy previous = BufferUploader::Get().GetStrategy();
+    BufferUploader::Get().SetStrategy(strategy);
+
+    double ms = 0.0;
+    {
+        VertexBufferLayout layout;
+        layout.Push<float>(3);
+        layout.Push<float>(2);
+        unsigned int vertexCount = chunkSize / layout.GetStride();
+
+        //Each chunk is written once a frame before its draw
+        VertexArray va;
+        VertexBuffer vb(chunkSize * chunkCount, BufferUsage::PerFrame);
+        va.AddBuffer(vb, layout);
+        std::vector<float> data(chunkSize / sizeof(float), 0.5f);
+
+        shader.Bind();
+        GLCall(glFinish());
+        Timer timer;
+        for (unsigned int frame = 0; frame < frames; frame++)
+        {
+            for (unsigned int chunk = 0; chunk < chunkCount; chunk++)
+            {
+                data[0] = (float)frame;
+                vb.Update(chunk * chunkSize, data.data(), chunkSize);
+                va.Bind();
+                GLCall(glDrawArrays(GL_POINTS, chunk * vertexCount, vertexCount));
+            }
+            BufferUploader::Get().EndFrame();
+        }
+        GLCall(glFinish());
+        ms = timer.ElapsedMs() / frames;
+    }
+
+    BufferUploader::Get().SetStrategy(previous);
+    return ms;
+}
+
+static std::string GetDriverName()
+{
+    GLCall(std::string vendor = (const char*)glGetString(GL_VENDOR));
+    GLCall(std::string renderer = (const char*)glGetString(GL_RENDERER));
+    GLCall(std::string version = (const char*)glGetString(GL_VERSION));
+    return vendor + " | " + renderer + " | " + version;
+}
+
+UploadStrategy SelectUploadStrategy(const std::string& recordPath)
+{
+    BufferUploader& uploader = BufferUploader::Get();
+    std::string driver = GetDriverName();
+
+    std::ifstream record(recordPath);
+    std::string recordedDriver, recordedStrategy;
+    UploadStrategy strategy;
+    if (std::getline(record, recordedDriver) && std::getline(record, recordedStrategy) && recordedDriver == driver
+        && BufferUploader::ParseStrategy(recordedStrategy, strategy) && BufferUploader::IsSupported(strategy))
+    {
+        uploader.SetStrategy(strategy);
+        std::cout << "Upload strategy: " << BufferUploader::GetStrategyName(strategy) << " (recorded)" << std::endl;
+        return strategy;
+    }
+
+    Shader shader("res/shaders/Basic.shader");
+    double bestMs = 0.0;
+    strategy = UploadStrategy::SubData;
+    std::cout << "Upload strategies:";
+    for (unsigned int i = 0; i < BufferUploader::StrategyCount; i++)
+    {
+        UploadStrategy candidate = (UploadStrategy)i;
+        if (!BufferUploader::IsSupported(candidate))
+            continue;
+
+        double ms = TimeUploadStrategy(candidate, shader, 16 * 1024, 64, 10);
+        std::cout << " " << BufferUploader::GetStrategyName(candidate) << " " << ms << " ms";
+        if (i == 0 || ms < bestMs)
+        {
+            bestMs = ms;
+            strategy = candidate;
+        }
+    }
+    std::cout << std::endl << "Upload strategy: " << BufferUploader::GetStrategyName(strategy) << std::endl;
+
+    uploader.SetStrategy(strategy);
+    std::ofstream(recordPath) << driver << "\n" << BufferUploader::GetStrategyName(strategy) << "\n";
+    return strategy;
+}
+
+/* @brief: Writes a range of a PerFrame buffer twice in a frame, drawing it in between, and reads the buffer back.
+           The second write has to synchronize and the buffer must hold it. Returns whether it does.
+*/
+static bool CheckRewriteInFrame(UploadStrategy strategy, Shader& shader)
+{
+    UploadStrategy previous = BufferUploader::Get().GetStrategy();
+    BufferUploader::Get().SetStrategy(strategy);
+
+    bool passed;
+    {
+        VertexBufferLayout layout;
+        layout.Push<float>(3);
+        layout.Push<float>(2);
+        VertexArray va;
+        VertexBuffer vb(256 * layout.GetStride(), BufferUsage::PerFrame);
+        VertexBuffer dynamic(256 * layout.GetStride());
+        va.AddBuffer(vb, layout);
+        std::vector<float> first(vb.GetSize() / sizeof(float), 0.25f), second(first.size(), 0.75f), read(first.size());
+
+        BufferUploader::Get().EndFrame();
+        unsigned int syncs = BufferUploader::Get().GetRewriteSyncs();
+        shader.Bind();
+        vb.SetData(first.data(), vb.GetSize());
+        va.Bind();
+        GLCall(glDrawArrays(GL_POINTS, 0, 256));
+        vb.SetData(second.data(), vb.GetSize());
+        bool synchronized = strategy == UploadStrategy::SubData || strategy == UploadStrategy::Orphan
+            || BufferUploader::Get().GetRewriteSyncs() == syncs + 1;
+        BufferUploader::Get().EndFrame();
+
+        GLCall(glBindBuffer(GL_COPY_READ_BUFFER, vb.GetRendererID()));
+        GLCall(glGetBufferSubData(GL_COPY_READ_BUFFER, 0, vb.GetSize(), read.data()));
+        //Buffers updated between draws never get a mapping strategy
+        bool dynamicUnmapped = dynamic.GetUploadStrategy() == UploadStrategy::SubData || dynamic.GetUploadStrategy() == UploadStrategy::Orphan;
+        passed = synchronized && read == second && vb.GetUploadStrategy() == strategy && dynamicUnmapped;
+    }
+
+    BufferUploader::Get().SetStrategy(previous);
+    return passed;
+}
+
+/* @brief: Same measure as the startup selection, with bigger and more updates. Also checks that rewriting a range in
+           the same frame is safe with each strategy.
+*/
+static int BenchmarkUploadStrategies(unsigned int chunkSize, unsigned int chunkCount, unsigned int frames)
+{
+    Shader shader("res/shaders/Basic.shader");
+    std::cout << "Upload benchmark: " << chunkCount << " updates of " << chunkSize << " bytes per frame, " << frames
+        << " frames" << std::endl;
+    bool passed = true;
+    for (unsigned int i = 0; i < BufferUploader::StrategyCount; i++)
+    {
+        UploadStrategy strategy = (UploadStrategy)i;
+        if (!BufferUploader::IsSupported(strategy))
+        {
+            std::cout << "  " << BufferUploader::GetStrategyName(strategy) << " unsupported" << std::endl;
+            continue;
+        }
+        bool rewriteSafe = CheckRewriteInFrame(strategy, shader);
+        passed = passed && rewriteSafe;
+        std::cout << "  " << BufferUploader::GetStrategyName(strategy) << ": "
+            << TimeUploadStrategy(strategy, shader, chunkSize, chunkCount, frames) << " ms/frame, rewrite in a frame "
+            << (rewriteSafe ? "synchronized" : "NOT SYNCHRONIZED") << std::endl;
+    }
+    std::cout << "  " << BufferUploader::Get().GetSyncWaits() << " waits for the previous frame, "
+        << BufferUploader::Get().GetRewriteSyncs() << " rewrites synchronized" << std::endl;
+    return passed ? 0 : 1;
+}
+
+/* @brief: Draws meshCount small grid meshes, first each with its own vertex array and buffers, then all from one
+           GpuBufferArena. Then removes and adds meshes of other sizes to fragment the arena and defragments it.
+           Checks ranges of exactly the requested size are found and no mesh got lost.
+*/
+static int BenchmarkBufferArena(unsigned int meshCount, unsigned int frames)
+{
+    Renderer renderer;
+    Texture texture("res/textures/clouds.png");
+    texture.Bind();
+    Shader shader("res/shaders/Basic.shader");
+    shader.Bind();
+    shader.SetUniform1i("u_Texture", 0);
+    shader.SetUniformMat4f("u_MVP", glm::ortho(0.0f, 100.0f, 0.0f, 100.0f, -1.0f, 1.0f));
+
+    VertexBufferLayout layout;
+    layout.Push<float>(3);
+    layout.Push<float>(2);
+
+    //Grids of 1x1 to 8x8 quads
+    auto makeGrid = [](unsigned int size, std::vector<float>& vertices, std::vector<unsigned int>& indices) {
+        vertices.clear();
+        indices.clear();
+        for (unsigned int y = 0; y <= size; y++)
+        {
+            for (unsigned int x = 0; x <= size; x++)
+            {
+                float u = (float)x / size, v = (float)y / size;
+                vertices.insert(vertices.end(), { u, v, 0.0f, u, v });
+            }
+        }
+        for (unsigned int y = 0; y < size; y++)
+        {
+            for (unsigned int x = 0; x < size; x++)
+            {
+                unsigned int i = y * (size + 1) + x;
+                indices.insert(indices.end(), { i, i + 1, i + size + 2, i + size + 2, i + size + 1, i });
+            }
+        }
+    };
+
+    std::cout << "Buffer arena benchmark: " << meshCount << " meshes, " << frames << " frames" << std::endl;
+
+    std::vector<float> vertices;
+    std::vector<unsigned int> indices;
+    {
+        std::vector<std::unique_ptr<VertexArray>> vertexArrays;
+        std::vector<std::unique_ptr<VertexBuffer>> vertexBuffers;
+        std::vector<std::unique_ptr<IndexBuffer>> indexBuffers;
+        for (unsigned int i = 0; i < meshCount; i++)
+        {
+            makeGrid(1 + i % 8, vertices, indices);
+            vertexBuffers.emplace_back(new VertexBuffer(vertices.data(), (unsigned int)(vertices.size() * sizeof(float))));
+            indexBuffers.emplace_back(new IndexBuffer(indices.data(), (unsigned int)indices.size()));
+            vertexArrays.emplace_back(new VertexArray());
+            vertexArrays.back()->AddBuffer(*vertexBuffers.back(), layout);
+        }
+
+        GLStateCache::Get().ResetCounters();
+        double cpuMs = 0.0;
+        for (unsigned int frame = 0; frame < frames; frame++)
+        {
+            Timer timer;
+            renderer.Clear();
+            for (unsigned int i = 0; i < meshCount; i++)
+                renderer.Draw(*vertexArrays[i], *indexBuffers[i], shader);
+            cpuMs += timer.ElapsedMs();
+            GLCall(glFinish());
+        }
+        std::cout << "  One vertex array per mesh: " << cpuMs / frames << " CPU ms/frame, "
+            << GLStateCache::Get().GetIssuedCalls() / frames << " binds/frame" << std::endl;
+    }
+
+    GpuBufferArena arena(layout, meshCount * 81, meshCount * 384);
+    std::vector<GpuMeshHandle> meshes;
+    for (unsigned int i = 0; i < meshCount; i++)
+    {
+        makeGrid(1 + i % 8, vertices, indices);
+        meshes.push_back(arena.Add(vertices.data(), (unsigned int)vertices.size() / 5, indices.data(), (unsigned int)indices.size()));
+    }
+
+    GLStateCache::Get().ResetCounters();
+    double cpuMs = 0.0;
+    for (unsigned int frame = 0; frame < frames; frame++)
+    {
+        Timer timer;
+        renderer.Clear();
+        for (GpuMeshHandle mesh : meshes)
+            renderer.Draw(arena, mesh, shader);
+        cpuMs += timer.ElapsedMs();
+        GLCall(glFinish());
+    }
+    std::cout << "  GpuBufferArena:            " << cpuMs / frames << " CPU ms/frame, "
+        << GLStateCache::Get().GetIssuedCalls() / frames << " binds/frame" << std::endl;
+
+    //Every other mesh replaced by a smaller one leaves holes the big meshes don't fit in
+    for (unsigned int i = 0; i < meshCount; i += 2)
+    {
+        arena.Remove(meshes[i]);
+        makeGrid(1, vertices, indices);
+        meshes[i] = arena.Add(vertices.data(), (unsigned int)vertices.size() / 5, indices.data(), (unsigned int)indices.size());
+    }
+    std::cout << "  Fragmented: " << arena.GetFreeVertices() << " free vertices, largest range " << arena.GetLargestFreeVertexRange() << std::endl;
+
+    Timer timer;
+    arena.Defragment();
+    GLCall(glFinish());
+    std::cout << "  Defragmented in " << timer.ElapsedMs() << " ms: largest range " << arena.GetLargestFreeVertexRange() << std::endl;
+
+    //Free ranges sit in the bin their size rounds down to, one of exactly the requested size has to be found anyway
+    OffsetAllocator exact(100);
+    bool exactFit = exact.Allocate(100).Offset == 0 && exact.GetFreeSpace() == 0;
+    GpuBufferArena full(layout, 16, 54);
+    makeGrid(3, vertices, indices);
+    exactFit = exactFit && full.Add(vertices.data(), (unsigned int)vertices.size() / 5, indices.data(), (unsigned int)indices.size()) != GpuBufferArena::InvalidMesh;
+    bool kept = arena.GetMeshCount() == meshCount;
+    std::cout << "  Exact fits " << (exactFit ? "found" : "NOT FOUND") << ", meshes " << (kept ? "all kept" : "LOST")
+        << " by the defragmentation" << std::endl;
+
+    //Defragmenting would reallocate the buffers
+    unsigned int indexBuffer = arena.GetIndexBuffer().GetRendererID();
+    bool emptyRejected = arena.Add(vertices.data(), 0, indices.data(), 0) == GpuBufferArena::InvalidMesh
+        && arena.GetIndexBuffer().GetRendererID() == indexBuffer && arena.GetMeshCount() == meshCount;
+    std::cout << "  Empty mesh " << (emptyRejected ? "rejected" : "NOT REJECTED") << " without defragmenting" << std::endl;
+    return exactFit && kept && emptyRejected ? 0 : 1;
+}
+
+/* @brief: Draws a wavy grid with 32 byte float vertices, then with 16 byte vertices (16 bit positions, half UVs,
+           2_10_10_10 normals) quantized from the same float streams. Also times the SIMD quantization against the
+           scalar conversion of each value and checks they give the same bits.
+*/
+static int BenchmarkVertexFormats(unsigned int gridSize, unsigned int frames)
+{
+    struct FloatVertex {
+        float Position[3];
+        float TexCoord[2];
+        float Normal[3];
+    };
+    struct CompactVertex {
+        Snorm16 Position[4];
+        Half TexCoord[2];
+        Snorm2_10_10_10 Normal;
+    };
+
+    unsigned int vertexCount = (gridSize + 1) * (gridSize + 1);
+    std::vector<float> positions, texCoords, normals;
+    for (unsigned int y = 0; y <= gridSize; y++)
+    {
+        for (unsigned int x = 0; x <= gridSize; x++)
+        {
+            float u = (float)x / gridSize, v = (float)y / gridSize;
+            float wave = 6.0f * 3.14159265f;
+            glm::vec3 normal = glm::normalize(glm::vec3(-0.1f * wave * std::cos(wave * u), 0.0f, 1.0f));
+            float position[4] = { 2.0f * u - 1.0f, 2.0f * v - 1.0f, 0.1f * std::sin(wave * u), 1.0f };
+            positions.insert(positions.end(), position, position + 4);
+            texCoords.push_back(u);
+            texCoords.push_back(v);
+            normals.insert(normals.end(), &normal.x, &normal.x + 3);
+        }
+    }
+
+    std::vector<unsigned int> indices;
+    for (unsigned int y = 0; y < gridSize; y++)
+    {
+        for (unsigned int x = 0; x < gridSize; x++)
+        {
+            unsigned int a = y * (gridSize + 1) + x, b = a + gridSize + 1;
+            unsigned int quad[6] = { a, a + 1, b, b, a + 1, b + 1 };
+            indices.insert(indices.end(), quad, quad + 6);
+        }
+    }
+
+    std::cout << "Vertex format benchmark: " << vertexCount << " vertices, " << indices.size() / 3 << " triangles, "
+        << frames << " frames, " << (VertexQuantization::IsSimdEnabled() ? "SSE2" : "scalar") << " quantization" << std::endl;
+
+    //Quantization, the half conversion also gets values out of its range
+    std::vector<float> stream(vertexCount * 4);
+    unsigned int seed = 1;
+    for (float& value : stream)
+        value = ((float)NextRandom(seed) / 0xFFFFFFFFu - 0.5f) * 2.0f * (float)(1 << (NextRandom(seed) % 40)) / (1 << 20);
+    std::vector<Half> simdHalves(stream.size()), scalarHalves(stream.size());
+    std::vector<Snorm16> simdShorts(stream.size()), scalarShorts(stream.size());
+
+    Timer simdTimer;
+    VertexQuantization::ToHalf(stream.data(), simdHalves.data(), (unsigned int)stream.size());
+    VertexQuantization::ToSnorm16(stream.data(), simdShorts.data(), (unsigned int)stream.size());
+    double simdMs = simdTimer.ElapsedMs();
+    Timer scalarTimer;
+    for (size_t i = 0; i < stream.size(); i++)
+    {
+        scalarHalves[i].Bits = VertexQuantization::FloatToHalf(stream[i]);
+        scalarShorts[i].Value = VertexQuantization::FloatToSnorm16(stream[i]);
+    }
+    double scalarMs = scalarTimer.ElapsedMs();
+
+    bool identical = true;
+    for (size_t i = 0; identical && i < stream.size(); i++)
+        identical = simdHalves[i].Bits == scalarHalves[i].Bits && simdShorts[i].Value == scalarShorts[i].Value;
+    std::cout << "  Quantize " << stream.size() << " floats to half and snorm16: " << simdMs << " ms, scalar " << scalarMs
+        << " ms, results " << (identical ? "identical" : "DIFFERENT") << std::endl;
+
+    std::vector<FloatVertex> floatVertices(vertexCount);
+    std::vector<CompactVertex> compactVertices(vertexCount);
+    std::vector<Snorm16> compactPositions(vertexCount * 4);
+    std::vector<Half> compactTexCoords(vertexCount * 2);
+    std::vector<Snorm2_10_10_10> compactNormals(vertexCount);
+    VertexQuantization::ToSnorm16(positions.data(), compactPositions.data(), vertexCount * 4);
+    VertexQuantization::ToHalf(texCoords.data(), compactTexCoords.data(), vertexCount * 2);
+    VertexQuantization::ToSnorm2_10_10_10(normals.data(), compactNormals.data(), vertexCount, 3);
+    for (unsigned int i = 0; i < vertexCount; i++)
+    {
+        memcpy(floatVertices[i].Position, &positions[i * 4], sizeof(floatVertices[i].Position));
+        memcpy(floatVertices[i].TexCoord, &texCoords[i * 2], sizeof(floatVertices[i].TexCoord));
+        memcpy(floatVertices[i].Normal, &normals[i * 3], sizeof(floatVertices[i].Normal));
+        memcpy(compactVertices[i].Position, &compactPositions[i * 4], sizeof(compactVertices[i].Position));
+        memcpy(compactVertices[i].TexCoord, &compactTexCoords[i * 2], sizeof(compactVertices[i].TexCoord));
+        compactVertices[i].Normal = compactNormals[i];
+    }
+
+    Renderer renderer;
+    Texture texture("res/textures/clouds.png");
+    texture.Bind();
+    Shader shader("res/shaders/Mesh.shader");
+    shader.Bind();
+    shader.SetUniform1i("u_Texture", 0);
+    shader.SetUniformMat4f("u_MVP", glm::rotate(glm::mat4(1.0f), -0.5f, glm::vec3(1.0f, 0.0f, 0.0f)));
+    GLCall(glUniform3f(shader.GetUniformLocation("u_LightDirection"), 0.0f, 0.0f, -1.0f));
+    IndexBuffer ib(indices.data(), (unsigned int)indices.size());
+
+    auto timeDraws = [&](const VertexArray& va) {
+        renderer.Draw(va, ib, shader);
+        GLCall(glFinish());
+        Timer timer;
+        for (unsigned int frame = 0; frame < frames; frame++)
+        {
+            renderer.Clear();
+            renderer.Draw(va, ib, shader);
+        }
+        GLCall(glFinish());
+        return timer.ElapsedMs() / frames;
+    };
+
+    constexpr auto floatLayout = MakeVertexLayout<FloatVertex>(
+        VERTEX_ATTRIBUTE(FloatVertex, Position), VERTEX_ATTRIBUTE(FloatVertex, TexCoord), VERTEX_ATTRIBUTE(FloatVertex, Normal));
+    VertexArray floatVa;
+    VertexBuffer floatVb(floatVertices.data(), vertexCount * floatLayout.GetStride());
+    floatVa.AddBuffer(floatVb, floatLayout);
+    double floatMs = timeDraws(floatVa);
+
+    constexpr auto compactLayout = MakeVertexLayout<CompactVertex>(
+        VERTEX_ATTRIBUTE(CompactVertex, Position), VERTEX_ATTRIBUTE(CompactVertex, TexCoord), VERTEX_ATTRIBUTE(CompactVertex, Normal));
+    static_assert(compactLayout.GetStride() == 16 && compactLayout[2].offset == 12, "Compact vertices are 16 bytes");
+    VertexArray compactVa;
+    VertexBuffer compactVb(compactVertices.data(), vertexCount * compactLayout.GetStride());
+    compactVa.AddBuffer(compactVb, compactLayout);
+    double compactMs = timeDraws(compactVa);
+
+    std::cout << "  Float:   " << floatLayout.GetStride() << " bytes/vertex, " << vertexCount * floatLayout.GetStride() / 1024
+        << " KB, " << floatMs << " ms/frame" << std::endl;
+    std::cout << "  Compact: " << compactLayout.GetStride() << " bytes/vertex, " << vertexCount * compactLayout.GetStride() / 1024
+        << " KB (" << 100 - 100 * compactLayout.GetStride() / floatLayout.GetStride() << "% less), " << compactMs << " ms/frame" << std::endl;
+    return identical ? 0 : 1;
+}
+
+/* @brief: Builds the LOD chain of a UV sphere, then draws a field of spheres going away from the camera, all at full
+           detail and then at the LOD the LodSelector picks for a 1 pixel error.
+*/
+static int BenchmarkLod(unsigned int rings, unsigned int segments, unsigned int frames)
+{
+    struct MeshVertex {
+        float Position[3];
+        float TexCoord[2];
+        float Normal[3];
+    };
+
+    std::vector<MeshVertex> vertices;
+    for (unsigned int r = 0; r <= rings; r++)
+    {
+        float theta = 3.14159265f * r / rings;
+        for (unsigned int s = 0; s <= segments; s++)
+        {
+            float phi = 2.0f * 3.14159265f * s / segments;
+            glm::vec3 normal(std::sin(theta) * std::cos(phi), std::cos(theta), std::sin(theta) * std::sin(phi));
+            MeshVertex vertex = { { normal.x, normal.y, normal.z }, { (float)s / segments, (float)r / rings }, { normal.x, normal.y, normal.z } };
+            vertices.push_back(vertex);
+        }
+    }
+    std::vector<unsigned int> indices;
+    for (unsigned int r = 0; r < rings; r++)
+    {
+        for (unsigned int s = 0; s < segments; s++)
+        {
+            unsigned int a = r * (segments + 1) + s, b = a + segments + 1;
+            unsigned int quad[6] = { a, a + 1, b, a + 1, b + 1, b };
+            indices.insert(indices.end(), quad, quad + 6);
+        }
+    }
+
+    std::cout << "LOD benchmark: sphere of " << vertices.size() << " vertices, " << indices.size() / 3 << " triangles" << std::endl;
+
+    SimplifyAttribute normalAttribute = { offsetof(MeshVertex, Normal), 3, 0.01f };
+    Timer buildTimer;
+    std::vector<MeshLod> lods = MeshSimplifier::BuildLodChain(indices.data(), (unsigned int)indices.size(), vertices.data(),
+        (unsigned int)vertices.size(), sizeof(MeshVertex), offsetof(MeshVertex, Position), 8, 0.5f, &normalAttribute, 1);
+    std::cout << "  " << lods.size() << " LODs built in " << buildTimer.ElapsedMs() << " ms:";
+    for (const MeshLod& lod : lods)
+        std::cout << " " << lod.Indices.size() / 3 << " (" << lod.Error << ")";
+    std::cout << " triangles (error)" << std::endl;
+
+    Renderer renderer;
+    Texture texture("res/textures/clouds.png");
+    texture.Bind();
+    Shader shader("res/shaders/Mesh.shader");
+    shader.Bind();
+    shader.SetUniform1i("u_Texture", 0);
+    GLCall(glUniform3f(shader.GetUniformLocation("u_LightDirection"), 0.0f, 0.0f, -1.0f));
+
+    VertexBufferLayout layout;
+    layout.Push<float>(3);
+    layout.Push<float>(2);
+    layout.Push<float>(3);
+    VertexArray va;
+    VertexBuffer vb(vertices.data(), (unsigned int)(vertices.size() * sizeof(MeshVertex)));
+    va.AddBuffer(vb, layout);
+    LodMesh mesh(lods);
+
+    glm::mat4 proj = glm::perspective(glm::radians(45.0f), 640.0f / 480.0f, 0.1f, 1000.0f);
+    LodSelector selector(proj, 480.0f);
+    std::vector<glm::vec3> positions;
+    for (unsigned int i = 0; i < 200; i++)
+        positions.push_back(glm::vec3(((int)(i % 10) - 5) * 3.0f, ((int)(i / 10 % 4) - 2) * 3.0f, -4.0f - (float)(i / 10) * 10.0f));
+
+    auto timeFrames = [&](bool selectLod, unsigned int& triangles, std::vector<unsigned int>& lodCounts) {
+        lodCounts.assign(mesh.GetLodCount(), 0);
+        triangles = 0;
+        Timer timer;
+        for (unsigned int frame = 0; frame < frames; frame++)
+        {
+            renderer.Clear();
+            for (const glm::vec3& position : positions)
+            {
+                unsigned int lod = selectLod ? selector.Select(mesh, glm::length(position) - 1.0f) : 0;
+                shader.SetUniformMat4f("u_MVP", glm::translate(proj, position));
+                renderer.Draw(va, mesh, lod, shader);
+                if (frame == 0)
+                {
+                    lodCounts[lod]++;
+                    triangles += mesh.GetLod(lod).IndexCount / 3;
+                }
+            }
+            GLCall(glFinish());
+        }
+        return timer.ElapsedMs() / frames;
+    };
+
+    unsigned int fullTriangles, lodTriangles;
+    std::vector<unsigned int> fullCounts, lodCounts;
+    double fullMs = timeFrames(false, fullTriangles, fullCounts);
+    double lodMs = timeFrames(true, lodTriangles, lodCounts);
+    std::cout << "  Full detail: " << fullTriangles << " triangles/frame, " << fullMs << " ms/frame" << std::endl;
+    std::cout << "  Selected:    " << lodTriangles << " triangles/frame, " << lodMs << " ms/frame, objects per LOD:";
+    for (unsigned int count : lodCounts)
+        std::cout << " " << count;
+    std::cout << std::endl;
+    return 0;
+}
+
+/* @brief: Churns a ResourcePool of small vertex buffers: every frame destroys and recreates a share of them, then
+           checks that none of the stale handles still resolves and that the GL buffers only go away at EndFrame.
+*/
+static int BenchmarkResourcePool(unsigned int bufferCount, unsigned int churnPerFrame, unsigned int frames)
+{
+    std::cout << "Resource pool benchmark: " << bufferCount << " vertex buffers, " << churnPerFrame << " recreated per frame, "
+        << frames << " frames" << std::endl;
+
+    float quad[] = { 0.0f, 0.0f, 1.0f, 0.0f, 1.0f, 1.0f, 0.0f, 1.0f };
+    ResourcePool<VertexBuffer> pool;
+    std::vector<ResourcePool<VertexBuffer>::Handle> handles;
+    for (unsigned int i = 0; i < bufferCount; i++)
+        handles.push_back(pool.Create(quad, (unsigned int)sizeof(quad)));
+
+    std::vector<ResourcePool<VertexBuffer>::Handle> staleHandles;
+    std::vector<unsigned int> pendingIds;
+    unsigned int seed = 1;
+    bool valid = true;
+    double destroyMs = 0.0, createMs = 0.0;
+    for (unsigned int frame = 0; frame < frames; frame++)
+    {
+        pendingIds.clear();
+        Timer destroyTimer;
+        for (unsigned int i = 0; i < churnPerFrame; i++)
+        {
+            ResourcePool<VertexBuffer>::Handle& handle = handles[NextRandom(seed) % bufferCount];
+            if (!pool.IsValid(handle))
+                continue;
+            pendingIds.push_back(pool.Get(handle)->GetRendererID());
+            pool.Destroy(handle);
+            staleHandles.push_back(handle);
+            handle = ResourcePool<VertexBuffer>::InvalidHandle();
+        }
+        destroyMs += destroyTimer.ElapsedMs();
+
+        Timer createTimer;
+        for (ResourcePool<VertexBuffer>::Handle& handle : handles)
+        {
+            if (handle == ResourcePool<VertexBuffer>::InvalidHandle())
+                handle = pool.Create(quad, (unsigned int)sizeof(quad));
+        }
+        createMs += createTimer.ElapsedMs();
+
+        //Until the end of the frame, the destroyed buffers are still GL buffers
+        for (unsigned int id : pendingIds)
+        {
+            GLCall(valid = valid && glIsBuffer(id) == GL_TRUE);
+        }
+        pool.EndFrame();
+    }
+
+    for (ResourcePool<VertexBuffer>::Handle handle : staleHandles)
+        valid = valid && pool.Get(handle) == nullptr;
+    for (ResourcePool<VertexBuffer>::Handle handle : handles)
+        valid = valid && pool.Get(handle) != nullptr;
+    valid = valid && pool.GetCount() == bufferCount && pool.GetPendingDestroyCount() == 0;
+
+    std::cout << "  " << staleHandles.size() << " destroyed in " << destroyMs << " ms, recreated in " << createMs << " ms" << std::endl;
+    std::cout << "  Stale handles " << (valid ? "all rejected" : "NOT REJECTED or buffers lost") << std::endl;
+    return valid ? 0 : 1;
+}
+
+/* @brief: Creates count quads, each with its vertex array, buffers and a small texture, through the bind to edit
+           path and then through DSA, and draws the first one of each to check both give the same pixels.
+*/
+static int BenchmarkDirectStateAccess(unsigned int count)
+{
+    bool supported = GLSelectDirectStateAccess(true);
+    std::cout << "Direct state access benchmark: " << count << " quads with their own buffers, vertex array and texture, DSA "
+        << (supported ? "supported" : "unsupported") << std::endl;
+
+    float quad[] = {
+        -1.0f, -1.0f, 0.0f, 0.0f, 0.0f,
+         1.0f, -1.0f, 0.0f, 1.0f, 0.0f,
+         1.0f,  1.0f, 0.0f, 1.0f, 1.0f,
+        -1.0f,  1.0f, 0.0f, 0.0f, 1.0f
+    };
+    unsigned int quadIndices[] = { 0, 1, 2, 2, 3, 0 };
+    std::vector<unsigned char> pixels(16 * 16 * 4);
+    for (size_t i = 0; i < pixels.size(); i++)
+        pixels[i] = (unsigned char)(i * 7);
+
+    VertexBufferLayout layout;
+    layout.Push<float>(3);
+    layout.Push<float>(2);
+    Shader shader("res/shaders/Basic.shader");
+    shader.Bind();
+    shader.SetUniform1i("u_Texture", 0);
+    shader.SetUniformMat4f("u_MVP", glm::mat4(1.0f));
+    Renderer renderer;
+
+    std::vector<unsigned char> images[2];
+    for (unsigned int dsa = 0; dsa < (supported ? 2u : 1u); dsa++)
+    {
+        GLSelectDirectStateAccess(dsa == 1);
+        GLStateCache::Get().ResetCounters();
+        Timer timer;
+        std::vector<VertexArray> vertexArrays;
+        std::vector<VertexBuffer> vertexBuffers;
+        std::vector<IndexBuffer> indexBuffers;
+        std::vector<Texture> textures;
+        vertexArrays.reserve(count);
+        vertexBuffers.reserve(count);
+        for (unsigned int i = 0; i < count; i++)
+        {
+            vertexBuffers.emplace_back(quad, (unsigned int)sizeof(quad));
+            indexBuffers.emplace_back(quadIndices, 6);
+            textures.emplace_back(16, 16, pixels.data());
+            vertexArrays.emplace_back();
+            vertexArrays.back().AddBuffer(vertexBuffers.back(), layout);
+        }
+        GLCall(glFinish());
+        double createMs = timer.ElapsedMs();
+        unsigned int binds = GLStateCache::Get().GetIssuedCalls();
+
+        renderer.Clear();
+        textures[0].Bind();
+        renderer.Draw(vertexArrays[0], indexBuffers[0], shader);
+        images[dsa].resize(64 * 64 * 4);
+        GLCall(glReadPixels(0, 0, 64, 64, GL_RGBA, GL_UNSIGNED_BYTE, images[dsa].data()));
+
+        std::cout << "  " << (dsa ? "DSA:         " : "Bind to edit: ") << createMs << " ms, " << binds << " cached binds issued" << std::endl;
+    }
+
+    bool identical = !supported || images[0] == images[1];
+    std::cout << "  Rendered pixels " << (identical ? "identical" : "DIFFERENT") << std::endl;
+    GLSelectDirectStateAccess(true);
+    return identical ? 0 : 1;
+}
+
+/* @brief: Draws meshCount quads with their own vertex buffer, first through one vertex array per mesh, then through the
+           shared vertex array of their format where only the vertex buffer binding changes between draws
+*/
+static int BenchmarkVertexFormatCache(unsigned int meshCount, unsigned int frames)
+{
+    VertexFormatCache& cache = VertexFormatCache::Get();
+    std::cout << "Vertex format cache benchmark: " << meshCount << " meshes of one format, " << frames << " frames, attrib binding "
+        << (cache.IsAttribBindingSupported() ? "supported" : "unsupported, attribute pointers set on every bind") << std::endl;
+
+    VertexBufferLayout layout;
+    layout.Push<float>(3);
+    layout.Push<float>(2);
+    VertexFormat format(layout);
+    unsigned int quadIndices[] = { 0, 1, 2, 2, 3, 0 };
+    IndexBuffer ib(quadIndices, 6);
+
+    unsigned int columns = (unsigned int)std::ceil(std::sqrt((float)meshCount));
+    float size = 2.0f / columns;
+    std::vector<VertexBuffer> vertexBuffers;
+    std::vector<VertexArray> vertexArrays;
+    vertexBuffers.reserve(meshCount);
+    vertexArrays.reserve(meshCount);
+    for (unsigned int i = 0; i < meshCount; i++)
+    {
+        float x = -1.0f + (i % columns) * size;
+        float y = -1.0f + (i / columns) * size;
+        float inset = size * 0.1f;
+        float quad[] = {
+            x + inset,        y + inset,        0.0f, 0.0f, 0.0f,
+            x + size - inset, y + inset,        0.0f, 1.0f, 0.0f,
+            x + size - inset, y + size - inset, 0.0f, 1.0f, 1.0f,
+            x + inset,        y + size - inset, 0.0f, 0.0f, 1.0f
+        };
+        vertexBuffers.emplace_back(quad, (unsigned int)sizeof(quad));
+        vertexArrays.emplace_back();
+        vertexArrays.back().AddBuffer(vertexBuffers.back(), layout);
+        vertexArrays.back().Bind();
+        ib.Bind();
+    }
+
+    std::vector<unsigned char> pixels(16 * 16 * 4);
+    for (size_t i = 0; i < pixels.size(); i++)
+        pixels[i] = (unsigned char)(i * 7);
+    Texture texture(16, 16, pixels.data());
+    texture.Bind();
+    Shader shader("res/shaders/Basic.shader");
+    shader.Bind();
+    shader.SetUniform1i("u_Texture", 0);
+    shader.SetUniformMat4f("u_MVP", glm::mat4(1.0f));
+    Renderer renderer;
+
+    std::vector<unsigned char> images[2];
+    for (unsigned int shared = 0; shared < 2; shared++)
+    {
+        std::vector<double> frameTimes;
+        unsigned int binds = 0;
+        for (unsigned int frame = 0; frame < frames; frame++)
+        {
+            GLStateCache::Get().ResetCounters();
+            Timer timer;
+            renderer.Clear();
+            for (unsigned int i = 0; i < meshCount; i++)
+            {
+                if (shared)
+                    renderer.Draw(format, vertexBuffers[i], ib, shader);
+                else
+                    renderer.Draw(vertexArrays[i], ib, shader);
+            }
+            binds = GLStateCache::Get().GetIssuedCalls();
+            GLCall(glFinish());
+            frameTimes.push_back(timer.ElapsedMs());
+        }
+        images[shared].resize(640 * 480 * 4);
+        GLCall(glReadPixels(0, 0, 640, 480, GL_RGBA, GL_UNSIGNED_BYTE, images[shared].data()));
+
+        PrintFrameTimes(shared ? "  Shared format vertex array " : "  Vertex array per mesh      ", frameTimes);
+        std::cout << "    " << binds << " binds issued per frame, "
+            << (shared ? cache.GetVertexArrayCount() : meshCount) << " vertex arrays" << std::endl;
+    }
+
+    bool identical = images[0] == images[1];
+    std::cout << "  Rendered pixels " << (identical ? "identical" : "DIFFERENT") << std::endl;
+    return identical ? 0 : 1;
+}
+
+/* @brief: Creates every shader of res/shaders compiled from source, then through the binary cache (filling it, then
+           loading from it). Then damages the entry of Basic.shader, which has to be rejected and compiled again, and
+           checks a quad drawn with the compiled and the cached program gives the same pixels. Entries whose size
+           doesn't match their file have to be plain misses.
+*/
+static int BenchmarkShaderCache(unsigned int rounds)
+{
+    const char* paths[] = { "res/shaders/Basic.shader", "res/shaders/Batch.shader", "res/shaders/Instanced.shader",
+        "res/shaders/Mesh.shader", "res/shaders/MultiDraw.shader" };
+    const unsigned int pathCount = sizeof(paths) / sizeof(paths[0]);
+    ShaderBinaryCache& cache = ShaderBinaryCache::Get();
+    std::cout << "Shader cache benchmark: " << pathCount << " shaders, " << rounds << " rounds, cache in '" << cache.GetDirectory()
+        << "', program binaries " << (cache.IsEnabled() ? "supported" : "unsupported") << std::endl;
+    if (!cache.IsEnabled())
+        return 0;
+
+    auto createAll = [&](unsigned int rounds) {
+        cache.ResetCounters();
+        Timer timer;
+        for (unsigned int round = 0; round < rounds; round++)
+        {
+            for (const char* path : paths)
+                Shader shader(path);
+        }
+        GLCall(glFinish());
+        return timer.ElapsedMs() / rounds;
+    };
+
+    cache.SetEnabled(false);
+    double compileMs = createAll(rounds);
+    //Entries left by earlier runs are loaded, the others compiled and stored
+    cache.SetEnabled(true);
+    double fillMs = createAll(1);
+    unsigned int stored = cache.GetMisses() + cache.GetRejected();
+    double loadMs = createAll(rounds);
+    unsigned int loadHits = cache.GetHits();
+    std::cout << "  Compile from source: " << compileMs << " ms" << std::endl;
+    std::cout << "  Filling the cache:   " << fillMs << " ms, " << stored << " compiled and stored" << std::endl;
+    std::cout << "  Loaded from cache:   " << loadMs << " ms, " << loadHits / rounds << " of " << pathCount << " loaded" << std::endl;
+
+    //A binary in a supported format the driver can't link, like one left by an older build of the same driver
+    ShaderProgramSource source = Shader::ParseShader(paths[0]);
+    unsigned long long key = cache.GetKey(source.VertexSource, source.FragmentSource);
+    std::string entryPath = cache.GetEntryPath(key);
+    std::vector<char> entry;
+    {
+        std::ifstream file(entryPath, std::ios::binary);
+        entry.assign(std::istreambuf_iterator<char>(file), std::istreambuf_iterator<char>());
+    }
+    for (size_t i = 12; i < entry.size(); i++)
+        entry[i] = (char)(i * 31);
+    std::ofstream(entryPath, std::ios::binary).write(entry.data(), entry.size());
+
+    float quad[] = {
+        -0.5f, -0.5f, 0.0f, 0.0f, 0.0f,
+         0.5f, -0.5f, 0.0f, 1.0f, 0.0f,
+         0.5f,  0.5f, 0.0f, 1.0f, 1.0f,
+        -0.5f,  0.5f, 0.0f, 0.0f, 1.0f
+    };
+    unsigned int quadIndices[] = { 0, 1, 2, 2, 3, 0 };
+    VertexBufferLayout layout;
+    layout.Push<float>(3);
+    layout.Push<float>(2);
+    VertexBuffer vb(quad, (unsigned int)sizeof(quad));
+    VertexArray va;
+    va.AddBuffer(vb, layout);
+    IndexBuffer ib(quadIndices, 6);
+    unsigned char pixel[4] = { 40, 160, 240, 255 };
+    Texture texture(1, 1, pixel);
+    texture.Bind();
+    Renderer renderer;
+
+    std::vector<unsigned char> images[2];
+    unsigned int rejected = 0, hits = 0;
+    for (unsigned int i = 0; i < 2; i++)
+    {
+        cache.ResetCounters();
+        Shader shader(paths[0]);
+        rejected += cache.GetRejected();
+        hits += cache.GetHits();
+        shader.Bind();
+        shader.SetUniform1i("u_Texture", 0);
+        shader.SetUniformMat4f("u_MVP", glm::mat4(1.0f));
+        renderer.Clear();
+        renderer.Draw(va, ib, shader);
+        images[i].resize(64 * 64 * 4);
+        GLCall(glReadPixels(288, 208, 64, 64, GL_RGBA, GL_UNSIGNED_BYTE, images[i].data()));
+    }
+
+    //A size bigger than the file, from a damaged header or a truncated entry, is a miss and nothing gets allocated
+    const unsigned int claimedSizes[] = { 0xFFFFFFF0u, 4096u };
+    unsigned int sizeMisses = 0;
+    for (unsigned int claimed : claimedSizes)
+    {
+        unsigned int header[2] = { 0, claimed };
+        std::ofstream file(entryPath, std::ios::binary);
+        file.write("OGLB", 4).write((const char*)header, sizeof(header)).write(entry.data(), 16);
+        file.close();
+        cache.ResetCounters();
+        Shader shader(paths[0]);
+        if (cache.GetMisses() == 1 && shader.IsReady())
+            sizeMisses++;
+    }
+
+    bool passed = loadHits == rounds * pathCount && rejected == 1 && hits == 1 && images[0] == images[1]
+        && sizeMisses == 2;
+    std::cout << "  Damaged entry " << (rejected == 1 ? "rejected" : "NOT REJECTED") << ", compiled and "
+        << (hits == 1 ? "cached again" : "NOT CACHED AGAIN") << ", rendered pixels "
+        << (images[0] == images[1] ? "identical" : "DIFFERENT") << std::endl;
+    std::cout << "  Entries with a wrong size " << (sizeMisses == 2 ? "treated as misses" : "NOT TREATED AS MISSES") << std::endl;
+    return passed ? 0 : 1;
+}
+
+//Source with a line that makes it unique, so no shader cache has it
+static std::string MakeShaderVariant(const std::string& source, unsigned int variant)
+{
+    size_t line = source.find('\n') + 1;
+    return source.substr(0, line) + "const int c_Variant = " + std::to_string(variant) + ";\n" + source.substr(line);
+}
+
+/* @brief: Compiles programCount variants of Mesh.shader one by one, the way Shader's constructor does, then submits them
+           all to the ShaderCompileQueue and polls once per frame. Also draws a shader while it's pending: the fallback
+           has to draw the same image with the uniforms set on the pending shader, queued and recorded draws are skipped.
+*/
+static int BenchmarkShaderCompileQueue(unsigned int programCount)
+{
+    ShaderCompileQueue& queue = ShaderCompileQueue::Get();
+    std::cout << "Shader compile queue benchmark: " << programCount << " programs, "
+        << (queue.IsParallel() ? "parallel compile" : "no parallel compile, one blocking program per poll") << std::endl;
+
+    bool cacheEnabled = ShaderBinaryCache::Get().IsEnabled();
+    ShaderBinaryCache::Get().SetEnabled(false);
+    ShaderProgramSource source = Shader::ParseShader("res/shaders/Mesh.shader");
+    unsigned int seed = (unsigned int)std::chrono::high_resolution_clock::now().time_since_epoch().count();
+    auto makeSource = [&](unsigned int i) {
+        unsigned int variant = seed + i;
+        return ShaderProgramSource{ MakeShaderVariant(source.VertexSource, variant), MakeShaderVariant(source.FragmentSource, variant) };
+    };
+    auto deletePrograms = [](std::vector<unsigned int>& programs) {
+        for (unsigned int program : programs)
+        {
+            GLStateCache::Get().OnProgramDeleted(program);
+            GLCall(glDeleteProgram(program));
+        }
+        programs.clear();
+    };
+
+    std::vector<unsigned int> programs;
+    double syncLongestMs = 0.0;
+    Timer syncTimer;
+    for (unsigned int i = 0; i < programCount; i++)
+    {
+        Timer timer;
+        programs.push_back(queue.Submit(makeSource(i), "variant"));
+        queue.Finish();
+        queue.Collect(programs.back());
+        syncLongestMs = std::max(syncLongestMs, timer.ElapsedMs());
+    }
+    double syncMs = syncTimer.ElapsedMs();
+    deletePrograms(programs);
+
+    seed += programCount;
+    Timer asyncTimer;
+    for (unsigned int i = 0; i < programCount; i++)
+        programs.push_back(queue.Submit(makeSource(i), "variant"));
+    double submitMs = asyncTimer.ElapsedMs();
+    double pollLongestMs = 0.0;
+    unsigned int frames = 0;
+    while (queue.GetPendingCount() > 0)
+    {
+        Timer frameTimer;
+        queue.Poll();
+        pollLongestMs = std::max(pollLongestMs, frameTimer.ElapsedMs());
+        frames++;
+        std::this_thread::sleep_for(std::chrono::milliseconds(1));
+    }
+    double asyncMs = asyncTimer.ElapsedMs();
+    unsigned int ready = 0;
+    for (unsigned int program : programs)
+        ready += queue.Collect(program) == ShaderStatus::Ready ? 1 : 0;
+    deletePrograms(programs);
+
+    std::cout << "  One at a time: " << syncMs << " ms, longest stall " << syncLongestMs << " ms" << std::endl;
+    std::cout << "  Queued:        " << asyncMs << " ms over " << frames << " polls, submit " << submitMs
+        << " ms, longest poll " << pollLongestMs << " ms, " << ready << " ready" << std::endl;
+
+    //Pending, then ready
+    float quad[] = {
+        -0.5f, -0.5f, 0.0f, 0.0f, 0.0f,
+         0.5f, -0.5f, 0.0f, 1.0f, 0.0f,
+         0.5f,  0.5f, 0.0f, 1.0f, 1.0f,
+        -0.5f,  0.5f, 0.0f, 0.0f, 1.0f
+    };
+    unsigned int quadIndices[] = { 0, 1, 2, 2, 3, 0 };
+    VertexBufferLayout layout;
+    layout.Push<float>(3);
+    layout.Push<float>(2);
+    VertexBuffer vb(quad, (unsigned int)sizeof(quad));
+    VertexArray va;
+    va.AddBuffer(vb, layout);
+    IndexBuffer ib(quadIndices, 6);
+    unsigned char pixel[4] = { 40, 160, 240, 255 };
+    Texture texture(1, 1, pixel);
+    texture.Bind();
+    std::vector<unsigned char> images[3];
+    auto readImage = [](std::vector<unsigned char>& image) {
+        image.resize(640 * 480 * 4);
+        GLCall(glReadPixels(0, 0, 640, 480, GL_RGBA, GL_UNSIGNED_BYTE, image.data()));
+    };
+
+    //The fallback's own MVP draws the quad in the middle
+    Shader fallback("res/shaders/Basic.shader");
+    fallback.Bind();
+    fallback.SetUniform1i("u_Texture", 0);
+    fallback.SetUniformMat4f("u_MVP", glm::mat4(1.0f));
+    Renderer renderer;
+    renderer.SetFallbackShader(&fallback);
+    renderer.Clear();
+    renderer.Draw(va, ib, fallback);
+    readImage(images[0]);
+
+    //Uniforms set while pending are kept, the fallback gets them too and draws the quad where the shader will
+    Shader shader("res/shaders/Basic.shader", queue);
+    bool pending = shader.GetStatus() == ShaderStatus::Pending;
+    shader.Bind();
+    shader.SetUniform1i("u_Texture", 0);
+    shader.SetUniformMat4f("u_MVP", glm::translate(glm::mat4(1.0f), glm::vec3(0.4f, 0.3f, 0.0f)));
+    renderer.Clear();
+    renderer.Draw(va, ib, shader);
+    readImage(images[1]);
+    unsigned int fallbackDraws = renderer.GetFallbackDraws();
+
+    //Neither the draw queue nor a command buffer can hand its uniforms to the fallback, they skip the draw
+    renderer.Submit(va, ib, shader, 0, 0.0f);
+    renderer.Flush();
+    CommandBuffer commands;
+    commands.BindShader(shader);
+    commands.BindVertexArray(va);
+    commands.BindIndexBuffer(ib);
+    commands.DrawIndexed(ib);
+    renderer.Execute(commands);
+    unsigned int skippedDraws = renderer.GetSkippedDraws();
+
+    queue.Finish();
+    renderer.Clear();
+    renderer.Draw(va, ib, shader);
+    readImage(images[2]);
+    bool drawn = shader.IsReady() && renderer.GetFallbackDraws() == fallbackDraws;
+    bool sameImage = images[1] == images[2] && images[1] != images[0];
+
+    std::cout << "  Draw while " << (pending ? "pending" : "NOT PENDING") << ": " << fallbackDraws << " fallback draw, then "
+        << (drawn ? "drawn with its own program" : "NOT DRAWN") << std::endl;
+    std::cout << "  Fallback " << (sameImage ? "drew the same image with the pending shader's uniforms" : "DREW A DIFFERENT IMAGE")
+        << ", " << skippedDraws << " of 2 queued and recorded draws skipped" << std::endl;
+
+    ShaderBinaryCache::Get().SetEnabled(cacheEnabled);
+    return ready == programCount && pending && fallbackDraws == 1 && drawn && sameImage && skippedDraws == 2 ? 0 : 1;
+}
+
+/* @brief: Cost of one uniform lookup and one glUniformMatrix4fv through each way of naming the uniform. "Before" is
+           the lookup Shader did until it had a uniform table, a string map with find then operator[].
+*/
+static int BenchmarkUniforms(unsigned int calls)
+{
+    Shader shader("res/shaders/Basic.shader");
+    shader.Bind();
+    std::cout << "Uniform benchmark: " << calls << " calls each, uniforms of Basic.shader:";
+    for (const UniformInfo& uniform : shader.GetUniforms())
+        std::cout << " " << uniform.Name << " (location " << uniform.Location << ", type 0x" << std::hex << uniform.Type << std::dec << ")";
+    std::cout << std::endl;
+
+    std::unordered_map<std::string, int> locationCache;
+    auto findBefore = [&](const std::string& name) {
+        if (locationCache.find(name) != locationCache.end())
+            return locationCache[name];
+        int location = glGetUniformLocation(shader.GetRendererID(), name.c_str());
+        locationCache[name] = location;
+        return location;
+    };
+    static constexpr UniformName s_MVP("u_MVP");
+    UniformHandle handle = shader.GetUniformHandle(s_MVP);
+
+    //Lookups only, the sum keeps them from being optimized away
+    long long sum = 0;
+    Timer beforeTimer;
+    for (unsigned int i = 0; i < calls; i++)
+        sum += findBefore("u_MVP");
+    double beforeNs = beforeTimer.ElapsedMs() * 1e6 / calls;
+    Timer stringTimer;
+    for (unsigned int i = 0; i < calls; i++)
+        sum += shader.GetUniformLocation("u_MVP");
+    double stringNs = stringTimer.ElapsedMs() * 1e6 / calls;
+    Timer nameTimer;
+    for (unsigned int i = 0; i < calls; i++)
+        sum += shader.GetUniformLocation(shader.GetUniformHandle(s_MVP));
+    double nameNs = nameTimer.ElapsedMs() * 1e6 / calls;
+    Timer handleTimer;
+    for (unsigned int i = 0; i < calls; i++)
+        sum += shader.GetUniformLocation(handle);
+    double handleNs = handleTimer.ElapsedMs() * 1e6 / calls;
+
+    //Lookup and upload
+    glm::mat4 matrix(1.0f);
+    Timer beforeSetTimer;
+    for (unsigned int i = 0; i < calls; i++)
+    {
+        matrix[3][0] = (float)i;
+        GLCall(glUniformMatrix4fv(findBefore("u_MVP"), 1, GL_FALSE, &matrix[0][0]));
+    }
+    double beforeSetNs = beforeSetTimer.ElapsedMs() * 1e6 / calls;
+    Timer handleSetTimer;
+    for (unsigned int i = 0; i < calls; i++)
+    {
+        matrix[3][0] = (float)i;
+        shader.SetUniformMat4f(handle, matrix);
+    }
+    double handleSetNs = handleSetTimer.ElapsedMs() * 1e6 / calls;
+
+    std::cout << "  Lookup, before (string map):      " << beforeNs << " ns" << std::endl;
+    std::cout << "  Lookup, string in the table:      " << stringNs << " ns" << std::endl;
+    std::cout << "  Lookup, compile-time hashed name: " << nameNs << " ns" << std::endl;
+    std::cout << "  Lookup, handle:                   " << handleNs << " ns" << std::endl;
+    std::cout << "  SetUniformMat4f, before:          " << beforeSetNs << " ns" << std::endl;
+    std::cout << "  SetUniformMat4f, handle:          " << handleSetNs << " ns" << std::endl;
+
+    bool same = findBefore("u_MVP") == shader.GetUniformLocation(handle) && shader.GetUniformLocation(handle) != -1;
+    volatile long long sink = sum;
+    (void)sink;
+    std::cout << "  Locations " << (same ? "match" : "DIFFER") << std::endl;
+    return same ? 0 : 1;
+}
+
+struct CameraData {
+    glm::mat4 ViewProjection;
+    glm::vec3 Position;
+    float Time;
+};
+
+struct ObjectData {
+    glm::mat4 Model;
+    glm::vec4 Color;
+    glm::mat3 Normal;
+    float Fade[2];
+    glm::vec2 UvOffset;
+};
+
+static constexpr auto s_CameraLayout = MakeUniformBlockLayout<CameraData>(UniformPacking::Std140,
+    UNIFORM_MEMBER(CameraData, ViewProjection), UNIFORM_MEMBER(CameraData, Position), UNIFORM_MEMBER(CameraData, Time));
+static constexpr auto s_ObjectLayout = MakeUniformBlockLayout<ObjectData>(UniformPacking::Std140,
+    UNIFORM_MEMBER(ObjectData, Model), UNIFORM_MEMBER(ObjectData, Color), UNIFORM_MEMBER(ObjectData, Normal),
+    UNIFORM_MEMBER(ObjectData, Fade), UNIFORM_MEMBER(ObjectData, UvOffset));
+static constexpr auto s_ObjectLayout430 = MakeUniformBlockLayout<ObjectData>(UniformPacking::Std430,
+    UNIFORM_MEMBER(ObjectData, Model), UNIFORM_MEMBER(ObjectData, Color), UNIFORM_MEMBER(ObjectData, Normal),
+    UNIFORM_MEMBER(ObjectData, Fade), UNIFORM_MEMBER(ObjectData, UvOffset));
+
+//The vec3 takes the 12 first bytes of a vec4 slot, a float fits behind it
+static_assert(s_CameraLayout.GetOffset(2) == 76 && s_CameraLayout.GetSize() == 80, "Unexpected std140 camera layout");
+//Matrix columns and array elements take a vec4 slot each in std140, only their own alignment in std430
+static_assert(s_ObjectLayout.GetOffset(3) == 128 && s_ObjectLayout.GetStride(3) == 16 && s_ObjectLayout.GetSize() == 176,
+    "Unexpected std140 object layout");
+static_assert(s_ObjectLayout430.GetOffset(3) == 128 && s_ObjectLayout430.GetStride(3) == 4 && s_ObjectLayout430.GetSize() == 144,
+    "Unexpected std430 object layout");
+
+/* @brief: Checks the offsets and strides of the packer against the ones the driver gives the members of the block
+*/
+template<unsigned int N>
+static bool CheckUniformBlockLayout(const Shader& shader, const char* blockName, const char* const* memberNames, const UniformBlockLayout<N>& layout)
+{
+    bool matching = shader.GetUniformBlockSize(blockName) == layout.GetSize();
+    std::cout << "  Block " << blockName << ": " << layout.GetSize() << " bytes, driver " << shader.GetUniformBlockSize(blockName) << std::endl;
+
+    unsigned int indices[N];
+    GLCall(glGetUniformIndices(shader.GetRendererID(), N, memberNames, indices));
+    for (unsigned int i = 0; i < N; i++)
+    {
+        if (indices[i] == GL_INVALID_INDEX)
+        {
+            std::cout << "    " << memberNames[i] << " isn't active" << std::endl;
+            matching = false;
+            continue;
+        }
+        int offset = 0, arrayStride = 0, matrixStride = 0;
+        GLCall(glGetActiveUniformsiv(shader.GetRendererID(), 1, &indices[i], GL_UNIFORM_OFFSET, &offset));
+        GLCall(glGetActiveUniformsiv(shader.GetRendererID(), 1, &indices[i], GL_UNIFORM_ARRAY_STRIDE, &arrayStride));
+        GLCall(glGetActiveUniformsiv(shader.GetRendererID(), 1, &indices[i], GL_UNIFORM_MATRIX_STRIDE, &matrixStride));
+        int stride = layout[i].Columns > 1 ? matrixStride : layout[i].Array ? arrayStride : (int)layout.GetStride(i);
+        bool same = offset == (int)layout.GetOffset(i) && stride == (int)layout.GetStride(i);
+        std::cout << "    " << memberNames[i] << ": offset " << layout.GetOffset(i) << ", stride " << layout.GetStride(i)
+            << (same ? "" : " DIFFERENT from the driver") << std::endl;
+        matching = matching && same;
+    }
+    return matching;
+}
+
+/* @brief: Draws objectCount textured quads per frame spread over programCount programs. First with the camera and the
+           object data set with glUniform* on every draw, then with the camera in a UniformBuffer updated once per
+           frame and the object data pushed to a UniformRingBuffer, persistently mapped and with the staging fallback.
+*/
+static int BenchmarkUniformBuffers(unsigned int objectCount, unsigned int programCount, unsigned int frames)
+{
+    std::vector<Shader> uniformShaders;
+    std::vector<Shader> blockShaders;
+    for (unsigned int i = 0; i < programCount; i++)
+    {
+        uniformShaders.emplace_back("res/shaders/Object.shader");
+        blockShaders.emplace_back("res/shaders/ObjectBlock.shader");
+    }
+
+    unsigned int cameraBinding = UniformBuffer::GetBindingPoint("Camera");
+    unsigned int objectBinding = UniformBuffer::GetBindingPoint("Object");
+    std::cout << "Uniform buffer benchmark: " << objectCount << " objects, " << programCount << " programs, " << frames
+        << " frames, offset alignment " << UniformBuffer::GetOffsetAlignment() << ", binding points Camera " << cameraBinding
+        << ", Object " << objectBinding << std::endl;
+
+    const char* cameraMembers[] = { "u_ViewProjection", "u_CameraPosition", "u_Time" };
+    const char* objectMembers[] = { "u_Model", "u_Color", "u_Normal", "u_Fade[0]", "u_UvOffset" };
+    bool layoutsMatch = CheckUniformBlockLayout(blockShaders[0], "Camera", cameraMembers, s_CameraLayout);
+    layoutsMatch = CheckUniformBlockLayout(blockShaders[0], "Object", objectMembers, s_ObjectLayout) && layoutsMatch;
+
+    struct ObjectHandles {
+        UniformHandle ViewProjection, Model, Color;
+    };
+    std::vector<ObjectHandles> handles;
+    for (unsigned int i = 0; i < programCount; i++)
+    {
+        Shader& uniformShader = uniformShaders[i];
+        uniformShader.Bind();
+        uniformShader.SetUniform1i("u_Texture", 0);
+        handles.push_back({ uniformShader.GetUniformHandle("u_ViewProjection"), uniformShader.GetUniformHandle("u_Model"),
+            uniformShader.GetUniformHandle("u_Color") });
+
+        Shader& blockShader = blockShaders[i];
+        blockShader.Bind();
+        blockShader.SetUniform1i("u_Texture", 0);
+        blockShader.SetUniformBlockBinding("Camera");
+        blockShader.SetUniformBlockBinding("Object");
+    }
+
+    float quad[] = {
+        -0.5f, -0.5f, 0.0f, 0.0f, 0.0f,
+         0.5f, -0.5f, 0.0f, 1.0f, 0.0f,
+         0.5f,  0.5f, 0.0f, 1.0f, 1.0f,
+        -0.5f,  0.5f, 0.0f, 0.0f, 1.0f
+    };
+    unsigned int quadIndices[] = { 0, 1, 2, 2, 3, 0 };
+    VertexBuffer vb(quad, (unsigned int)sizeof(quad));
+    VertexBufferLayout layout;
+    layout.Push<float>(3);
+    layout.Push<float>(2);
+    VertexArray va;
+    va.AddBuffer(vb, layout);
+    IndexBuffer ib(quadIndices, 6);
+
+    std::vector<unsigned char> pixels(16 * 16 * 4);
+    for (size_t i = 0; i < pixels.size(); i++)
+        pixels[i] = (unsigned char)(i * 7);
+    Texture texture(16, 16, pixels.data());
+    texture.Bind();
+
+    //Objects of the same program are drawn one after the other
+    unsigned int columns = (unsigned int)std::ceil(std::sqrt((float)objectCount));
+    float size = 2.0f / columns;
+    std::vector<ObjectData> objects(objectCount);
+    for (unsigned int i = 0; i < objectCount; i++)
+    {
+        ObjectData& object = objects[i];
+        glm::vec3 position(-1.0f + (i % columns + 0.5f) * size, -1.0f + (i / columns + 0.5f) * size, 0.0f);
+        object.Model = glm::scale(glm::translate(glm::mat4(1.0f), position), glm::vec3(size * 0.8f));
+        object.Color = glm::vec4(0.5f + 0.5f * (i % 3) / 2.0f, 0.5f + 0.5f * (i % 5) / 4.0f, 0.5f + 0.5f * (i % 7) / 6.0f, 1.0f);
+        object.Normal = glm::mat3(1.0f);
+        object.Fade[0] = object.Fade[1] = 1.0f;
+        object.UvOffset = glm::vec2(0.0f);
+    }
+
+    UniformBuffer camera(s_CameraLayout.GetSize());
+    unsigned int objectStride = RoundUpUniformOffset(s_ObjectLayout.GetSize(), UniformBuffer::GetOffsetAlignment());
+    Renderer renderer;
+
+    const unsigned int pathCount = 3;
+    const char* labels[pathCount] = { "  glUniform* per draw         ", "  Uniform buffers, persistent  ",
+        "  Uniform buffers, staging     " };
+    std::vector<unsigned char> images[pathCount];
+    for (unsigned int path = 0; path < pathCount; path++)
+    {
+        if (path == 1 && !StreamingVertexBuffer::IsPersistentMappingSupported())
+            continue;
+        std::unique_ptr<UniformRingBuffer> ring;
+        if (path > 0)
+            ring.reset(new UniformRingBuffer(objectStride * objectCount, 3, path == 1));
+        std::vector<unsigned int> offsets(objectCount);
+
+        std::vector<double> frameTimes;
+        unsigned int uploads = 0;
+        for (unsigned int frame = 0; frame < frames; frame++)
+        {
+            CameraData cameraData;
+            cameraData.ViewProjection = glm::translate(glm::mat4(1.0f), glm::vec3(0.0001f * frame, 0.0f, 0.0f));
+            cameraData.Position = glm::vec3(0.0f, 0.0f, 1.0f);
+            cameraData.Time = (float)frame;
+
+            uploads = 0;
+            Timer timer;
+            renderer.Clear();
+            if (path == 0)
+            {
+                for (unsigned int i = 0; i < objectCount; i++)
+                {
+                    unsigned int program = i * programCount / objectCount;
+                    Shader& shader = uniformShaders[program];
+                    shader.Bind();
+                    shader.SetUniformMat4f(handles[program].ViewProjection, cameraData.ViewProjection);
+                    shader.SetUniformMat4f(handles[program].Model, objects[i].Model);
+                    const glm::vec4& color = objects[i].Color;
+                    shader.SetUniform4f(handles[program].Color, color.r, color.g, color.b, color.a);
+                    renderer.Draw(va, ib, shader);
+                    uploads += 3;
+                }
+            }
+            else
+            {
+                camera.SetData(&cameraData, s_CameraLayout);
+                camera.Bind(cameraBinding);
+                for (unsigned int i = 0; i < objectCount; i++)
+                    offsets[i] = ring->Push(&objects[i], s_ObjectLayout);
+                for (unsigned int i = 0; i < objectCount; i++)
+                {
+                    ring->Bind(objectBinding, offsets[i], s_ObjectLayout.GetSize());
+                    renderer.Draw(va, ib, blockShaders[i * programCount / objectCount]);
+                }
+                ring->EndFrame();
+                uploads = 1 + ring->GetFlushCount();
+                ring->ResetStats();
+            }
+            GLCall(glFinish());
+            frameTimes.push_back(timer.ElapsedMs());
+        }
+        images[path].resize(640 * 480 * 4);
+        GLCall(glReadPixels(0, 0, 640, 480, GL_RGBA, GL_UNSIGNED_BYTE, images[path].data()));
+
+        PrintFrameTimes(labels[path], frameTimes);
+        std::cout << "    " << uploads << (path == 0 ? " glUniform* calls" : " buffer uploads") << " per frame" << std::endl;
+    }
+
+    bool identical = true;
+    for (unsigned int path = 1; path < pathCount; path++)
+        identical = identical && (images[path].empty() || images[path] == images[0]);
+    std::cout << "  Block layouts " << (layoutsMatch ? "match the driver" : "DIFFER from the driver") << ", rendered pixels "
+        << (identical ? "identical" : "DIFFERENT") << std::endl;
+    return layoutsMatch && identical ? 0 : 1;
+}
+
+void PrintFrameTimes(const char* label, std::vector<double> frameTimesMs)
+{
+    if (frameTimesMs.empty())
+        return;
+
+    std::sort(frameTimesMs.begin(), frameTimesMs.end());
+    double total = 0.0;
+    for (double ms : frameTimesMs)
+        total += ms;
+    double average = total / frameTimesMs.size();
+    auto percentile = [&frameTimesMs](double p) { return frameTimesMs[(size_t)(p * (frameTimesMs.size() - 1))]; };
+
+    std::cout << label << ": " << frameTimesMs.size() << " frames, avg " << average << " ms (" << 1000.0 / average
+        << " fps), min " << frameTimesMs.front() << " ms, p50 " << percentile(0.5) << " ms, p95 " << percentile(0.95)
+        << " ms, p99 " << percentile(0.99) << " ms, max " << frameTimesMs.back() << " ms" << std::endl;
+}
+
+int RunBenchmark(const std::string& name)
+{
+    if (name == "--bench-batch")
+        return BenchmarkBatchRenderer(100000, 20);
+    if (name == "--bench-instanced")
+        return BenchmarkInstancing(50000, 20);
+    if (name == "--bench-indirect")
+        return BenchmarkMultiDrawIndirect(256, 100);
+    if (name == "--bench-streaming")
+        return BenchmarkStreaming(64, 1000, 100);
+    if (name == "--bench-upload")
+        return BenchmarkUploadStrategies(64 * 1024, 128, 50);
+    if (name == "--bench-arena")
+        return BenchmarkBufferArena(10000, 20);
+    if (name == "--bench-vertexformat")
+        return BenchmarkVertexFormats(1000, 20);
+    if (name == "--bench-lod")
+        return BenchmarkLod(128, 256, 10);
+    if (name == "--bench-pool")
+        return BenchmarkResourcePool(20000, 2000, 100);
+    if (name == "--bench-dsa")
+        return BenchmarkDirectStateAccess(5000);
+    if (name == "--bench-formatcache")
+        return BenchmarkVertexFormatCache(5000, 20);
+    if (name == "--bench-shadercache")
+        return BenchmarkShaderCache(20);
+    if (name == "--bench-shadercompile")
+        return BenchmarkShaderCompileQueue(64);
+    if (name == "--bench-uniforms")
+        return BenchmarkUniforms(1000000);
+    if (name == "--bench-uniformbuffer")
+        return BenchmarkUniformBuffers(4000, 4, 50);
+    if (name == "--bench-drawqueue")
+        return BenchmarkDrawQueue(1000000, 10);
+    if (name == "--bench-commands")
+    {
+        unsigned int threads = std::thread::hardware_concurrency();
+        return BenchmarkCommandRecording(1000000, threads > 1 ? threads : 4);
+    }
+    if (name == "--bench-meshopt")
+        return BenchmarkMeshOptimizer(1000, 1000);
+
+    std::cout << "Unknown benchmark '" << name << "'" << std::endl;
+    return -1;
+}
@@ -0,0 +1,19 @@
+#pragma once
+#include <string>
+#include <vector>
+
+#include "BufferUploader.h"
+
+/* Runs the benchmark selected on the command line (e.g. --bench-batch) against the current GL context.
+   Returns the process exit code, -1 when the name doesn't match any benchmark. */
+int RunBenchmark(const std::string& name);
+
+//CPU only benchmarks are run before any window or context gets created
+bool BenchmarkNeedsContext(const std::string& name);
+
+//Prints the average, min, max and percentiles of a run's frame times
+void PrintFrameTimes(const char* label, std::vector<double> frameTimesMs);
+
+/* Picks the fastest upload strategy of the running driver and makes it the default of new buffers. The choice is
+   recorded to recordPath with the driver it was measured on, the measure only runs again when the driver changes. */
+UploadStrategy SelectUploadStrategy(const std::string& recordPath);
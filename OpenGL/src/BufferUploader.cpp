@@ -0,0 +1,311 @@
+#include "BufferUploader.h"
+#include "Renderer.h"
+#include "GLFence.h"
+
+#include <algorithm>
+#include <cstring>
+
+static const char* s_StrategyNames[BufferUploader::StrategyCount] = {
+    "SubData", "Orphan", "MapUnsynchronized", "PersistentMap"
+};
+
+static const GLbitfield s_PersistentFlags = GL_MAP_WRITE_BIT | GL_MAP_PERSISTENT_BIT | GL_MAP_COHERENT_BIT;
+
+BufferUploader::BufferUploader()
+    : m_Strategy(UploadStrategy::SubData), m_FrameFence(nullptr), m_Frame(0), m_SyncWaits(0), m_RewriteSyncs(0)
+{
+}
+
+BufferUploader& BufferUploader::Get()
+{
+    static BufferUploader instance;
+    return instance;
+}
+
+/* @brief: Applies to the buffers created from now on, the existing ones keep the strategy they were created with
+*/
+void BufferUploader::SetStrategy(UploadStrategy strategy)
+{
+    m_Strategy = IsSupported(strategy) ? strategy : UploadStrategy::SubData;
+}
+
+const char* BufferUploader::GetStrategyName(UploadStrategy strategy)
+{
+    return s_StrategyNames[(int)strategy];
+}
+
+bool BufferUploader::ParseStrategy(const std::string& name, UploadStrategy& strategy)
+{
+    for (unsigned int i = 0; i < StrategyCount; i++)
+    {
+        if (name == s_StrategyNames[i])
+        {
+            strategy = (UploadStrategy)i;
+            return true;
+        }
+    }
+    return false;
+}
+
+bool BufferUploader::IsSupported(UploadStrategy strategy)
+{
+#ifdef OGL_TRACE
+    //GLTrace doesn't see the writes made through a mapping, a replay would miss them
+    if (strategy == UploadStrategy::MapUnsynchronized || strategy == UploadStrategy::PersistentMap)
+        return false;
+#endif
+    if (strategy == UploadStrategy::PersistentMap)
+        return GLEW_VERSION_4_4 || GLEW_ARB_buffer_storage;
+    return true;
+}
+
+unsigned int BufferUploader::CreateBuffer()
+{
+    unsigned int buffer = 0;
+    if (GLDirectStateAccessActive())
+    {
+        GLCall(glCreateBuffers(1, &buffer));
+    }
+    else
+    {
+        GLCall(glGenBuffers(1, &buffer));
+    }
+    return buffer;
+}
+
+/* @brief: Creates the storage of a buffer. Buffers are bound to GL_COPY_WRITE_BUFFER to be filled, binding an index
+           buffer to GL_ELEMENT_ARRAY_BUFFER would attach it to whatever vertex array is bound. With DSA nothing gets
+           bound, and static buffers get immutable storage.
+*/
+void BufferUploader::Allocate(unsigned int buffer, BufferStorage& storage, unsigned int size, const void* data, BufferUsage usage)
+{
+    storage.Size = size;
+    //Static buffers are rarely updated, glBufferSubData is the one way drivers expect them to be. Dynamic ones are
+    //updated between draws, which only the driver's copy handles
+    if (usage == BufferUsage::PerFrame)
+        storage.Strategy = m_Strategy;
+    else if (usage == BufferUsage::Dynamic && m_Strategy == UploadStrategy::Orphan)
+        storage.Strategy = UploadStrategy::Orphan;
+    else
+        storage.Strategy = UploadStrategy::SubData;
+    //Draws of this frame may read the initial data
+    storage.Frame = m_Frame;
+    storage.WrittenBegin = 0;
+    storage.WrittenEnd = data ? size : 0;
+    bool dynamic = usage != BufferUsage::Static;
+
+    if (GLDirectStateAccessActive())
+    {
+        if (storage.Strategy == UploadStrategy::PersistentMap)
+        {
+            GLCall(glNamedBufferStorage(buffer, size, data, s_PersistentFlags));
+            GLCall(storage.Mapped = (char*)glMapNamedBufferRange(buffer, 0, size, s_PersistentFlags));
+        }
+        else if (!dynamic)
+        {
+            GLCall(glNamedBufferStorage(buffer, size, data, GL_DYNAMIC_STORAGE_BIT));
+        }
+        else
+        {
+            //Orphaning respecifies the storage, it can't be immutable
+            GLCall(glNamedBufferData(buffer, size, data, GL_DYNAMIC_DRAW));
+        }
+        return;
+    }
+
+    GLCall(glBindBuffer(GL_COPY_WRITE_BUFFER, buffer));
+    if (storage.Strategy == UploadStrategy::PersistentMap)
+    {
+        GLCall(glBufferStorage(GL_COPY_WRITE_BUFFER, size, data, s_PersistentFlags));
+        GLCall(storage.Mapped = (char*)glMapBufferRange(GL_COPY_WRITE_BUFFER, 0, size, s_PersistentFlags));
+    }
+    else
+    {
+        GLCall(glBufferData(GL_COPY_WRITE_BUFFER, size, data, dynamic ? GL_DYNAMIC_DRAW : GL_STATIC_DRAW));
+    }
+}
+
+void BufferUploader::Release(unsigned int buffer, BufferStorage& storage)
+{
+    if (!storage.Mapped)
+        return;
+    if (GLDirectStateAccessActive())
+    {
+        GLCall(glUnmapNamedBuffer(buffer));
+    }
+    else
+    {
+        GLCall(glBindBuffer(GL_COPY_WRITE_BUFFER, buffer));
+        GLCall(glUnmapBuffer(GL_COPY_WRITE_BUFFER));
+    }
+    storage.Mapped = nullptr;
+}
+
+void BufferUploader::Update(unsigned int buffer, BufferStorage& storage, unsigned int offset, const void* data, unsigned int size)
+{
+    ASSERT(offset + size <= storage.Size);
+    if (size == 0)
+        return;
+
+    if (GLDirectStateAccessActive())
+    {
+        UpdateNamed(buffer, storage, offset, data, size);
+        return;
+    }
+
+    switch (storage.Strategy)
+    {
+    case UploadStrategy::SubData:
+        GLCall(glBindBuffer(GL_COPY_WRITE_BUFFER, buffer));
+        GLCall(glBufferSubData(GL_COPY_WRITE_BUFFER, offset, size, data));
+        break;
+    case UploadStrategy::Orphan:
+        GLCall(glBindBuffer(GL_COPY_WRITE_BUFFER, buffer));
+        //Orphaning a partially updated buffer would lose the rest of its content
+        if (offset == 0 && size == storage.Size)
+        {
+            GLCall(glBufferData(GL_COPY_WRITE_BUFFER, size, nullptr, GL_DYNAMIC_DRAW));
+        }
+        GLCall(glBufferSubData(GL_COPY_WRITE_BUFFER, offset, size, data));
+        break;
+    case UploadStrategy::MapUnsynchronized:
+    {
+        WaitForPreviousFrame();
+        GLCall(glBindBuffer(GL_COPY_WRITE_BUFFER, buffer));
+        //A range draws of this frame may read, the driver's copy synchronizes
+        if (!IsUnsynchronizedWrite(storage, offset, size))
+        {
+            GLCall(glBufferSubData(GL_COPY_WRITE_BUFFER, offset, size, data));
+            break;
+        }
+        GLCall(void* mapped = glMapBufferRange(GL_COPY_WRITE_BUFFER, offset, size,
+            GL_MAP_WRITE_BIT | GL_MAP_INVALIDATE_RANGE_BIT | GL_MAP_UNSYNCHRONIZED_BIT));
+        //Mapping can fail, e.g. out of address space, the driver still takes a copy then
+        if (!mapped)
+        {
+            GLCall(glBufferSubData(GL_COPY_WRITE_BUFFER, offset, size, data));
+            break;
+        }
+        memcpy(mapped, data, size);
+        GLCall(glUnmapBuffer(GL_COPY_WRITE_BUFFER));
+        break;
+    }
+    case UploadStrategy::PersistentMap:
+        WaitForPreviousFrame();
+        if (!IsUnsynchronizedWrite(storage, offset, size))
+        {
+            //Nothing issued before reads the buffer anymore, only this range is in use from now on
+            WaitForGpu();
+            storage.WrittenBegin = offset;
+            storage.WrittenEnd = offset + size;
+        }
+        memcpy(storage.Mapped + offset, data, size);
+        break;
+    }
+}
+
+/* @brief: Update through DSA, same strategies without any bind
+*/
+void BufferUploader::UpdateNamed(unsigned int buffer, BufferStorage& storage, unsigned int offset, const void* data, unsigned int size)
+{
+    switch (storage.Strategy)
+    {
+    case UploadStrategy::SubData:
+        GLCall(glNamedBufferSubData(buffer, offset, size, data));
+        break;
+    case UploadStrategy::Orphan:
+        if (offset == 0 && size == storage.Size)
+        {
+            GLCall(glNamedBufferData(buffer, size, nullptr, GL_DYNAMIC_DRAW));
+        }
+        GLCall(glNamedBufferSubData(buffer, offset, size, data));
+        break;
+    case UploadStrategy::MapUnsynchronized:
+    {
+        WaitForPreviousFrame();
+        if (!IsUnsynchronizedWrite(storage, offset, size))
+        {
+            GLCall(glNamedBufferSubData(buffer, offset, size, data));
+            break;
+        }
+        GLCall(void* mapped = glMapNamedBufferRange(buffer, offset, size,
+            GL_MAP_WRITE_BIT | GL_MAP_INVALIDATE_RANGE_BIT | GL_MAP_UNSYNCHRONIZED_BIT));
+        if (!mapped)
+        {
+            GLCall(glNamedBufferSubData(buffer, offset, size, data));
+            break;
+        }
+        memcpy(mapped, data, size);
+        GLCall(glUnmapNamedBuffer(buffer));
+        break;
+    }
+    case UploadStrategy::PersistentMap:
+        WaitForPreviousFrame();
+        if (!IsUnsynchronizedWrite(storage, offset, size))
+        {
+            //Nothing issued before reads the buffer anymore, only this range is in use from now on
+            WaitForGpu();
+            storage.WrittenBegin = offset;
+            storage.WrittenEnd = offset + size;
+        }
+        memcpy(storage.Mapped + offset, data, size);
+        break;
+    }
+}
+
+/* @brief: Fences the frame, the mapping strategies make sure it's done before writing into buffers it may read.
+           PerFrame buffers can have each range written once again.
+*/
+void BufferUploader::EndFrame()
+{
+    m_Frame++;
+    //Traced builds have no mapping strategy
+#ifndef OGL_TRACE
+    if (m_FrameFence)
+    {
+        GLCall(glDeleteSync(m_FrameFence));
+    }
+    GLCall(m_FrameFence = glFenceSync(GL_SYNC_GPU_COMMANDS_COMPLETE, 0));
+#endif
+}
+
+/* @brief: Records the range as written this frame. Returns false when it overlaps what was already written this
+           frame, draws issued since may read it. Only the extent of the frame's writes is kept: ranges written in
+           order never overlap it, others may synchronize without need.
+*/
+bool BufferUploader::IsUnsynchronizedWrite(BufferStorage& storage, unsigned int offset, unsigned int size)
+{
+    unsigned int end = offset + size;
+    if (storage.Frame != m_Frame || storage.WrittenBegin == storage.WrittenEnd)
+    {
+        storage.Frame = m_Frame;
+        storage.WrittenBegin = offset;
+        storage.WrittenEnd = end;
+        return true;
+    }
+
+    bool overlaps = offset < storage.WrittenEnd && end > storage.WrittenBegin;
+    storage.WrittenBegin = std::min(storage.WrittenBegin, offset);
+    storage.WrittenEnd = std::max(storage.WrittenEnd, end);
+    if (overlaps)
+        m_RewriteSyncs++;
+    return !overlaps;
+}
+
+/* @brief: Waits for everything issued so far to be done on the GPU
+*/
+void BufferUploader::WaitForGpu()
+{
+    GLCall(GLsync fence = glFenceSync(GL_SYNC_GPU_COMMANDS_COMPLETE, 0));
+    WaitForFence(fence);
+}
+
+void BufferUploader::WaitForPreviousFrame()
+{
+    if (!m_FrameFence)
+        return;
+
+    if (WaitForFence(m_FrameFence) > 0.0)
+        m_SyncWaits++;
+    m_FrameFence = nullptr;
+}
@@ -0,0 +1,76 @@
+#pragma once
+#include <GL/glew.h>
+#include <string>
+
+/* How VertexBuffer::Update and IndexBuffer::Update get their data to the GPU:
+     SubData             glBufferSubData, the driver copies and synchronizes
+     Orphan              updates of the whole buffer reallocate it with glBufferData first so the driver never waits
+                         on the old storage, partial updates go through glBufferSubData
+     MapUnsynchronized   glMapBufferRange with GL_MAP_UNSYNCHRONIZED_BIT, then a memcpy
+     PersistentMap       memcpy into a persistent coherent mapping (GL 4.4 / ARB_buffer_storage)
+   Which buffers use the selected strategy depends on their BufferUsage. */
+enum class UploadStrategy {
+	SubData = 0, Orphan, MapUnsynchronized, PersistentMap
+};
+
+/* How a buffer gets updated, declared when it's created:
+     Static     rarely, always glBufferSubData
+     Dynamic    any number of times a frame, between draws reading it: glBufferSubData, or Orphan when selected
+     PerFrame   each range once a frame before the draws reading it, BufferUploader::EndFrame being called at the
+                end of every frame: any strategy
+   The mapping strategies wait for the previous frame to be done on the GPU before their first write of a frame. A
+   PerFrame range written again in the same frame (or before the first EndFrame) may still be read by a draw, that
+   write synchronizes: glBufferSubData for MapUnsynchronized, a wait for the GPU for PersistentMap. */
+enum class BufferUsage {
+	Static, Dynamic, PerFrame
+};
+
+//Upload state of a buffer, kept by the buffer
+struct BufferStorage {
+	unsigned int Size = 0;
+	UploadStrategy Strategy = UploadStrategy::SubData;
+	char* Mapped = nullptr;
+	//Frame of the last write and the bytes written during it, for the mapping strategies
+	unsigned int Frame = 0;
+	unsigned int WrittenBegin = 0;
+	unsigned int WrittenEnd = 0;
+};
+
+class BufferUploader {
+public:
+	static const unsigned int StrategyCount = 4;
+
+private:
+	UploadStrategy m_Strategy;
+	GLsync m_FrameFence;
+	unsigned int m_Frame;
+	unsigned int m_SyncWaits;
+	unsigned int m_RewriteSyncs;
+
+	BufferUploader();
+	void WaitForPreviousFrame();
+	void WaitForGpu();
+	bool IsUnsynchronizedWrite(BufferStorage& storage, unsigned int offset, unsigned int size);
+	void UpdateNamed(unsigned int buffer, BufferStorage& storage, unsigned int offset, const void* data, unsigned int size);
+
+public:
+	static BufferUploader& Get();
+
+	void SetStrategy(UploadStrategy strategy);
+	inline UploadStrategy GetStrategy() const { return m_Strategy; }
+
+	static const char* GetStrategyName(UploadStrategy strategy);
+	static bool ParseStrategy(const std::string& name, UploadStrategy& strategy);
+	static bool IsSupported(UploadStrategy strategy);
+
+	//A buffer name the current path (see GLDirectStateAccess.h) can allocate
+	static unsigned int CreateBuffer();
+	void Allocate(unsigned int buffer, BufferStorage& storage, unsigned int size, const void* data, BufferUsage usage);
+	void Release(unsigned int buffer, BufferStorage& storage);
+	void Update(unsigned int buffer, BufferStorage& storage, unsigned int offset, const void* data, unsigned int size);
+
+	void EndFrame();
+	inline unsigned int GetSyncWaits() const { return m_SyncWaits; }
+	//Writes of the mapping strategies that had to synchronize, see BufferUsage
+	inline unsigned int GetRewriteSyncs() const { return m_RewriteSyncs; }
+};
@@ -0,0 +1,55 @@
+#include "CacheDirectory.h"
+
+#include <cstdlib>
+
+#ifdef _WIN32
+#include <direct.h>
+#include <sys/stat.h>
+#define stat _stat
+#else
+#include <sys/stat.h>
+#endif
+
+bool MakeDirectory(const std::string& path)
+{
+#ifdef _WIN32
+    _mkdir(path.c_str());
+#else
+    mkdir(path.c_str(), 0755);
+#endif
+    struct stat info;
+    return stat(path.c_str(), &info) == 0 && (info.st_mode & S_IFDIR) != 0;
+}
+
+static std::string FindCacheDirectory()
+{
+#ifdef _WIN32
+    if (const char* localAppData = std::getenv("LOCALAPPDATA"))
+        return std::string(localAppData) + "/OpenGL";
+#else
+    if (const char* cacheHome = std::getenv("XDG_CACHE_HOME"))
+    {
+        if (*cacheHome)
+            return std::string(cacheHome) + "/OpenGL";
+    }
+    //~/.cache may not exist yet on a fresh account
+    if (const char* home = std::getenv("HOME"))
+    {
+        if (*home && MakeDirectory(std::string(home) + "/.cache"))
+            return std::string(home) + "/.cache/OpenGL";
+    }
+#endif
+    return "cache";
+}
+
+const std::string& GetCacheDirectory()
+{
+    static std::string s_Directory;
+    if (s_Directory.empty())
+    {
+        s_Directory = FindCacheDirectory();
+        if (!MakeDirectory(s_Directory))
+            s_Directory = ".";
+    }
+    return s_Directory;
+}
@@ -0,0 +1,11 @@
+#pragma once
+#include <string>
+
+/* Where the files measured or built once per machine go: the upload strategy record of SelectUploadStrategy and the
+   program binaries of ShaderBinaryCache.
+   %LOCALAPPDATA%/OpenGL on Windows, $XDG_CACHE_HOME/OpenGL or ~/.cache/OpenGL elsewhere, "cache" in the working
+   directory when none of them is set. Created on first use. */
+const std::string& GetCacheDirectory();
+
+//Creates one directory level, returns whether it exists afterwards
+bool MakeDirectory(const std::string& path);
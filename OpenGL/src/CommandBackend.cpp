@@ -0,0 +1,99 @@
+#include "CommandBackend.h"
+#include "Renderer.h"
+
+#include <cstring>
+
+GLCommandBackend::GLCommandBackend()
+    : m_Program(Unknown), m_SkippedDraws(0)
+{
+}
+
+void GLCommandBackend::UseProgram(unsigned int program)
+{
+    GLStateCache::Get().UseProgram(program);
+    m_Program = program;
+}
+
+void GLCommandBackend::BindVertexArray(unsigned int vertexArray)
+{
+    GLStateCache::Get().BindVertexArray(vertexArray);
+}
+
+void GLCommandBackend::BindIndexBuffer(unsigned int indexBuffer)
+{
+    GLStateCache::Get().BindElementBuffer(indexBuffer);
+}
+
+void GLCommandBackend::BindTexture(unsigned int unit, unsigned int texture)
+{
+    GLStateCache::Get().BindTexture(unit, texture);
+}
+
+//glUniform* without a program is an error
+void GLCommandBackend::SetUniform(int location, UniformBlob::Type type, const void* payload)
+{
+    if (m_Program == 0)
+        return;
+    UniformBlob::SetUniform(location, type, payload);
+}
+
+void GLCommandBackend::DrawIndexed(unsigned int count, unsigned int indexType)
+{
+    if (m_Program == 0)
+    {
+        m_SkippedDraws++;
+        return;
+    }
+    GLCall(glDrawElements(GL_TRIANGLES, count, indexType, nullptr));
+}
+
+bool RecordingCommandBackend::Command::operator==(const Command& other) const
+{
+    if (Type != other.Type || Args[0] != other.Args[0] || Args[1] != other.Args[1])
+        return false;
+    if (Type != CommandType::SetUniform)
+        return true;
+    return UniformType == other.UniformType
+        && memcmp(Payload, other.Payload, UniformBlob::GetPayloadSize(UniformType)) == 0;
+}
+
+void RecordingCommandBackend::Push(CommandType type, unsigned int arg0, unsigned int arg1)
+{
+    Command command = {};
+    command.Type = type;
+    command.Args[0] = arg0;
+    command.Args[1] = arg1;
+    m_Commands.push_back(command);
+}
+
+void RecordingCommandBackend::UseProgram(unsigned int program)
+{
+    Push(CommandType::UseProgram, program);
+}
+
+void RecordingCommandBackend::BindVertexArray(unsigned int vertexArray)
+{
+    Push(CommandType::BindVertexArray, vertexArray);
+}
+
+void RecordingCommandBackend::BindIndexBuffer(unsigned int indexBuffer)
+{
+    Push(CommandType::BindIndexBuffer, indexBuffer);
+}
+
+void RecordingCommandBackend::BindTexture(unsigned int unit, unsigned int texture)
+{
+    Push(CommandType::BindTexture, unit, texture);
+}
+
+void RecordingCommandBackend::SetUniform(int location, UniformBlob::Type type, const void* payload)
+{
+    Push(CommandType::SetUniform, (unsigned int)location);
+    m_Commands.back().UniformType = type;
+    memcpy(m_Commands.back().Payload, payload, UniformBlob::GetPayloadSize(type));
+}
+
+void RecordingCommandBackend::DrawIndexed(unsigned int count, unsigned int indexType)
+{
+    Push(CommandType::DrawIndexed, count, indexType);
+}
@@ -0,0 +1,73 @@
+#pragma once
+#include <vector>
+
+#include "DrawQueue.h"
+
+enum class CommandType : int { UseProgram, BindVertexArray, BindIndexBuffer, BindTexture, SetUniform, DrawIndexed };
+
+/* Receives the commands of a CommandBuffer when it is replayed. */
+class CommandBackend {
+public:
+	virtual ~CommandBackend() {}
+
+	virtual void UseProgram(unsigned int program) = 0;
+	virtual void BindVertexArray(unsigned int vertexArray) = 0;
+	virtual void BindIndexBuffer(unsigned int indexBuffer) = 0;
+	virtual void BindTexture(unsigned int unit, unsigned int texture) = 0;
+	virtual void SetUniform(int location, UniformBlob::Type type, const void* payload) = 0;
+	virtual void DrawIndexed(unsigned int count, unsigned int indexType) = 0;
+};
+
+/* Executes the commands on the current GL context, binds go through the GLStateCache. After UseProgram(0), which
+   CommandBuffer::BindShader records for a shader that isn't ready, uniforms and draws are skipped until the next
+   program. */
+class GLCommandBackend : public CommandBackend {
+private:
+	static const unsigned int Unknown = 0xFFFFFFFF;
+	//Unknown until the first UseProgram, whatever is bound is used then
+	unsigned int m_Program;
+	unsigned int m_SkippedDraws;
+
+public:
+	GLCommandBackend();
+
+	void UseProgram(unsigned int program) override;
+	void BindVertexArray(unsigned int vertexArray) override;
+	void BindIndexBuffer(unsigned int indexBuffer) override;
+	void BindTexture(unsigned int unit, unsigned int texture) override;
+	void SetUniform(int location, UniformBlob::Type type, const void* payload) override;
+	void DrawIndexed(unsigned int count, unsigned int indexType) override;
+
+	inline unsigned int GetSkippedDraws() const { return m_SkippedDraws; }
+};
+
+/* Keeps a flat copy of every command instead of executing it, so a replay can be checked without a GPU. */
+class RecordingCommandBackend : public CommandBackend {
+public:
+	struct Command {
+		CommandType Type;
+		unsigned int Args[2];
+		//Only used by SetUniform
+		UniformBlob::Type UniformType;
+		float Payload[16];
+
+		bool operator==(const Command& other) const;
+		bool operator!=(const Command& other) const { return !(*this == other); }
+	};
+
+private:
+	std::vector<Command> m_Commands;
+
+	void Push(CommandType type, unsigned int arg0, unsigned int arg1 = 0);
+
+public:
+	void UseProgram(unsigned int program) override;
+	void BindVertexArray(unsigned int vertexArray) override;
+	void BindIndexBuffer(unsigned int indexBuffer) override;
+	void BindTexture(unsigned int unit, unsigned int texture) override;
+	void SetUniform(int location, UniformBlob::Type type, const void* payload) override;
+	void DrawIndexed(unsigned int count, unsigned int indexType) override;
+
+	inline const std::vector<Command>& GetCommands() const { return m_Commands; }
+	inline void Clear() { m_Commands.clear(); }
+};
@@ -0,0 +1,144 @@
+#include "CommandBuffer.h"
+#include "Shader.h"
+#include "VertexArray.h"
+#include "IndexBuffer.h"
+#include "Texture.h"
+
+#include <cstring>
+
+CommandBuffer::CommandBuffer()
+    : m_CommandCount(0)
+{
+}
+
+void CommandBuffer::Write(const void* data, unsigned int size)
+{
+    size_t offset = m_Data.size();
+    m_Data.resize(offset + size);
+    memcpy(&m_Data[offset], data, size);
+}
+
+void CommandBuffer::WriteCommand(CommandType type, unsigned int arg0, unsigned int arg1)
+{
+    unsigned int command[3] = { (unsigned int)type, arg0, arg1 };
+    Write(command, sizeof(command));
+    m_CommandCount++;
+}
+
+//A shader that isn't ready records program 0, the draws using it are skipped by GLCommandBackend
+void CommandBuffer::BindShader(const Shader& shader)
+{
+    UseProgram(shader.PeekStatus() == ShaderStatus::Ready ? shader.GetRendererID() : 0);
+}
+
+void CommandBuffer::BindVertexArray(const VertexArray& va)
+{
+    BindVertexArray(va.GetRendererID());
+}
+
+void CommandBuffer::BindIndexBuffer(const IndexBuffer& ib)
+{
+    BindIndexBuffer(ib.GetRendererID());
+}
+
+void CommandBuffer::BindTexture(unsigned int unit, const Texture& texture)
+{
+    BindTexture(unit, texture.GetRendererID());
+}
+
+/* @brief: Draws every index of the buffer with its index type
+*/
+void CommandBuffer::DrawIndexed(const IndexBuffer& ib)
+{
+    DrawIndexed(ib.getCount(), ib.GetType());
+}
+
+void CommandBuffer::UseProgram(unsigned int program)
+{
+    WriteCommand(CommandType::UseProgram, program);
+}
+
+void CommandBuffer::BindVertexArray(unsigned int vertexArray)
+{
+    WriteCommand(CommandType::BindVertexArray, vertexArray);
+}
+
+void CommandBuffer::BindIndexBuffer(unsigned int indexBuffer)
+{
+    WriteCommand(CommandType::BindIndexBuffer, indexBuffer);
+}
+
+void CommandBuffer::BindTexture(unsigned int unit, unsigned int texture)
+{
+    WriteCommand(CommandType::BindTexture, unit, texture);
+}
+
+//Uniforms are written as the command followed by GetPayloadSize(type) bytes of payload
+void CommandBuffer::SetUniform1i(int location, int value)
+{
+    WriteCommand(CommandType::SetUniform, (unsigned int)location, (unsigned int)UniformBlob::Type::Int);
+    Write(&value, sizeof(int));
+}
+
+void CommandBuffer::SetUniform1f(int location, float value)
+{
+    WriteCommand(CommandType::SetUniform, (unsigned int)location, (unsigned int)UniformBlob::Type::Float);
+    Write(&value, sizeof(float));
+}
+
+void CommandBuffer::SetUniform4f(int location, float v0, float v1, float v2, float v3)
+{
+    float values[4] = { v0, v1, v2, v3 };
+    WriteCommand(CommandType::SetUniform, (unsigned int)location, (unsigned int)UniformBlob::Type::Vec4);
+    Write(values, sizeof(values));
+}
+
+void CommandBuffer::SetUniformMat4f(int location, const glm::mat4& matrix)
+{
+    WriteCommand(CommandType::SetUniform, (unsigned int)location, (unsigned int)UniformBlob::Type::Mat4);
+    Write(&matrix[0][0], 16 * sizeof(float));
+}
+
+void CommandBuffer::DrawIndexed(unsigned int count, unsigned int indexType)
+{
+    WriteCommand(CommandType::DrawIndexed, count, indexType);
+}
+
+void CommandBuffer::Replay(CommandBackend& backend) const
+{
+    size_t offset = 0;
+    while (offset < m_Data.size())
+    {
+        unsigned int command[3];
+        memcpy(command, &m_Data[offset], sizeof(command));
+        offset += sizeof(command);
+
+        switch ((CommandType)command[0])
+        {
+            case CommandType::UseProgram:      backend.UseProgram(command[1]); break;
+            case CommandType::BindVertexArray: backend.BindVertexArray(command[1]); break;
+            case CommandType::BindIndexBuffer: backend.BindIndexBuffer(command[1]); break;
+            case CommandType::BindTexture:     backend.BindTexture(command[1], command[2]); break;
+            case CommandType::DrawIndexed:     backend.DrawIndexed(command[1], command[2]); break;
+            case CommandType::SetUniform:
+            {
+                UniformBlob::Type type = (UniformBlob::Type)command[2];
+                backend.SetUniform((int)command[1], type, &m_Data[offset]);
+                offset += UniformBlob::GetPayloadSize(type);
+                break;
+            }
+        }
+    }
+}
+
+void CommandBuffer::Clear()
+{
+    m_Data.clear();
+    m_CommandCount = 0;
+}
+
+void ParallelCommandRecorder::Replay(CommandBackend& backend) const
+{
+    for (const CommandBuffer& commands : m_Buffers)
+        commands.Replay(backend);
+}
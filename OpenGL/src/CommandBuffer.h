@@ -0,0 +1,94 @@
+#pragma once
+#include <thread>
+#include <vector>
+
+#include "CommandBackend.h"
+
+class Shader;
+class VertexArray;
+class IndexBuffer;
+class Texture;
+
+/* Draw, bind and uniform commands packed in a byte stream. Recording doesn't touch GL (the objects only give their ids),
+   so worker threads can fill their own buffer while the render thread owns the context. Uniform locations have
+   to be resolved on the GL thread beforehand, Shader::GetUniformLocation calls into GL. */
+class CommandBuffer {
+private:
+	std::vector<unsigned char> m_Data;
+	unsigned int m_CommandCount;
+
+	void Write(const void* data, unsigned int size);
+	void WriteCommand(CommandType type, unsigned int arg0, unsigned int arg1 = 0);
+
+public:
+	CommandBuffer();
+
+	void BindShader(const Shader& shader);
+	void BindVertexArray(const VertexArray& va);
+	void BindIndexBuffer(const IndexBuffer& ib);
+	void BindTexture(unsigned int unit, const Texture& texture);
+	void DrawIndexed(const IndexBuffer& ib);
+	//Same as above from raw GL ids
+	void UseProgram(unsigned int program);
+	void BindVertexArray(unsigned int vertexArray);
+	void BindIndexBuffer(unsigned int indexBuffer);
+	void BindTexture(unsigned int unit, unsigned int texture);
+	void SetUniform1i(int location, int value);
+	void SetUniform1f(int location, float value);
+	void SetUniform4f(int location, float v0, float v1, float v2, float v3);
+	void SetUniformMat4f(int location, const glm::mat4& matrix);
+	void DrawIndexed(unsigned int count, unsigned int indexType);
+
+	void Replay(CommandBackend& backend) const;
+	void Clear();
+
+	inline unsigned int GetCommandCount() const { return m_CommandCount; }
+};
+
+/* One CommandBuffer per worker thread. The items are split in contiguous ranges, worker i records range i into
+   buffer i and the buffers are replayed in index order, so the merged stream is the same as recording every
+   item on a single thread, whatever the thread count or scheduling. */
+class ParallelCommandRecorder {
+private:
+	std::vector<CommandBuffer> m_Buffers;
+
+public:
+	/* recordItem(CommandBuffer& commands, unsigned int item) is called once for each item in [0, itemCount) */
+	template<typename RecordFunc>
+	void Record(unsigned int itemCount, unsigned int threadCount, RecordFunc recordItem)
+	{
+		if (threadCount == 0)
+			threadCount = 1;
+		m_Buffers.resize(threadCount);
+
+		std::vector<std::thread> workers;
+		for (unsigned int t = 0; t < threadCount; t++)
+		{
+			unsigned int begin = (unsigned int)((unsigned long long)itemCount * t / threadCount);
+			unsigned int end = (unsigned int)((unsigned long long)itemCount * (t + 1) / threadCount);
+			CommandBuffer& commands = m_Buffers[t];
+			commands.Clear();
+
+			//The last range is recorded by the calling thread instead of idling in join
+			if (t == threadCount - 1)
+			{
+				for (unsigned int item = begin; item < end; item++)
+					recordItem(commands, item);
+			}
+			else
+			{
+				workers.emplace_back([&commands, &recordItem, begin, end]() {
+					for (unsigned int item = begin; item < end; item++)
+						recordItem(commands, item);
+				});
+			}
+		}
+
+		for (std::thread& worker : workers)
+			worker.join();
+	}
+
+	void Replay(CommandBackend& backend) const;
+
+	inline const std::vector<CommandBuffer>& GetBuffers() const { return m_Buffers; }
+};
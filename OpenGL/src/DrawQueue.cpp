@@ -0,0 +1,193 @@
+#include "DrawQueue.h"
+#include "Renderer.h"
+
+#include <cstring>
+
+struct UniformHeader {
+    int Location;
+    UniformBlob::Type Type;
+};
+
+unsigned int UniformBlob::GetPayloadSize(Type type)
+{
+    switch (type)
+    {
+        case Type::Int:   return sizeof(int);
+        case Type::Float: return sizeof(float);
+        case Type::Vec4:  return 4 * sizeof(float);
+        case Type::Mat4:  return 16 * sizeof(float);
+    }
+    ASSERT(false);
+    return 0;
+}
+
+void UniformBlob::Push(int location, Type type, const void* data, unsigned int size)
+{
+    UniformHeader header = { location, type };
+    size_t offset = m_Data.size();
+    m_Data.resize(offset + sizeof(UniformHeader) + size);
+    memcpy(&m_Data[offset], &header, sizeof(UniformHeader));
+    memcpy(&m_Data[offset + sizeof(UniformHeader)], data, size);
+}
+
+void UniformBlob::SetUniform1i(int location, int value)
+{
+    Push(location, Type::Int, &value, sizeof(int));
+}
+
+void UniformBlob::SetUniform1f(int location, float value)
+{
+    Push(location, Type::Float, &value, sizeof(float));
+}
+
+void UniformBlob::SetUniform4f(int location, float v0, float v1, float v2, float v3)
+{
+    float values[4] = { v0, v1, v2, v3 };
+    Push(location, Type::Vec4, values, sizeof(values));
+}
+
+void UniformBlob::SetUniformMat4f(int location, const glm::mat4& matrix)
+{
+    Push(location, Type::Mat4, &matrix[0][0], 16 * sizeof(float));
+}
+
+/* @brief: Sets one uniform of the bound program from a raw payload of GetPayloadSize(type) bytes
+*/
+void UniformBlob::SetUniform(int location, Type type, const void* payload)
+{
+    //The payload isn't guaranteed to be aligned, it usually points inside a byte stream
+    float values[16];
+    memcpy(values, payload, GetPayloadSize(type));
+
+    switch (type)
+    {
+        case Type::Int:
+        {
+            int value;
+            memcpy(&value, values, sizeof(int));
+            GLCall(glUniform1i(location, value));
+            break;
+        }
+        case Type::Float: GLCall(glUniform1f(location, values[0])); break;
+        case Type::Vec4:  GLCall(glUniform4fv(location, 1, values)); break;
+        case Type::Mat4:  GLCall(glUniformMatrix4fv(location, 1, GL_FALSE, values)); break;
+    }
+}
+
+/* @brief: Issues the glUniform* calls of every record, the program they belong to has to be bound already
+*/
+void UniformBlob::Apply(const unsigned char* data, unsigned int size)
+{
+    unsigned int offset = 0;
+    while (offset < size)
+    {
+        UniformHeader header;
+        memcpy(&header, data + offset, sizeof(UniformHeader));
+        offset += sizeof(UniformHeader);
+
+        SetUniform(header.Location, header.Type, data + offset);
+        offset += GetPayloadSize(header.Type);
+    }
+}
+
+uint64_t DrawQueue::MakeSortKey(unsigned int layer, unsigned int program, unsigned int texture, float depth)
+{
+    if (depth < 0.0f) depth = 0.0f;
+    if (depth > 1.0f) depth = 1.0f;
+    uint64_t depthBits = (uint64_t)(depth * 0xFFFFFF);
+
+    return ((uint64_t)(layer & 0xFF) << 56)
+        | ((uint64_t)(program & 0xFFFF) << 40)
+        | ((uint64_t)(texture & 0xFFFF) << 24)
+        | depthBits;
+}
+
+void DrawQueue::Submit(const DrawItem& item, const UniformBlob* uniforms)
+{
+    m_Items.push_back(item);
+    DrawItem& stored = m_Items.back();
+    stored.UniformOffset = (unsigned int)m_Uniforms.size();
+    stored.UniformSize = 0;
+
+    if (uniforms && uniforms->GetSize() > 0)
+    {
+        stored.UniformSize = uniforms->GetSize();
+        m_Uniforms.insert(m_Uniforms.end(), uniforms->GetData(), uniforms->GetData() + uniforms->GetSize());
+    }
+}
+
+/* @brief: LSD radix sort of the keys, one byte per pass. It's stable, so items with equal keys keep their submission
+           order, and passes where every key has the same byte (typically the layer) are skipped.
+*/
+void DrawQueue::Sort()
+{
+    unsigned int count = (unsigned int)m_Items.size();
+    m_SortEntries.resize(count);
+    m_SortScratch.resize(count);
+
+    //The histograms of all 8 bytes are built in a single pass over the keys
+    unsigned int histograms[8][256] = {};
+    for (unsigned int i = 0; i < count; i++)
+    {
+        uint64_t key = m_Items[i].SortKey;
+        m_SortEntries[i] = { key, i };
+        for (unsigned int pass = 0; pass < 8; pass++)
+            histograms[pass][(key >> (pass * 8)) & 0xFF]++;
+    }
+
+    for (unsigned int pass = 0; pass < 8; pass++)
+    {
+        unsigned int shift = pass * 8;
+        const unsigned int* histogram = histograms[pass];
+        if (count == 0 || histogram[(m_SortEntries[0].Key >> shift) & 0xFF] == count)
+            continue;
+
+        unsigned int offsets[256];
+        unsigned int sum = 0;
+        for (unsigned int b = 0; b < 256; b++)
+        {
+            offsets[b] = sum;
+            sum += histogram[b];
+        }
+
+        for (unsigned int i = 0; i < count; i++)
+        {
+            const SortEntry& entry = m_SortEntries[i];
+            m_SortScratch[offsets[(entry.Key >> shift) & 0xFF]++] = entry;
+        }
+        m_SortEntries.swap(m_SortScratch);
+    }
+}
+
+void DrawQueue::Execute() const
+{
+    GLStateCache& state = GLStateCache::Get();
+    for (const SortEntry& entry : m_SortEntries)
+    {
+        const DrawItem& item = m_Items[entry.Index];
+        //No program, e.g. one that wasn't ready when the item was made
+        if (item.Program == 0)
+            continue;
+
+        state.UseProgram(item.Program);
+        state.BindVertexArray(item.VertexArray);
+        state.BindElementBuffer(item.IndexBuffer);
+        for (unsigned int unit = 0; unit < DrawItem::MaxTextures; unit++)
+        {
+            if (item.Textures[unit])
+                state.BindTexture(unit, item.Textures[unit]);
+        }
+
+        if (item.UniformSize > 0)
+            UniformBlob::Apply(&m_Uniforms[item.UniformOffset], item.UniformSize);
+
+        GLCall(glDrawElements(GL_TRIANGLES, item.IndexCount, item.IndexType, nullptr));
+    }
+}
+
+void DrawQueue::Clear()
+{
+    m_Items.clear();
+    m_Uniforms.clear();
+    m_SortEntries.clear();
+}
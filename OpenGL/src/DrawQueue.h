@@ -0,0 +1,80 @@
+#pragma once
+#include <cstdint>
+#include <vector>
+
+#include "glm/glm.hpp"
+
+/* Uniform values recorded for a deferred draw. Locations are resolved by the caller (Shader::GetUniformLocation)
+   and the values are packed back to back as [location, type, payload] records. */
+class UniformBlob {
+public:
+	enum class Type : int { Int, Float, Vec4, Mat4 };
+
+private:
+	std::vector<unsigned char> m_Data;
+
+	void Push(int location, Type type, const void* data, unsigned int size);
+
+public:
+	void SetUniform1i(int location, int value);
+	void SetUniform1f(int location, float value);
+	void SetUniform4f(int location, float v0, float v1, float v2, float v3);
+	void SetUniformMat4f(int location, const glm::mat4& matrix);
+
+	inline void Clear() { m_Data.clear(); }
+	inline const unsigned char* GetData() const { return m_Data.data(); }
+	inline unsigned int GetSize() const { return (unsigned int)m_Data.size(); }
+
+	static unsigned int GetPayloadSize(Type type);
+	static void SetUniform(int location, Type type, const void* payload);
+	static void Apply(const unsigned char* data, unsigned int size);
+};
+
+struct DrawItem {
+	static const unsigned int MaxTextures = 4;
+
+	uint64_t SortKey;
+	//A linked program (see Shader::IsReady), an item with program 0 is skipped
+	unsigned int Program;
+	unsigned int VertexArray;
+	unsigned int IndexBuffer;
+	unsigned int IndexCount;
+	//GL_UNSIGNED_INT, GL_UNSIGNED_SHORT or GL_UNSIGNED_BYTE, see IndexBuffer::GetType
+	unsigned int IndexType;
+	//Textures[i] is bound to unit i, 0 leaves the unit alone
+	unsigned int Textures[MaxTextures];
+	unsigned int UniformOffset;
+	unsigned int UniformSize;
+};
+
+/* Deferred draws. Items are recorded with a 64 bit sort key and executed in key order on Flush, so draws sharing
+   a program and textures end up next to each other whatever order they were submitted in.
+
+   Sort key layout, most significant bits first:
+     layer   8 bits
+     program 16 bits
+     texture 16 bits (the texture on unit 0)
+     depth   24 bits (front to back) */
+class DrawQueue {
+private:
+	struct SortEntry {
+		uint64_t Key;
+		unsigned int Index;
+	};
+
+	std::vector<DrawItem> m_Items;
+	std::vector<unsigned char> m_Uniforms;
+	std::vector<SortEntry> m_SortEntries;
+	std::vector<SortEntry> m_SortScratch;
+
+public:
+	static uint64_t MakeSortKey(unsigned int layer, unsigned int program, unsigned int texture, float depth);
+
+	void Submit(const DrawItem& item, const UniformBlob* uniforms = nullptr);
+	void Sort();
+	void Execute() const;
+	void Clear();
+
+	inline unsigned int GetSize() const { return (unsigned int)m_Items.size(); }
+	inline const DrawItem& GetSortedItem(unsigned int i) const { return m_Items[m_SortEntries[i].Index]; }
+};
@@ -0,0 +1,91 @@
+#include "Framebuffer.h"
+#include "Renderer.h"
+
+Framebuffer::Framebuffer(int width, int height)
+    : m_RendererID(0), m_ColorAttachment(0), m_DepthAttachment(0), m_Width(width), m_Height(height)
+{
+    GLCall(glGenFramebuffers(1, &m_RendererID));
+    GLCall(glBindFramebuffer(GL_FRAMEBUFFER, m_RendererID));
+
+    GLCall(glGenRenderbuffers(1, &m_ColorAttachment));
+    GLCall(glBindRenderbuffer(GL_RENDERBUFFER, m_ColorAttachment));
+    GLCall(glRenderbufferStorage(GL_RENDERBUFFER, GL_RGBA8, width, height));
+    GLCall(glFramebufferRenderbuffer(GL_FRAMEBUFFER, GL_COLOR_ATTACHMENT0, GL_RENDERBUFFER, m_ColorAttachment));
+
+    GLCall(glGenRenderbuffers(1, &m_DepthAttachment));
+    GLCall(glBindRenderbuffer(GL_RENDERBUFFER, m_DepthAttachment));
+    GLCall(glRenderbufferStorage(GL_RENDERBUFFER, GL_DEPTH24_STENCIL8, width, height));
+    GLCall(glFramebufferRenderbuffer(GL_FRAMEBUFFER, GL_DEPTH_STENCIL_ATTACHMENT, GL_RENDERBUFFER, m_DepthAttachment));
+
+    GLCall(glBindRenderbuffer(GL_RENDERBUFFER, 0));
+    GLCall(glBindFramebuffer(GL_FRAMEBUFFER, 0));
+}
+
+Framebuffer::~Framebuffer()
+{
+    Destroy();
+}
+
+Framebuffer::Framebuffer(Framebuffer&& other) noexcept
+    : m_RendererID(other.m_RendererID), m_ColorAttachment(other.m_ColorAttachment), m_DepthAttachment(other.m_DepthAttachment),
+      m_Width(other.m_Width), m_Height(other.m_Height)
+{
+    other.m_RendererID = 0;
+    other.m_ColorAttachment = 0;
+    other.m_DepthAttachment = 0;
+}
+
+Framebuffer& Framebuffer::operator=(Framebuffer&& other) noexcept
+{
+    if (this != &other)
+    {
+        Destroy();
+        m_RendererID = other.m_RendererID;
+        m_ColorAttachment = other.m_ColorAttachment;
+        m_DepthAttachment = other.m_DepthAttachment;
+        m_Width = other.m_Width;
+        m_Height = other.m_Height;
+        other.m_RendererID = 0;
+        other.m_ColorAttachment = 0;
+        other.m_DepthAttachment = 0;
+    }
+    return *this;
+}
+
+void Framebuffer::Destroy()
+{
+    if (m_RendererID == 0)
+        return;
+    GLCall(glDeleteFramebuffers(1, &m_RendererID));
+    GLCall(glDeleteRenderbuffers(1, &m_ColorAttachment));
+    GLCall(glDeleteRenderbuffers(1, &m_DepthAttachment));
+    m_RendererID = 0;
+    m_ColorAttachment = 0;
+    m_DepthAttachment = 0;
+}
+
+void Framebuffer::Bind() const
+{
+    GLCall(glBindFramebuffer(GL_FRAMEBUFFER, m_RendererID));
+    GLCall(glViewport(0, 0, m_Width, m_Height));
+}
+
+void Framebuffer::Unbind() const
+{
+    GLCall(glBindFramebuffer(GL_FRAMEBUFFER, 0));
+}
+
+bool Framebuffer::IsComplete() const
+{
+    Bind();
+    GLCall(GLenum status = glCheckFramebufferStatus(GL_FRAMEBUFFER));
+    return status == GL_FRAMEBUFFER_COMPLETE;
+}
+
+/* @brief: Reads back the color attachment as RGBA8, data must hold width * height * 4 bytes
+*/
+void Framebuffer::ReadPixels(void* data) const
+{
+    GLCall(glBindFramebuffer(GL_READ_FRAMEBUFFER, m_RendererID));
+    GLCall(glReadPixels(0, 0, m_Width, m_Height, GL_RGBA, GL_UNSIGNED_BYTE, data));
+}
@@ -0,0 +1,32 @@
+#pragma once
+
+/* Offscreen render target, a color renderbuffer with a depth/stencil renderbuffer.
+   Used by the headless mode where there is no default framebuffer to draw into. */
+class Framebuffer {
+private:
+	unsigned int m_RendererID;
+	unsigned int m_ColorAttachment;
+	unsigned int m_DepthAttachment;
+	int m_Width;
+	int m_Height;
+
+	void Destroy();
+
+public:
+	Framebuffer(int width, int height);
+	~Framebuffer();
+	Framebuffer(const Framebuffer&) = delete;
+	Framebuffer& operator=(const Framebuffer&) = delete;
+	Framebuffer(Framebuffer&& other) noexcept;
+	Framebuffer& operator=(Framebuffer&& other) noexcept;
+
+	void Bind() const;
+	void Unbind() const;
+
+	bool IsComplete() const;
+	void ReadPixels(void* data) const;
+
+	inline int GetWidth() const { return m_Width; }
+	inline int GetHeight() const { return m_Height; }
+	inline unsigned int GetRendererID() const { return m_RendererID; }
+};
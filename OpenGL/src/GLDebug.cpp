@@ -0,0 +1,99 @@
+#include "GLDebug.h"
+#include "Renderer.h"
+
+#include <iostream>
+
+thread_local GLCallSite t_GLCallSite = { nullptr, nullptr, 0 };
+bool g_GLDebugOutputActive = false;
+
+static bool s_Synchronous = true;
+
+static const char* GetSeverityName(GLenum severity)
+{
+    switch (severity)
+    {
+        case GL_DEBUG_SEVERITY_HIGH:         return "high";
+        case GL_DEBUG_SEVERITY_MEDIUM:       return "medium";
+        case GL_DEBUG_SEVERITY_LOW:          return "low";
+        case GL_DEBUG_SEVERITY_NOTIFICATION: return "notification";
+    }
+    return "unknown";
+}
+
+static const char* GetTypeName(GLenum type)
+{
+    switch (type)
+    {
+        case GL_DEBUG_TYPE_ERROR:               return "error";
+        case GL_DEBUG_TYPE_DEPRECATED_BEHAVIOR: return "deprecated";
+        case GL_DEBUG_TYPE_UNDEFINED_BEHAVIOR:  return "undefined behavior";
+        case GL_DEBUG_TYPE_PORTABILITY:         return "portability";
+        case GL_DEBUG_TYPE_PERFORMANCE:         return "performance";
+        case GL_DEBUG_TYPE_MARKER:              return "marker";
+    }
+    return "other";
+}
+
+static void GLAPIENTRY GLDebugCallback(GLenum source, GLenum type, GLuint id, GLenum severity, GLsizei length,
+    const GLchar* message, const void* userParam)
+{
+    //The message is null terminated and no user pointer is registered
+    (void)source;
+    (void)length;
+    (void)userParam;
+    std::cout << "[OpenGl Debug] (" << GetTypeName(type) << ", " << GetSeverityName(severity) << ", " << id << ") "
+        << message << std::endl;
+
+    if (!s_Synchronous)
+        return;
+
+    const GLCallSite& site = t_GLCallSite;
+    if (site.Function)
+        std::cout << "    at " << site.Function << " " << site.File << ": " << site.Line << std::endl;
+
+#ifdef OGL_DEBUG
+    if (type == GL_DEBUG_TYPE_ERROR)
+        ASSERT(false);
+#endif
+}
+
+bool GLEnableDebugOutput(GLDebugSeverity minSeverity, bool synchronous)
+{
+    if (!GLEW_VERSION_4_3 && !GLEW_KHR_debug)
+        return false;
+
+    //Without a debug context the driver is free to never report anything
+    GLint flags = 0;
+    glGetIntegerv(GL_CONTEXT_FLAGS, &flags);
+    if (!(flags & GL_CONTEXT_FLAG_DEBUG_BIT))
+        return false;
+
+    s_Synchronous = synchronous;
+    glEnable(GL_DEBUG_OUTPUT);
+    if (synchronous)
+        glEnable(GL_DEBUG_OUTPUT_SYNCHRONOUS);
+    else
+        glDisable(GL_DEBUG_OUTPUT_SYNCHRONOUS);
+    glDebugMessageCallback(GLDebugCallback, nullptr);
+
+    //Everything off, then back on from the minimum severity up
+    const GLenum severities[] = { GL_DEBUG_SEVERITY_NOTIFICATION, GL_DEBUG_SEVERITY_LOW, GL_DEBUG_SEVERITY_MEDIUM, GL_DEBUG_SEVERITY_HIGH };
+    glDebugMessageControl(GL_DONT_CARE, GL_DONT_CARE, GL_DONT_CARE, 0, nullptr, GL_FALSE);
+    for (int i = (int)minSeverity; i < 4; i++)
+        glDebugMessageControl(GL_DONT_CARE, GL_DONT_CARE, severities[i], 0, nullptr, GL_TRUE);
+
+    //Errors raised before this point would otherwise be picked up by the next glGetError check
+    GLClearError();
+    g_GLDebugOutputActive = true;
+    return true;
+}
+
+void GLDisableDebugOutput()
+{
+    if (!g_GLDebugOutputActive)
+        return;
+
+    glDebugMessageCallback(nullptr, nullptr);
+    glDisable(GL_DEBUG_OUTPUT);
+    g_GLDebugOutputActive = false;
+}
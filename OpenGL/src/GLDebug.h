@@ -0,0 +1,33 @@
+#pragma once
+
+/* Error reporting through KHR_debug (glDebugMessageCallback) instead of a glGetError loop after every call.
+   GLCall only leaves a breadcrumb of the call site in a thread local, the driver reports errors by itself and the
+   callback prints the breadcrumb along with the message. When debug output can't be enabled (no KHR_debug or no
+   debug context), GLCall keeps checking glGetError after each call. */
+
+struct GLCallSite {
+	const char* Function;
+	const char* File;
+	int Line;
+};
+
+enum class GLDebugSeverity { Notification, Low, Medium, High };
+
+extern thread_local GLCallSite t_GLCallSite;
+extern bool g_GLDebugOutputActive;
+
+inline void GLSetCallSite(const char* function, const char* file, int line)
+{
+	t_GLCallSite.Function = function;
+	t_GLCallSite.File = file;
+	t_GLCallSite.Line = line;
+}
+
+inline bool GLDebugOutputActive() { return g_GLDebugOutputActive; }
+
+/* @brief: Messages below minSeverity are filtered out by the driver. With synchronous output the callback runs inside
+           the failing call, so the breadcrumb is exactly that call. Asynchronous output is cheaper but the callback
+           can run later on a driver thread, messages are then printed without a call site.
+*/
+bool GLEnableDebugOutput(GLDebugSeverity minSeverity = GLDebugSeverity::Low, bool synchronous = true);
+void GLDisableDebugOutput();
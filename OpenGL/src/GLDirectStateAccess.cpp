@@ -0,0 +1,13 @@
+#include "GLDirectStateAccess.h"
+#include "Renderer.h"
+
+bool g_GLDirectStateAccessActive = false;
+
+bool GLSelectDirectStateAccess(bool allowed)
+{
+#ifdef OGL_TRACE
+    allowed = false;
+#endif
+    g_GLDirectStateAccessActive = allowed && (GLEW_VERSION_4_5 || GLEW_ARB_direct_state_access);
+    return g_GLDirectStateAccessActive;
+}
@@ -0,0 +1,15 @@
+#pragma once
+
+/* Direct state access (GL 4.5 or ARB_direct_state_access) edits buffers, vertex arrays and textures by name, without
+   binding them first. VertexBuffer, IndexBuffer, VertexArray and Texture take that path when it's selected, the bind
+   to edit path stays for older contexts. Objects have to be created by the path that edits them: a glGen* name is
+   not an object until it's first bound, so DSA calls on it fail. Select once, before creating any of them. */
+
+extern bool g_GLDirectStateAccessActive;
+
+inline bool GLDirectStateAccessActive() { return g_GLDirectStateAccessActive; }
+
+/* @brief: Turns DSA on when allowed and supported by the context, returns whether it is. Trace builds stay on the bind
+           path, GLTrace only records the entry points it replays.
+*/
+bool GLSelectDirectStateAccess(bool allowed = true);
@@ -0,0 +1,21 @@
+#include "GLFence.h"
+#include "Renderer.h"
+
+#include <chrono>
+
+double WaitForFence(GLsync fence)
+{
+    double stallMs = 0.0;
+    GLCall(GLenum status = glClientWaitSync(fence, 0, 0));
+    if (status == GL_TIMEOUT_EXPIRED)
+    {
+        auto start = std::chrono::high_resolution_clock::now();
+        do
+        {
+            GLCall(status = glClientWaitSync(fence, GL_SYNC_FLUSH_COMMANDS_BIT, 1000000));
+        } while (status == GL_TIMEOUT_EXPIRED);
+        stallMs = std::chrono::duration<double, std::milli>(std::chrono::high_resolution_clock::now() - start).count();
+    }
+    GLCall(glDeleteSync(fence));
+    return stallMs;
+}
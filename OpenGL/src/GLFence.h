@@ -0,0 +1,7 @@
+#pragma once
+#include <GL/glew.h>
+
+/* @brief: Waits until the GPU signals fence, then deletes it. Polls once without flushing, and only when the fence
+           isn't signaled yet flushes and waits. Returns the stall in ms, 0 when it was already signaled.
+*/
+double WaitForFence(GLsync fence);
@@ -0,0 +1,211 @@
+#include "GLStateCache.h"
+#include "Renderer.h"
+
+GLStateCache::GLStateCache()
+    : m_IssuedCalls(0), m_SkippedCalls(0)
+{
+    Invalidate();
+}
+
+GLStateCache& GLStateCache::Get()
+{
+    static GLStateCache instance;
+    return instance;
+}
+
+/* @brief: Forgets everything, the next bind of each kind always reaches GL. Call it after touching bindings without the cache
+*/
+void GLStateCache::Invalidate()
+{
+    m_Program = Unknown;
+    m_VertexArray = Unknown;
+    m_ArrayBuffer = Unknown;
+    m_ElementBuffer = Unknown;
+    m_ActiveTextureUnit = Unknown;
+    for (unsigned int i = 0; i < MaxTextureUnits; i++)
+        m_Textures[i] = Unknown;
+    for (unsigned int i = 0; i < MaxUniformBindings; i++)
+        m_UniformBuffers[i] = { Unknown, 0, 0 };
+    m_VaoElementBuffers.clear();
+    m_VaoVertexBuffers.clear();
+}
+
+void GLStateCache::UseProgram(unsigned int program)
+{
+    if (m_Program == program)
+    {
+        m_SkippedCalls++;
+        return;
+    }
+    GLCall(glUseProgram(program));
+    m_Program = program;
+    m_IssuedCalls++;
+}
+
+void GLStateCache::BindVertexArray(unsigned int vertexArray)
+{
+    if (m_VertexArray == vertexArray)
+    {
+        m_SkippedCalls++;
+        return;
+    }
+    GLCall(glBindVertexArray(vertexArray));
+    m_VertexArray = vertexArray;
+    m_IssuedCalls++;
+
+    //Switching VAO also switches the element buffer to the one stored in it
+    auto it = m_VaoElementBuffers.find(vertexArray);
+    m_ElementBuffer = it != m_VaoElementBuffers.end() ? it->second : Unknown;
+}
+
+void GLStateCache::BindArrayBuffer(unsigned int buffer)
+{
+    if (m_ArrayBuffer == buffer)
+    {
+        m_SkippedCalls++;
+        return;
+    }
+    GLCall(glBindBuffer(GL_ARRAY_BUFFER, buffer));
+    m_ArrayBuffer = buffer;
+    m_IssuedCalls++;
+}
+
+void GLStateCache::BindElementBuffer(unsigned int buffer)
+{
+    if (m_ElementBuffer == buffer)
+    {
+        m_SkippedCalls++;
+        return;
+    }
+    GLCall(glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, buffer));
+    m_ElementBuffer = buffer;
+    m_IssuedCalls++;
+
+    if (m_VertexArray != Unknown)
+        m_VaoElementBuffers[m_VertexArray] = buffer;
+}
+
+void GLStateCache::BindVertexBuffer(unsigned int buffer, unsigned int stride)
+{
+    ASSERT(m_VertexArray != Unknown && m_VertexArray != 0);
+    VertexBufferBinding& binding = m_VaoVertexBuffers.emplace(m_VertexArray, VertexBufferBinding{ Unknown, 0 }).first->second;
+    if (binding.Buffer == buffer && binding.Stride == stride)
+    {
+        m_SkippedCalls++;
+        return;
+    }
+    GLCall(glBindVertexBuffer(0, buffer, 0, stride));
+    binding.Buffer = buffer;
+    binding.Stride = stride;
+    m_IssuedCalls++;
+}
+
+void GLStateCache::ActiveTexture(unsigned int unit)
+{
+    if (m_ActiveTextureUnit == unit)
+    {
+        m_SkippedCalls++;
+        return;
+    }
+    GLCall(glActiveTexture(GL_TEXTURE0 + unit));
+    m_ActiveTextureUnit = unit;
+    m_IssuedCalls++;
+}
+
+void GLStateCache::BindTexture(unsigned int unit, unsigned int texture)
+{
+    ASSERT(unit < MaxTextureUnits);
+    if (m_Textures[unit] == texture)
+    {
+        m_SkippedCalls++;
+        return;
+    }
+    ActiveTexture(unit);
+    GLCall(glBindTexture(GL_TEXTURE_2D, texture));
+    m_Textures[unit] = texture;
+    m_IssuedCalls++;
+}
+
+/* @brief: Binds on whatever unit is currently active, used when a texture is only bound to be edited
+*/
+void GLStateCache::BindTexture(unsigned int texture)
+{
+    if (m_ActiveTextureUnit == Unknown)
+        ActiveTexture(0);
+    BindTexture(m_ActiveTextureUnit, texture);
+}
+
+/* @brief: Also changes the generic GL_UNIFORM_BUFFER binding, which isn't tracked: nothing else binds to it
+*/
+void GLStateCache::BindUniformBuffer(unsigned int binding, unsigned int buffer, unsigned int offset, unsigned int size)
+{
+    ASSERT(binding < MaxUniformBindings);
+    UniformBufferBinding& current = m_UniformBuffers[binding];
+    if (current.Buffer == buffer && current.Offset == offset && current.Size == size)
+    {
+        m_SkippedCalls++;
+        return;
+    }
+    if (size == 0)
+    {
+        GLCall(glBindBufferBase(GL_UNIFORM_BUFFER, binding, buffer));
+    }
+    else
+    {
+        GLCall(glBindBufferRange(GL_UNIFORM_BUFFER, binding, buffer, offset, size));
+    }
+    current = { buffer, offset, size };
+    m_IssuedCalls++;
+}
+
+/* GL ids get recycled once deleted, so a deleted object must not stay in the cache or a new object
+   reusing its id would be considered already bound. */
+void GLStateCache::OnProgramDeleted(unsigned int program)
+{
+    if (m_Program == program)
+        m_Program = Unknown;
+}
+
+void GLStateCache::OnVertexArrayDeleted(unsigned int vertexArray)
+{
+    m_VaoElementBuffers.erase(vertexArray);
+    m_VaoVertexBuffers.erase(vertexArray);
+    //Deleting the bound VAO reverts the binding to 0
+    if (m_VertexArray == vertexArray)
+    {
+        m_VertexArray = 0;
+        m_ElementBuffer = Unknown;
+    }
+}
+
+void GLStateCache::OnBufferDeleted(unsigned int buffer)
+{
+    if (m_ArrayBuffer == buffer)
+        m_ArrayBuffer = 0;
+    if (m_ElementBuffer == buffer)
+        m_ElementBuffer = Unknown;
+    for (unsigned int i = 0; i < MaxUniformBindings; i++)
+    {
+        if (m_UniformBuffers[i].Buffer == buffer)
+            m_UniformBuffers[i].Buffer = Unknown;
+    }
+    for (auto& vaoElementBuffer : m_VaoElementBuffers)
+    {
+        if (vaoElementBuffer.second == buffer)
+            vaoElementBuffer.second = Unknown;
+    }
+    for (auto& vaoVertexBuffer : m_VaoVertexBuffers)
+    {
+        if (vaoVertexBuffer.second.Buffer == buffer)
+            vaoVertexBuffer.second.Buffer = Unknown;
+    }
+}
+
+void GLStateCache::OnTextureDeleted(unsigned int texture)
+{
+    for (unsigned int i = 0; i < MaxTextureUnits; i++)
+    {
+        if (m_Textures[i] == texture)
+            m_Textures[i] = 0;
+    }
+}
@@ -0,0 +1,72 @@
+#pragma once
+#include <unordered_map>
+
+/* Shadow copy of the GL bindings the renderer touches. Every Bind()/Unbind() of Shader, VertexArray, VertexBuffer,
+   IndexBuffer and Texture goes through it so a bind that wouldn't change anything never reaches the driver.
+   There is a single instance since the application only ever has one GL context. */
+class GLStateCache {
+public:
+	static const unsigned int MaxTextureUnits = 32;
+	//GL_MAX_UNIFORM_BUFFER_BINDINGS is at least 36
+	static const unsigned int MaxUniformBindings = 36;
+
+private:
+	//Used for bindings we can't know anymore, e.g. after the object currently bound got deleted
+	static const unsigned int Unknown = 0xFFFFFFFF;
+
+	unsigned int m_Program;
+	unsigned int m_VertexArray;
+	unsigned int m_ArrayBuffer;
+	unsigned int m_ElementBuffer;
+	unsigned int m_ActiveTextureUnit;
+	unsigned int m_Textures[MaxTextureUnits];
+
+	struct VertexBufferBinding {
+		unsigned int Buffer;
+		unsigned int Stride;
+	};
+
+	//Buffer range on each indexed GL_UNIFORM_BUFFER binding point, size 0 for the whole buffer
+	struct UniformBufferBinding {
+		unsigned int Buffer;
+		unsigned int Offset;
+		unsigned int Size;
+	};
+	UniformBufferBinding m_UniformBuffers[MaxUniformBindings];
+
+	//The element buffer binding is part of the VAO state, so we remember it for each VAO we've seen
+	std::unordered_map<unsigned int, unsigned int> m_VaoElementBuffers;
+	//Same for the buffer on vertex binding point 0, see BindVertexBuffer
+	std::unordered_map<unsigned int, VertexBufferBinding> m_VaoVertexBuffers;
+
+	unsigned int m_IssuedCalls;
+	unsigned int m_SkippedCalls;
+
+	GLStateCache();
+
+public:
+	static GLStateCache& Get();
+
+	void UseProgram(unsigned int program);
+	void BindVertexArray(unsigned int vertexArray);
+	void BindArrayBuffer(unsigned int buffer);
+	void BindElementBuffer(unsigned int buffer);
+	//glBindVertexBuffer on binding point 0 of the bound VAO (ARB_vertex_attrib_binding), used by VertexFormatCache
+	void BindVertexBuffer(unsigned int buffer, unsigned int stride);
+	void ActiveTexture(unsigned int unit);
+	void BindTexture(unsigned int unit, unsigned int texture);
+	void BindTexture(unsigned int texture);
+	//glBindBufferRange on a uniform block binding point, or glBindBufferBase when size is 0
+	void BindUniformBuffer(unsigned int binding, unsigned int buffer, unsigned int offset = 0, unsigned int size = 0);
+
+	void OnProgramDeleted(unsigned int program);
+	void OnVertexArrayDeleted(unsigned int vertexArray);
+	void OnBufferDeleted(unsigned int buffer);
+	void OnTextureDeleted(unsigned int texture);
+
+	void Invalidate();
+
+	inline unsigned int GetIssuedCalls() const { return m_IssuedCalls; }
+	inline unsigned int GetSkippedCalls() const { return m_SkippedCalls; }
+	inline void ResetCounters() { m_IssuedCalls = 0; m_SkippedCalls = 0; }
+};
@@ -0,0 +1,553 @@
+#define OGL_TRACE_IMPL
+#include "GLTrace.h"
+
+#include <chrono>
+#include <cstring>
+#include <fstream>
+#include <vector>
+
+#define GL_TRACE_NAME(name) "gl" #name,
+static const char* s_CallNames[] = { GL_TRACE_CALLS(GL_TRACE_NAME) };
+#undef GL_TRACE_NAME
+
+const char* GetGLTraceCallName(GLTraceCall call)
+{
+    return call < GLTraceCall::Count ? s_CallNames[(int)call] : "unknown";
+}
+
+typedef std::chrono::steady_clock TraceClock;
+
+static bool s_Recording = false;
+static std::ofstream s_File;
+static std::vector<unsigned char> s_Buffer;
+static TraceClock::time_point s_Start;
+
+//Records are written to disk in chunks so tracing doesn't add a file write per call
+static const size_t FlushThreshold = 4 * 1024 * 1024;
+
+/* Appends one call to the trace. The constructor takes the timestamp before the call is forwarded to GL, the
+   wrappers stream the arguments only once GL returned: the first of them ends the call, so copying the arguments and
+   payloads isn't part of its duration. The destructor writes the record. */
+class TraceRecord {
+private:
+    GLTraceCall m_Call;
+    TraceClock::time_point m_CallStart;
+    TraceClock::time_point m_CallEnd;
+    bool m_Ended;
+    std::vector<unsigned char> m_Args;
+    bool m_Active;
+
+public:
+    TraceRecord(GLTraceCall call)
+        : m_Call(call), m_Ended(false), m_Active(s_Recording)
+    {
+        if (m_Active)
+            m_CallStart = TraceClock::now();
+    }
+
+    ~TraceRecord()
+    {
+        if (!m_Active)
+            return;
+
+        EndCall();
+        unsigned long long timestamp = std::chrono::duration_cast<std::chrono::nanoseconds>(m_CallStart - s_Start).count();
+        unsigned int duration = (unsigned int)std::chrono::duration_cast<std::chrono::nanoseconds>(m_CallEnd - m_CallStart).count();
+        unsigned short call = (unsigned short)m_Call;
+        unsigned int argsSize = (unsigned int)m_Args.size();
+
+        Append(&call, sizeof(call));
+        Append(&argsSize, sizeof(argsSize));
+        Append(&timestamp, sizeof(timestamp));
+        Append(&duration, sizeof(duration));
+        if (argsSize)
+            Append(m_Args.data(), argsSize);
+
+        if (s_Buffer.size() > FlushThreshold)
+        {
+            s_File.write((const char*)s_Buffer.data(), s_Buffer.size());
+            s_Buffer.clear();
+        }
+    }
+
+    static void Append(const void* data, size_t size)
+    {
+        const unsigned char* bytes = (const unsigned char*)data;
+        s_Buffer.insert(s_Buffer.end(), bytes, bytes + size);
+    }
+
+    template<typename T>
+    TraceRecord& operator<<(const T& value)
+    {
+        Bytes(&value, sizeof(T));
+        return *this;
+    }
+
+    //Payload: size (u32) followed by the bytes, a null pointer is written as an empty payload
+    TraceRecord& Payload(const void* data, size_t size)
+    {
+        unsigned int payloadSize = data ? (unsigned int)size : 0;
+        Bytes(&payloadSize, sizeof(payloadSize));
+        if (payloadSize)
+            Bytes(data, payloadSize);
+        return *this;
+    }
+
+    void EndCall()
+    {
+        if (m_Ended)
+            return;
+        m_CallEnd = TraceClock::now();
+        m_Ended = true;
+    }
+
+    void Bytes(const void* data, size_t size)
+    {
+        if (!m_Active)
+            return;
+        EndCall();
+        const unsigned char* bytes = (const unsigned char*)data;
+        m_Args.insert(m_Args.end(), bytes, bytes + size);
+    }
+
+    inline bool IsActive() const { return m_Active; }
+};
+
+bool GLTrace::Begin(const std::string& path)
+{
+    End();
+    s_File.open(path, std::ios::binary | std::ios::trunc);
+    if (!s_File)
+        return false;
+
+    s_File.write("GLTR", 4);
+    s_File.write((const char*)&GLTraceVersion, sizeof(GLTraceVersion));
+    s_Buffer.reserve(FlushThreshold * 2);
+    s_Start = TraceClock::now();
+    s_Recording = true;
+    return true;
+}
+
+void GLTrace::End()
+{
+    if (!s_Recording)
+        return;
+
+    s_File.write((const char*)s_Buffer.data(), s_Buffer.size());
+    s_File.close();
+    s_Buffer.clear();
+    s_Recording = false;
+}
+
+bool GLTrace::IsRecording()
+{
+    return s_Recording;
+}
+
+//Pointers into buffers (attribute offsets, index offsets...) are traced as 64 bit offsets
+static unsigned long long ToOffset(const void* pointer)
+{
+    return (unsigned long long)(size_t)pointer;
+}
+
+//Bytes read by glTexImage2D from client memory, for the formats the renderer uses (rows are 4 byte aligned by default)
+static size_t GetImageSize(GLsizei width, GLsizei height, GLenum format, GLenum type)
+{
+    size_t components = 4;
+    switch (format)
+    {
+        case GL_RED:  components = 1; break;
+        case GL_RG:   components = 2; break;
+        case GL_RGB:  components = 3; break;
+        case GL_RGBA: components = 4; break;
+    }
+    size_t componentSize = (type == GL_FLOAT) ? 4 : (type == GL_UNSIGNED_SHORT || type == GL_HALF_FLOAT) ? 2 : 1;
+    size_t rowSize = (width * components * componentSize + 3) & ~(size_t)3;
+    return rowSize * height;
+}
+
+void GLTrace::GenBuffers(GLsizei n, GLuint* buffers)
+{
+    TraceRecord record(GLTraceCall::GenBuffers);
+    glGenBuffers(n, buffers);
+    record << n;
+    record.Bytes(buffers, n * sizeof(GLuint));
+}
+
+void GLTrace::DeleteBuffers(GLsizei n, const GLuint* buffers)
+{
+    TraceRecord record(GLTraceCall::DeleteBuffers);
+    glDeleteBuffers(n, buffers);
+    record << n;
+    record.Bytes(buffers, n * sizeof(GLuint));
+}
+
+void GLTrace::BindBuffer(GLenum target, GLuint buffer)
+{
+    TraceRecord record(GLTraceCall::BindBuffer);
+    glBindBuffer(target, buffer);
+    record << target << buffer;
+}
+
+void GLTrace::BufferData(GLenum target, GLsizeiptr size, const void* data, GLenum usage)
+{
+    TraceRecord record(GLTraceCall::BufferData);
+    glBufferData(target, size, data, usage);
+    record << target << (unsigned long long)size << usage;
+    record.Payload(data, size);
+}
+
+void GLTrace::BufferSubData(GLenum target, GLintptr offset, GLsizeiptr size, const void* data)
+{
+    TraceRecord record(GLTraceCall::BufferSubData);
+    glBufferSubData(target, offset, size, data);
+    record << target << (unsigned long long)offset;
+    record.Payload(data, size);
+}
+
+void GLTrace::GenVertexArrays(GLsizei n, GLuint* arrays)
+{
+    TraceRecord record(GLTraceCall::GenVertexArrays);
+    glGenVertexArrays(n, arrays);
+    record << n;
+    record.Bytes(arrays, n * sizeof(GLuint));
+}
+
+void GLTrace::DeleteVertexArrays(GLsizei n, const GLuint* arrays)
+{
+    TraceRecord record(GLTraceCall::DeleteVertexArrays);
+    glDeleteVertexArrays(n, arrays);
+    record << n;
+    record.Bytes(arrays, n * sizeof(GLuint));
+}
+
+void GLTrace::BindVertexArray(GLuint array)
+{
+    TraceRecord record(GLTraceCall::BindVertexArray);
+    glBindVertexArray(array);
+    record << array;
+}
+
+void GLTrace::EnableVertexAttribArray(GLuint index)
+{
+    TraceRecord record(GLTraceCall::EnableVertexAttribArray);
+    glEnableVertexAttribArray(index);
+    record << index;
+}
+
+void GLTrace::VertexAttribPointer(GLuint index, GLint size, GLenum type, GLboolean normalized, GLsizei stride, const void* pointer)
+{
+    TraceRecord record(GLTraceCall::VertexAttribPointer);
+    glVertexAttribPointer(index, size, type, normalized, stride, pointer);
+    record << index << size << type << normalized << stride << ToOffset(pointer);
+}
+
+void GLTrace::VertexAttribDivisor(GLuint index, GLuint divisor)
+{
+    TraceRecord record(GLTraceCall::VertexAttribDivisor);
+    glVertexAttribDivisor(index, divisor);
+    record << index << divisor;
+}
+
+void GLTrace::GenTextures(GLsizei n, GLuint* textures)
+{
+    TraceRecord record(GLTraceCall::GenTextures);
+    glGenTextures(n, textures);
+    record << n;
+    record.Bytes(textures, n * sizeof(GLuint));
+}
+
+void GLTrace::DeleteTextures(GLsizei n, const GLuint* textures)
+{
+    TraceRecord record(GLTraceCall::DeleteTextures);
+    glDeleteTextures(n, textures);
+    record << n;
+    record.Bytes(textures, n * sizeof(GLuint));
+}
+
+void GLTrace::BindTexture(GLenum target, GLuint texture)
+{
+    TraceRecord record(GLTraceCall::BindTexture);
+    glBindTexture(target, texture);
+    record << target << texture;
+}
+
+void GLTrace::ActiveTexture(GLenum texture)
+{
+    TraceRecord record(GLTraceCall::ActiveTexture);
+    glActiveTexture(texture);
+    record << texture;
+}
+
+void GLTrace::TexParameteri(GLenum target, GLenum pname, GLint param)
+{
+    TraceRecord record(GLTraceCall::TexParameteri);
+    glTexParameteri(target, pname, param);
+    record << target << pname << param;
+}
+
+void GLTrace::TexImage2D(GLenum target, GLint level, GLint internalformat, GLsizei width, GLsizei height, GLint border,
+    GLenum format, GLenum type, const void* pixels)
+{
+    TraceRecord record(GLTraceCall::TexImage2D);
+    glTexImage2D(target, level, internalformat, width, height, border, format, type, pixels);
+    record << target << level << internalformat << width << height << border << format << type;
+    record.Payload(pixels, GetImageSize(width, height, format, type));
+}
+
+GLuint GLTrace::CreateShader(GLenum type)
+{
+    TraceRecord record(GLTraceCall::CreateShader);
+    GLuint shader = glCreateShader(type);
+    record << type << shader;
+    return shader;
+}
+
+//The strings are traced concatenated, which is what the compiler sees anyway
+void GLTrace::ShaderSource(GLuint shader, GLsizei count, const GLchar* const* string, const GLint* length)
+{
+    TraceRecord record(GLTraceCall::ShaderSource);
+    glShaderSource(shader, count, string, length);
+    if (!record.IsActive())
+        return;
+
+    record.EndCall();
+    std::string source;
+    for (GLsizei i = 0; i < count; i++)
+    {
+        if (length && length[i] >= 0)
+            source.append(string[i], length[i]);
+        else
+            source.append(string[i]);
+    }
+    record << shader;
+    record.Payload(source.data(), source.size());
+}
+
+void GLTrace::CompileShader(GLuint shader)
+{
+    TraceRecord record(GLTraceCall::CompileShader);
+    glCompileShader(shader);
+    record << shader;
+}
+
+void GLTrace::DeleteShader(GLuint shader)
+{
+    TraceRecord record(GLTraceCall::DeleteShader);
+    glDeleteShader(shader);
+    record << shader;
+}
+
+GLuint GLTrace::CreateProgram()
+{
+    TraceRecord record(GLTraceCall::CreateProgram);
+    GLuint program = glCreateProgram();
+    record << program;
+    return program;
+}
+
+void GLTrace::AttachShader(GLuint program, GLuint shader)
+{
+    TraceRecord record(GLTraceCall::AttachShader);
+    glAttachShader(program, shader);
+    record << program << shader;
+}
+
+void GLTrace::LinkProgram(GLuint program)
+{
+    TraceRecord record(GLTraceCall::LinkProgram);
+    glLinkProgram(program);
+    record << program;
+}
+
+void GLTrace::ValidateProgram(GLuint program)
+{
+    TraceRecord record(GLTraceCall::ValidateProgram);
+    glValidateProgram(program);
+    record << program;
+}
+
+void GLTrace::UseProgram(GLuint program)
+{
+    TraceRecord record(GLTraceCall::UseProgram);
+    glUseProgram(program);
+    record << program;
+}
+
+void GLTrace::DeleteProgram(GLuint program)
+{
+    TraceRecord record(GLTraceCall::DeleteProgram);
+    glDeleteProgram(program);
+    record << program;
+}
+
+//The returned location is traced so the replay can map it to the location of its own program
+GLint GLTrace::GetUniformLocation(GLuint program, const GLchar* name)
+{
+    TraceRecord record(GLTraceCall::GetUniformLocation);
+    GLint location = glGetUniformLocation(program, name);
+    record << program << location;
+    record.Payload(name, strlen(name) + 1);
+    return location;
+}
+
+void GLTrace::Uniform1i(GLint location, GLint v0)
+{
+    TraceRecord record(GLTraceCall::Uniform1i);
+    glUniform1i(location, v0);
+    record << location << v0;
+}
+
+void GLTrace::Uniform1iv(GLint location, GLsizei count, const GLint* value)
+{
+    TraceRecord record(GLTraceCall::Uniform1iv);
+    glUniform1iv(location, count, value);
+    record << location << count;
+    record.Bytes(value, count * sizeof(GLint));
+}
+
+void GLTrace::Uniform1f(GLint location, GLfloat v0)
+{
+    TraceRecord record(GLTraceCall::Uniform1f);
+    glUniform1f(location, v0);
+    record << location << v0;
+}
+
+void GLTrace::Uniform4f(GLint location, GLfloat v0, GLfloat v1, GLfloat v2, GLfloat v3)
+{
+    TraceRecord record(GLTraceCall::Uniform4f);
+    glUniform4f(location, v0, v1, v2, v3);
+    record << location << v0 << v1 << v2 << v3;
+}
+
+void GLTrace::Uniform4fv(GLint location, GLsizei count, const GLfloat* value)
+{
+    TraceRecord record(GLTraceCall::Uniform4fv);
+    glUniform4fv(location, count, value);
+    record << location << count;
+    record.Bytes(value, count * 4 * sizeof(GLfloat));
+}
+
+void GLTrace::UniformMatrix4fv(GLint location, GLsizei count, GLboolean transpose, const GLfloat* value)
+{
+    TraceRecord record(GLTraceCall::UniformMatrix4fv);
+    glUniformMatrix4fv(location, count, transpose, value);
+    record << location << count << transpose;
+    record.Bytes(value, count * 16 * sizeof(GLfloat));
+}
+
+void GLTrace::Clear(GLbitfield mask)
+{
+    TraceRecord record(GLTraceCall::Clear);
+    glClear(mask);
+    record << mask;
+}
+
+void GLTrace::Enable(GLenum cap)
+{
+    TraceRecord record(GLTraceCall::Enable);
+    glEnable(cap);
+    record << cap;
+}
+
+void GLTrace::Disable(GLenum cap)
+{
+    TraceRecord record(GLTraceCall::Disable);
+    glDisable(cap);
+    record << cap;
+}
+
+void GLTrace::BlendFunc(GLenum sfactor, GLenum dfactor)
+{
+    TraceRecord record(GLTraceCall::BlendFunc);
+    glBlendFunc(sfactor, dfactor);
+    record << sfactor << dfactor;
+}
+
+void GLTrace::DrawElements(GLenum mode, GLsizei count, GLenum type, const void* indices)
+{
+    TraceRecord record(GLTraceCall::DrawElements);
+    glDrawElements(mode, count, type, indices);
+    record << mode << count << type << ToOffset(indices);
+}
+
+void GLTrace::DrawElementsInstanced(GLenum mode, GLsizei count, GLenum type, const void* indices, GLsizei instanceCount)
+{
+    TraceRecord record(GLTraceCall::DrawElementsInstanced);
+    glDrawElementsInstanced(mode, count, type, indices, instanceCount);
+    record << mode << count << type << ToOffset(indices) << instanceCount;
+}
+
+void GLTrace::DrawElementsBaseVertex(GLenum mode, GLsizei count, GLenum type, void* indices, GLint baseVertex)
+{
+    TraceRecord record(GLTraceCall::DrawElementsBaseVertex);
+    glDrawElementsBaseVertex(mode, count, type, indices, baseVertex);
+    record << mode << count << type << ToOffset(indices) << baseVertex;
+}
+
+void GLTrace::MultiDrawElementsIndirect(GLenum mode, GLenum type, const void* indirect, GLsizei drawCount, GLsizei stride)
+{
+    TraceRecord record(GLTraceCall::MultiDrawElementsIndirect);
+    glMultiDrawElementsIndirect(mode, type, indirect, drawCount, stride);
+    record << mode << type << ToOffset(indirect) << drawCount << stride;
+}
+
+void GLTrace::BindBufferBase(GLenum target, GLuint index, GLuint buffer)
+{
+    TraceRecord record(GLTraceCall::BindBufferBase);
+    glBindBufferBase(target, index, buffer);
+    record << target << index << buffer;
+}
+
+void GLTrace::BindBufferRange(GLenum target, GLuint index, GLuint buffer, GLintptr offset, GLsizeiptr size)
+{
+    TraceRecord record(GLTraceCall::BindBufferRange);
+    glBindBufferRange(target, index, buffer, offset, size);
+    record << target << index << buffer << (unsigned long long)offset << (unsigned long long)size;
+}
+
+//Traced like GetUniformLocation, the replay maps the index to the one of its own program
+GLuint GLTrace::GetUniformBlockIndex(GLuint program, const GLchar* uniformBlockName)
+{
+    TraceRecord record(GLTraceCall::GetUniformBlockIndex);
+    GLuint index = glGetUniformBlockIndex(program, uniformBlockName);
+    record << program << index;
+    record.Payload(uniformBlockName, strlen(uniformBlockName) + 1);
+    return index;
+}
+
+void GLTrace::UniformBlockBinding(GLuint program, GLuint uniformBlockIndex, GLuint uniformBlockBinding)
+{
+    TraceRecord record(GLTraceCall::UniformBlockBinding);
+    glUniformBlockBinding(program, uniformBlockIndex, uniformBlockBinding);
+    record << program << uniformBlockIndex << uniformBlockBinding;
+}
+
+void GLTrace::DrawArrays(GLenum mode, GLint first, GLsizei count)
+{
+    TraceRecord record(GLTraceCall::DrawArrays);
+    glDrawArrays(mode, first, count);
+    record << mode << first << count;
+}
+
+void GLTrace::CopyBufferSubData(GLenum readTarget, GLenum writeTarget, GLintptr readOffset, GLintptr writeOffset, GLsizeiptr size)
+{
+    TraceRecord record(GLTraceCall::CopyBufferSubData);
+    glCopyBufferSubData(readTarget, writeTarget, readOffset, writeOffset, size);
+    record << readTarget << writeTarget << (unsigned long long)readOffset << (unsigned long long)writeOffset << (unsigned long long)size;
+}
+
+void GLTrace::Uniform1fv(GLint location, GLsizei count, const GLfloat* value)
+{
+    TraceRecord record(GLTraceCall::Uniform1fv);
+    glUniform1fv(location, count, value);
+    record << location << count;
+    record.Bytes(value, count * sizeof(GLfloat));
+}
+
+void GLTrace::DrawElementsInstancedBaseVertex(GLenum mode, GLsizei count, GLenum type, const void* indices, GLsizei instanceCount, GLint baseVertex)
+{
+    TraceRecord record(GLTraceCall::DrawElementsInstancedBaseVertex);
+    glDrawElementsInstancedBaseVertex(mode, count, type, indices, instanceCount, baseVertex);
+    record << mode << count << type << ToOffset(indices) << instanceCount << baseVertex;
+}
@@ -0,0 +1,206 @@
+#pragma once
+#include <string>
+#include <GL/glew.h>
+
+/* Opt-in tracing of the GL calls made by the renderer classes. Building with OGL_TRACE defined redirects the traced
+   entry points below to GLTrace wrappers, which forward to GL and, between GLTrace::Begin and GLTrace::End, append
+   each call with its arguments, buffer/texture/shader payloads, CPU timestamp and CPU duration to a binary trace.
+   GLTraceReplay re-executes such a trace on any context.
+   Only the calls below are traced, so traced builds turn off what would go around them: direct state access, the
+   shader binary cache, the mapped upload strategies, persistently mapped streaming and uniform ring buffers, and
+   separate attribute formats (glBindVertexBuffer / glVertexAttribFormat).
+
+   Trace file: "GLTR", version (u32), then records of
+     call (u16), argument size (u32), timestamp since Begin in ns (u64), duration of the GL call in ns (u32), arguments
+   Version 2 added BindBufferBase to DrawArrays and version 3 the calls of the last line, older traces are still read. */
+
+#define GL_TRACE_CALLS(X) \
+	X(GenBuffers) X(DeleteBuffers) X(BindBuffer) X(BufferData) X(BufferSubData) \
+	X(GenVertexArrays) X(DeleteVertexArrays) X(BindVertexArray) X(EnableVertexAttribArray) X(VertexAttribPointer) X(VertexAttribDivisor) \
+	X(GenTextures) X(DeleteTextures) X(BindTexture) X(ActiveTexture) X(TexParameteri) X(TexImage2D) \
+	X(CreateShader) X(ShaderSource) X(CompileShader) X(DeleteShader) X(CreateProgram) X(AttachShader) X(LinkProgram) \
+	X(ValidateProgram) X(UseProgram) X(DeleteProgram) X(GetUniformLocation) \
+	X(Uniform1i) X(Uniform1iv) X(Uniform1f) X(Uniform4f) X(Uniform4fv) X(UniformMatrix4fv) \
+	X(Clear) X(Enable) X(Disable) X(BlendFunc) \
+	X(DrawElements) X(DrawElementsInstanced) X(DrawElementsBaseVertex) X(MultiDrawElementsIndirect) \
+	X(BindBufferBase) X(BindBufferRange) X(GetUniformBlockIndex) X(UniformBlockBinding) X(DrawArrays) \
+	X(CopyBufferSubData) X(Uniform1fv) X(DrawElementsInstancedBaseVertex)
+
+#define GL_TRACE_ENUM(name) name,
+enum class GLTraceCall : unsigned short { GL_TRACE_CALLS(GL_TRACE_ENUM) Count };
+#undef GL_TRACE_ENUM
+
+const unsigned int GLTraceVersion = 3;
+const char* GetGLTraceCallName(GLTraceCall call);
+
+class GLTrace {
+public:
+	static bool Begin(const std::string& path);
+	static void End();
+	static bool IsRecording();
+
+	static void GenBuffers(GLsizei n, GLuint* buffers);
+	static void DeleteBuffers(GLsizei n, const GLuint* buffers);
+	static void BindBuffer(GLenum target, GLuint buffer);
+	static void BufferData(GLenum target, GLsizeiptr size, const void* data, GLenum usage);
+	static void BufferSubData(GLenum target, GLintptr offset, GLsizeiptr size, const void* data);
+
+	static void GenVertexArrays(GLsizei n, GLuint* arrays);
+	static void DeleteVertexArrays(GLsizei n, const GLuint* arrays);
+	static void BindVertexArray(GLuint array);
+	static void EnableVertexAttribArray(GLuint index);
+	static void VertexAttribPointer(GLuint index, GLint size, GLenum type, GLboolean normalized, GLsizei stride, const void* pointer);
+	static void VertexAttribDivisor(GLuint index, GLuint divisor);
+
+	static void GenTextures(GLsizei n, GLuint* textures);
+	static void DeleteTextures(GLsizei n, const GLuint* textures);
+	static void BindTexture(GLenum target, GLuint texture);
+	static void ActiveTexture(GLenum texture);
+	static void TexParameteri(GLenum target, GLenum pname, GLint param);
+	static void TexImage2D(GLenum target, GLint level, GLint internalformat, GLsizei width, GLsizei height, GLint border,
+		GLenum format, GLenum type, const void* pixels);
+
+	static GLuint CreateShader(GLenum type);
+	static void ShaderSource(GLuint shader, GLsizei count, const GLchar* const* string, const GLint* length);
+	static void CompileShader(GLuint shader);
+	static void DeleteShader(GLuint shader);
+	static GLuint CreateProgram();
+	static void AttachShader(GLuint program, GLuint shader);
+	static void LinkProgram(GLuint program);
+	static void ValidateProgram(GLuint program);
+	static void UseProgram(GLuint program);
+	static void DeleteProgram(GLuint program);
+	static GLint GetUniformLocation(GLuint program, const GLchar* name);
+
+	static void Uniform1i(GLint location, GLint v0);
+	static void Uniform1iv(GLint location, GLsizei count, const GLint* value);
+	static void Uniform1f(GLint location, GLfloat v0);
+	static void Uniform4f(GLint location, GLfloat v0, GLfloat v1, GLfloat v2, GLfloat v3);
+	static void Uniform4fv(GLint location, GLsizei count, const GLfloat* value);
+	static void UniformMatrix4fv(GLint location, GLsizei count, GLboolean transpose, const GLfloat* value);
+
+	static void Clear(GLbitfield mask);
+	static void Enable(GLenum cap);
+	static void Disable(GLenum cap);
+	static void BlendFunc(GLenum sfactor, GLenum dfactor);
+
+	static void DrawElements(GLenum mode, GLsizei count, GLenum type, const void* indices);
+	static void DrawElementsInstanced(GLenum mode, GLsizei count, GLenum type, const void* indices, GLsizei instanceCount);
+	static void DrawElementsBaseVertex(GLenum mode, GLsizei count, GLenum type, void* indices, GLint baseVertex);
+	static void MultiDrawElementsIndirect(GLenum mode, GLenum type, const void* indirect, GLsizei drawCount, GLsizei stride);
+
+	static void BindBufferBase(GLenum target, GLuint index, GLuint buffer);
+	static void BindBufferRange(GLenum target, GLuint index, GLuint buffer, GLintptr offset, GLsizeiptr size);
+	static GLuint GetUniformBlockIndex(GLuint program, const GLchar* uniformBlockName);
+	static void UniformBlockBinding(GLuint program, GLuint uniformBlockIndex, GLuint uniformBlockBinding);
+	static void DrawArrays(GLenum mode, GLint first, GLsizei count);
+
+	static void CopyBufferSubData(GLenum readTarget, GLenum writeTarget, GLintptr readOffset, GLintptr writeOffset, GLsizeiptr size);
+	static void Uniform1fv(GLint location, GLsizei count, const GLfloat* value);
+	static void DrawElementsInstancedBaseVertex(GLenum mode, GLsizei count, GLenum type, const void* indices, GLsizei instanceCount, GLint baseVertex);
+};
+
+//GLTrace.cpp and the replay need the real entry points
+#if defined(OGL_TRACE) && !defined(OGL_TRACE_IMPL)
+#define GL_TRACE_REDIRECT(name) GLTrace::name
+#undef glGenBuffers
+#define glGenBuffers GL_TRACE_REDIRECT(GenBuffers)
+#undef glDeleteBuffers
+#define glDeleteBuffers GL_TRACE_REDIRECT(DeleteBuffers)
+#undef glBindBuffer
+#define glBindBuffer GL_TRACE_REDIRECT(BindBuffer)
+#undef glBufferData
+#define glBufferData GL_TRACE_REDIRECT(BufferData)
+#undef glBufferSubData
+#define glBufferSubData GL_TRACE_REDIRECT(BufferSubData)
+#undef glGenVertexArrays
+#define glGenVertexArrays GL_TRACE_REDIRECT(GenVertexArrays)
+#undef glDeleteVertexArrays
+#define glDeleteVertexArrays GL_TRACE_REDIRECT(DeleteVertexArrays)
+#undef glBindVertexArray
+#define glBindVertexArray GL_TRACE_REDIRECT(BindVertexArray)
+#undef glEnableVertexAttribArray
+#define glEnableVertexAttribArray GL_TRACE_REDIRECT(EnableVertexAttribArray)
+#undef glVertexAttribPointer
+#define glVertexAttribPointer GL_TRACE_REDIRECT(VertexAttribPointer)
+#undef glVertexAttribDivisor
+#define glVertexAttribDivisor GL_TRACE_REDIRECT(VertexAttribDivisor)
+#undef glGenTextures
+#define glGenTextures GL_TRACE_REDIRECT(GenTextures)
+#undef glDeleteTextures
+#define glDeleteTextures GL_TRACE_REDIRECT(DeleteTextures)
+#undef glBindTexture
+#define glBindTexture GL_TRACE_REDIRECT(BindTexture)
+#undef glActiveTexture
+#define glActiveTexture GL_TRACE_REDIRECT(ActiveTexture)
+#undef glTexParameteri
+#define glTexParameteri GL_TRACE_REDIRECT(TexParameteri)
+#undef glTexImage2D
+#define glTexImage2D GL_TRACE_REDIRECT(TexImage2D)
+#undef glCreateShader
+#define glCreateShader GL_TRACE_REDIRECT(CreateShader)
+#undef glShaderSource
+#define glShaderSource GL_TRACE_REDIRECT(ShaderSource)
+#undef glCompileShader
+#define glCompileShader GL_TRACE_REDIRECT(CompileShader)
+#undef glDeleteShader
+#define glDeleteShader GL_TRACE_REDIRECT(DeleteShader)
+#undef glCreateProgram
+#define glCreateProgram GL_TRACE_REDIRECT(CreateProgram)
+#undef glAttachShader
+#define glAttachShader GL_TRACE_REDIRECT(AttachShader)
+#undef glLinkProgram
+#define glLinkProgram GL_TRACE_REDIRECT(LinkProgram)
+#undef glValidateProgram
+#define glValidateProgram GL_TRACE_REDIRECT(ValidateProgram)
+#undef glUseProgram
+#define glUseProgram GL_TRACE_REDIRECT(UseProgram)
+#undef glDeleteProgram
+#define glDeleteProgram GL_TRACE_REDIRECT(DeleteProgram)
+#undef glGetUniformLocation
+#define glGetUniformLocation GL_TRACE_REDIRECT(GetUniformLocation)
+#undef glUniform1i
+#define glUniform1i GL_TRACE_REDIRECT(Uniform1i)
+#undef glUniform1iv
+#define glUniform1iv GL_TRACE_REDIRECT(Uniform1iv)
+#undef glUniform1f
+#define glUniform1f GL_TRACE_REDIRECT(Uniform1f)
+#undef glUniform4f
+#define glUniform4f GL_TRACE_REDIRECT(Uniform4f)
+#undef glUniform4fv
+#define glUniform4fv GL_TRACE_REDIRECT(Uniform4fv)
+#undef glUniformMatrix4fv
+#define glUniformMatrix4fv GL_TRACE_REDIRECT(UniformMatrix4fv)
+#undef glClear
+#define glClear GL_TRACE_REDIRECT(Clear)
+#undef glEnable
+#define glEnable GL_TRACE_REDIRECT(Enable)
+#undef glDisable
+#define glDisable GL_TRACE_REDIRECT(Disable)
+#undef glBlendFunc
+#define glBlendFunc GL_TRACE_REDIRECT(BlendFunc)
+#undef glDrawElements
+#define glDrawElements GL_TRACE_REDIRECT(DrawElements)
+#undef glDrawElementsInstanced
+#define glDrawElementsInstanced GL_TRACE_REDIRECT(DrawElementsInstanced)
+#undef glDrawElementsBaseVertex
+#define glDrawElementsBaseVertex GL_TRACE_REDIRECT(DrawElementsBaseVertex)
+#undef glMultiDrawElementsIndirect
+#define glMultiDrawElementsIndirect GL_TRACE_REDIRECT(MultiDrawElementsIndirect)
+#undef glBindBufferBase
+#define glBindBufferBase GL_TRACE_REDIRECT(BindBufferBase)
+#undef glBindBufferRange
+#define glBindBufferRange GL_TRACE_REDIRECT(BindBufferRange)
+#undef glGetUniformBlockIndex
+#define glGetUniformBlockIndex GL_TRACE_REDIRECT(GetUniformBlockIndex)
+#undef glUniformBlockBinding
+#define glUniformBlockBinding GL_TRACE_REDIRECT(UniformBlockBinding)
+#undef glDrawArrays
+#define glDrawArrays GL_TRACE_REDIRECT(DrawArrays)
+#undef glCopyBufferSubData
+#define glCopyBufferSubData GL_TRACE_REDIRECT(CopyBufferSubData)
+#undef glUniform1fv
+#define glUniform1fv GL_TRACE_REDIRECT(Uniform1fv)
+#undef glDrawElementsInstancedBaseVertex
+#define glDrawElementsInstancedBaseVertex GL_TRACE_REDIRECT(DrawElementsInstancedBaseVertex)
+#endif
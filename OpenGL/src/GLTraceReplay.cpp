@@ -0,0 +1,602 @@
+#define OGL_TRACE_IMPL
+#include "GLTraceReplay.h"
+
+#include <chrono>
+#include <cstring>
+#include <fstream>
+#include <iomanip>
+#include <iostream>
+
+GLTraceReplay::GLTraceReplay()
+    : m_Offset(0), m_CurrentProgram(0)
+{
+}
+
+bool GLTraceReplay::Load(const std::string& path)
+{
+    std::ifstream file(path, std::ios::binary);
+    if (!file)
+        return false;
+
+    m_Data.assign(std::istreambuf_iterator<char>(file), std::istreambuf_iterator<char>());
+
+    unsigned int version = 0;
+    if (m_Data.size() < 8 || memcmp(m_Data.data(), "GLTR", 4) != 0)
+        return false;
+    memcpy(&version, &m_Data[4], sizeof(version));
+    m_Offset = 8;
+    //Newer versions only add calls
+    return version >= 1 && version <= GLTraceVersion;
+}
+
+template<typename T>
+T GLTraceReplay::Read()
+{
+    T value;
+    memcpy(&value, &m_Data[m_Offset], sizeof(T));
+    m_Offset += sizeof(T);
+    return value;
+}
+
+const void* GLTraceReplay::ReadBytes(size_t size)
+{
+    const void* data = &m_Data[m_Offset];
+    m_Offset += size;
+    return data;
+}
+
+//An empty payload was a null pointer when traced
+const void* GLTraceReplay::ReadPayload(unsigned int& size)
+{
+    size = Read<unsigned int>();
+    return size ? ReadBytes(size) : nullptr;
+}
+
+unsigned int GLTraceReplay::MapName(std::unordered_map<unsigned int, unsigned int>& names, unsigned int traced) const
+{
+    if (traced == 0)
+        return 0;
+    auto it = names.find(traced);
+    return it != names.end() ? it->second : traced;
+}
+
+int GLTraceReplay::MapLocation(int traced) const
+{
+    auto it = m_UniformLocations.find(((unsigned long long)m_CurrentProgram << 32) | (unsigned int)traced);
+    return it != m_UniformLocations.end() ? it->second : traced;
+}
+
+/* @brief: Checks the record's argsSize bytes at m_Offset are exactly the arguments GLTrace writes for call, reading the
+           count or payload size they contain if any, so Execute never reads past the record
+*/
+bool GLTraceReplay::CheckArguments(GLTraceCall call, unsigned int argsSize) const
+{
+    //Bytes before the variable part, where its element count is and the size of an element (0: no variable part)
+    size_t fixed = 0;
+    size_t countOffset = 0;
+    size_t element = 0;
+    switch (call)
+    {
+        case GLTraceCall::GenBuffers:
+        case GLTraceCall::DeleteBuffers:
+        case GLTraceCall::GenVertexArrays:
+        case GLTraceCall::DeleteVertexArrays:
+        case GLTraceCall::GenTextures:
+        case GLTraceCall::DeleteTextures:
+            fixed = 4; countOffset = 0; element = sizeof(GLuint);
+            break;
+        case GLTraceCall::BufferData:
+            fixed = 20; countOffset = 16; element = 1;
+            break;
+        case GLTraceCall::BufferSubData:
+            fixed = 16; countOffset = 12; element = 1;
+            break;
+        case GLTraceCall::TexImage2D:
+            fixed = 36; countOffset = 32; element = 1;
+            break;
+        case GLTraceCall::ShaderSource:
+            fixed = 8; countOffset = 4; element = 1;
+            break;
+        case GLTraceCall::GetUniformLocation:
+        case GLTraceCall::GetUniformBlockIndex:
+            fixed = 12; countOffset = 8; element = 1;
+            break;
+        case GLTraceCall::Uniform1iv:
+        case GLTraceCall::Uniform1fv:
+            fixed = 8; countOffset = 4; element = 4;
+            break;
+        case GLTraceCall::Uniform4fv:
+            fixed = 8; countOffset = 4; element = 16;
+            break;
+        case GLTraceCall::UniformMatrix4fv:
+            fixed = 9; countOffset = 4; element = 64;
+            break;
+        case GLTraceCall::BindVertexArray:
+        case GLTraceCall::EnableVertexAttribArray:
+        case GLTraceCall::ActiveTexture:
+        case GLTraceCall::CompileShader:
+        case GLTraceCall::DeleteShader:
+        case GLTraceCall::CreateProgram:
+        case GLTraceCall::LinkProgram:
+        case GLTraceCall::ValidateProgram:
+        case GLTraceCall::UseProgram:
+        case GLTraceCall::DeleteProgram:
+        case GLTraceCall::Clear:
+        case GLTraceCall::Enable:
+        case GLTraceCall::Disable:
+            fixed = 4;
+            break;
+        case GLTraceCall::BindBuffer:
+        case GLTraceCall::VertexAttribDivisor:
+        case GLTraceCall::BindTexture:
+        case GLTraceCall::CreateShader:
+        case GLTraceCall::AttachShader:
+        case GLTraceCall::Uniform1i:
+        case GLTraceCall::Uniform1f:
+        case GLTraceCall::BlendFunc:
+            fixed = 8;
+            break;
+        case GLTraceCall::TexParameteri:
+        case GLTraceCall::BindBufferBase:
+        case GLTraceCall::UniformBlockBinding:
+        case GLTraceCall::DrawArrays:
+            fixed = 12;
+            break;
+        case GLTraceCall::Uniform4f:
+        case GLTraceCall::DrawElements:
+            fixed = 20;
+            break;
+        case GLTraceCall::DrawElementsInstanced:
+        case GLTraceCall::DrawElementsBaseVertex:
+        case GLTraceCall::MultiDrawElementsIndirect:
+            fixed = 24;
+            break;
+        case GLTraceCall::VertexAttribPointer:
+            fixed = 25;
+            break;
+        case GLTraceCall::BindBufferRange:
+        case GLTraceCall::DrawElementsInstancedBaseVertex:
+            fixed = 28;
+            break;
+        case GLTraceCall::CopyBufferSubData:
+            fixed = 32;
+            break;
+        default:
+            return false;
+    }
+
+    if (argsSize < fixed)
+        return false;
+    if (element == 0)
+        return argsSize == fixed;
+
+    //Counts are GLsizei and payload sizes unsigned, a negative count reads as a huge one and fails the same way
+    unsigned int count;
+    memcpy(&count, &m_Data[m_Offset + countOffset], sizeof(count));
+    return argsSize == fixed + (unsigned long long)count * element;
+}
+
+/* @brief: Reads the arguments of one call (in the order GLTrace wrote them) and issues it with remapped names.
+           CheckArguments has to have accepted the record.
+*/
+void GLTraceReplay::Execute(GLTraceCall call)
+{
+    switch (call)
+    {
+        case GLTraceCall::GenBuffers:
+        case GLTraceCall::GenVertexArrays:
+        case GLTraceCall::GenTextures:
+        {
+            GLsizei n = Read<GLsizei>();
+            const GLuint* traced = (const GLuint*)ReadBytes(n * sizeof(GLuint));
+            std::vector<GLuint> names(n);
+            std::unordered_map<unsigned int, unsigned int>* map = &m_Buffers;
+            if (call == GLTraceCall::GenBuffers)
+                glGenBuffers(n, names.data());
+            else if (call == GLTraceCall::GenVertexArrays)
+            {
+                glGenVertexArrays(n, names.data());
+                map = &m_VertexArrays;
+            }
+            else
+            {
+                glGenTextures(n, names.data());
+                map = &m_Textures;
+            }
+            for (GLsizei i = 0; i < n; i++)
+            {
+                GLuint tracedName;
+                memcpy(&tracedName, &traced[i], sizeof(GLuint));
+                (*map)[tracedName] = names[i];
+            }
+            break;
+        }
+        case GLTraceCall::DeleteBuffers:
+        case GLTraceCall::DeleteVertexArrays:
+        case GLTraceCall::DeleteTextures:
+        {
+            GLsizei n = Read<GLsizei>();
+            std::unordered_map<unsigned int, unsigned int>& map = call == GLTraceCall::DeleteBuffers ? m_Buffers
+                : call == GLTraceCall::DeleteVertexArrays ? m_VertexArrays : m_Textures;
+            std::vector<GLuint> names(n);
+            for (GLsizei i = 0; i < n; i++)
+            {
+                GLuint traced = Read<GLuint>();
+                names[i] = MapName(map, traced);
+                map.erase(traced);
+            }
+            if (call == GLTraceCall::DeleteBuffers)
+                glDeleteBuffers(n, names.data());
+            else if (call == GLTraceCall::DeleteVertexArrays)
+                glDeleteVertexArrays(n, names.data());
+            else
+                glDeleteTextures(n, names.data());
+            break;
+        }
+        case GLTraceCall::BindBuffer:
+        {
+            GLenum target = Read<GLenum>();
+            glBindBuffer(target, MapName(m_Buffers, Read<GLuint>()));
+            break;
+        }
+        case GLTraceCall::BufferData:
+        {
+            GLenum target = Read<GLenum>();
+            unsigned long long size = Read<unsigned long long>();
+            GLenum usage = Read<GLenum>();
+            unsigned int payloadSize;
+            const void* data = ReadPayload(payloadSize);
+            glBufferData(target, (GLsizeiptr)size, data, usage);
+            break;
+        }
+        case GLTraceCall::BufferSubData:
+        {
+            GLenum target = Read<GLenum>();
+            unsigned long long offset = Read<unsigned long long>();
+            unsigned int size;
+            const void* data = ReadPayload(size);
+            glBufferSubData(target, (GLintptr)offset, size, data);
+            break;
+        }
+        case GLTraceCall::BindVertexArray:
+            glBindVertexArray(MapName(m_VertexArrays, Read<GLuint>()));
+            break;
+        case GLTraceCall::EnableVertexAttribArray:
+            glEnableVertexAttribArray(Read<GLuint>());
+            break;
+        case GLTraceCall::VertexAttribPointer:
+        {
+            GLuint index = Read<GLuint>();
+            GLint size = Read<GLint>();
+            GLenum type = Read<GLenum>();
+            GLboolean normalized = Read<GLboolean>();
+            GLsizei stride = Read<GLsizei>();
+            unsigned long long offset = Read<unsigned long long>();
+            glVertexAttribPointer(index, size, type, normalized, stride, (const void*)(size_t)offset);
+            break;
+        }
+        case GLTraceCall::VertexAttribDivisor:
+        {
+            GLuint index = Read<GLuint>();
+            glVertexAttribDivisor(index, Read<GLuint>());
+            break;
+        }
+        case GLTraceCall::BindTexture:
+        {
+            GLenum target = Read<GLenum>();
+            glBindTexture(target, MapName(m_Textures, Read<GLuint>()));
+            break;
+        }
+        case GLTraceCall::ActiveTexture:
+            glActiveTexture(Read<GLenum>());
+            break;
+        case GLTraceCall::TexParameteri:
+        {
+            GLenum target = Read<GLenum>();
+            GLenum pname = Read<GLenum>();
+            glTexParameteri(target, pname, Read<GLint>());
+            break;
+        }
+        case GLTraceCall::TexImage2D:
+        {
+            GLenum target = Read<GLenum>();
+            GLint level = Read<GLint>();
+            GLint internalformat = Read<GLint>();
+            GLsizei width = Read<GLsizei>();
+            GLsizei height = Read<GLsizei>();
+            GLint border = Read<GLint>();
+            GLenum format = Read<GLenum>();
+            GLenum type = Read<GLenum>();
+            unsigned int size;
+            const void* pixels = ReadPayload(size);
+            glTexImage2D(target, level, internalformat, width, height, border, format, type, pixels);
+            break;
+        }
+        case GLTraceCall::CreateShader:
+        {
+            GLenum type = Read<GLenum>();
+            GLuint traced = Read<GLuint>();
+            m_Shaders[traced] = glCreateShader(type);
+            break;
+        }
+        case GLTraceCall::ShaderSource:
+        {
+            GLuint shader = MapName(m_Shaders, Read<GLuint>());
+            unsigned int size;
+            const GLchar* source = (const GLchar*)ReadPayload(size);
+            GLint length = (GLint)size;
+            glShaderSource(shader, 1, &source, &length);
+            break;
+        }
+        case GLTraceCall::CompileShader:
+            glCompileShader(MapName(m_Shaders, Read<GLuint>()));
+            break;
+        case GLTraceCall::DeleteShader:
+        case GLTraceCall::DeleteProgram:
+        {
+            GLuint traced = Read<GLuint>();
+            GLuint name = MapName(m_Shaders, traced);
+            m_Shaders.erase(traced);
+            if (call == GLTraceCall::DeleteShader)
+                glDeleteShader(name);
+            else
+                glDeleteProgram(name);
+            break;
+        }
+        case GLTraceCall::CreateProgram:
+            m_Shaders[Read<GLuint>()] = glCreateProgram();
+            break;
+        case GLTraceCall::AttachShader:
+        {
+            GLuint program = MapName(m_Shaders, Read<GLuint>());
+            glAttachShader(program, MapName(m_Shaders, Read<GLuint>()));
+            break;
+        }
+        case GLTraceCall::LinkProgram:
+            glLinkProgram(MapName(m_Shaders, Read<GLuint>()));
+            break;
+        case GLTraceCall::ValidateProgram:
+            glValidateProgram(MapName(m_Shaders, Read<GLuint>()));
+            break;
+        case GLTraceCall::UseProgram:
+            m_CurrentProgram = Read<GLuint>();
+            glUseProgram(MapName(m_Shaders, m_CurrentProgram));
+            break;
+        case GLTraceCall::GetUniformLocation:
+        {
+            GLuint program = Read<GLuint>();
+            GLint traced = Read<GLint>();
+            unsigned int size;
+            const GLchar* name = (const GLchar*)ReadPayload(size);
+            GLint location = glGetUniformLocation(MapName(m_Shaders, program), name);
+            m_UniformLocations[((unsigned long long)program << 32) | (unsigned int)traced] = location;
+            break;
+        }
+        case GLTraceCall::Uniform1i:
+        {
+            GLint location = MapLocation(Read<GLint>());
+            glUniform1i(location, Read<GLint>());
+            break;
+        }
+        case GLTraceCall::Uniform1iv:
+        {
+            GLint location = MapLocation(Read<GLint>());
+            GLsizei count = Read<GLsizei>();
+            std::vector<GLint> values(count);
+            memcpy(values.data(), ReadBytes(count * sizeof(GLint)), count * sizeof(GLint));
+            glUniform1iv(location, count, values.data());
+            break;
+        }
+        case GLTraceCall::Uniform1f:
+        {
+            GLint location = MapLocation(Read<GLint>());
+            glUniform1f(location, Read<GLfloat>());
+            break;
+        }
+        case GLTraceCall::Uniform4f:
+        {
+            GLint location = MapLocation(Read<GLint>());
+            GLfloat v0 = Read<GLfloat>();
+            GLfloat v1 = Read<GLfloat>();
+            GLfloat v2 = Read<GLfloat>();
+            glUniform4f(location, v0, v1, v2, Read<GLfloat>());
+            break;
+        }
+        case GLTraceCall::Uniform4fv:
+        case GLTraceCall::UniformMatrix4fv:
+        {
+            GLint location = MapLocation(Read<GLint>());
+            GLsizei count = Read<GLsizei>();
+            GLboolean transpose = call == GLTraceCall::UniformMatrix4fv ? Read<GLboolean>() : GL_FALSE;
+            size_t floats = count * (call == GLTraceCall::UniformMatrix4fv ? 16 : 4);
+            std::vector<GLfloat> values(floats);
+            memcpy(values.data(), ReadBytes(floats * sizeof(GLfloat)), floats * sizeof(GLfloat));
+            if (call == GLTraceCall::UniformMatrix4fv)
+                glUniformMatrix4fv(location, count, transpose, values.data());
+            else
+                glUniform4fv(location, count, values.data());
+            break;
+        }
+        case GLTraceCall::Clear:
+            glClear(Read<GLbitfield>());
+            break;
+        case GLTraceCall::Enable:
+            glEnable(Read<GLenum>());
+            break;
+        case GLTraceCall::Disable:
+            glDisable(Read<GLenum>());
+            break;
+        case GLTraceCall::BlendFunc:
+        {
+            GLenum sfactor = Read<GLenum>();
+            glBlendFunc(sfactor, Read<GLenum>());
+            break;
+        }
+        case GLTraceCall::DrawElements:
+        {
+            GLenum mode = Read<GLenum>();
+            GLsizei count = Read<GLsizei>();
+            GLenum type = Read<GLenum>();
+            glDrawElements(mode, count, type, (const void*)(size_t)Read<unsigned long long>());
+            break;
+        }
+        case GLTraceCall::DrawElementsInstanced:
+        {
+            GLenum mode = Read<GLenum>();
+            GLsizei count = Read<GLsizei>();
+            GLenum type = Read<GLenum>();
+            const void* indices = (const void*)(size_t)Read<unsigned long long>();
+            glDrawElementsInstanced(mode, count, type, indices, Read<GLsizei>());
+            break;
+        }
+        case GLTraceCall::DrawElementsBaseVertex:
+        {
+            GLenum mode = Read<GLenum>();
+            GLsizei count = Read<GLsizei>();
+            GLenum type = Read<GLenum>();
+            void* indices = (void*)(size_t)Read<unsigned long long>();
+            glDrawElementsBaseVertex(mode, count, type, indices, Read<GLint>());
+            break;
+        }
+        case GLTraceCall::MultiDrawElementsIndirect:
+        {
+            GLenum mode = Read<GLenum>();
+            GLenum type = Read<GLenum>();
+            const void* indirect = (const void*)(size_t)Read<unsigned long long>();
+            GLsizei drawCount = Read<GLsizei>();
+            glMultiDrawElementsIndirect(mode, type, indirect, drawCount, Read<GLsizei>());
+            break;
+        }
+        case GLTraceCall::BindBufferBase:
+        {
+            GLenum target = Read<GLenum>();
+            GLuint index = Read<GLuint>();
+            glBindBufferBase(target, index, MapName(m_Buffers, Read<GLuint>()));
+            break;
+        }
+        case GLTraceCall::BindBufferRange:
+        {
+            GLenum target = Read<GLenum>();
+            GLuint index = Read<GLuint>();
+            GLuint buffer = MapName(m_Buffers, Read<GLuint>());
+            unsigned long long offset = Read<unsigned long long>();
+            glBindBufferRange(target, index, buffer, (GLintptr)offset, (GLsizeiptr)Read<unsigned long long>());
+            break;
+        }
+        case GLTraceCall::GetUniformBlockIndex:
+        {
+            GLuint program = Read<GLuint>();
+            GLuint traced = Read<GLuint>();
+            unsigned int size;
+            const GLchar* name = (const GLchar*)ReadPayload(size);
+            GLuint index = glGetUniformBlockIndex(MapName(m_Shaders, program), name);
+            m_UniformBlockIndices[((unsigned long long)program << 32) | traced] = index;
+            break;
+        }
+        case GLTraceCall::UniformBlockBinding:
+        {
+            GLuint program = Read<GLuint>();
+            GLuint traced = Read<GLuint>();
+            auto it = m_UniformBlockIndices.find(((unsigned long long)program << 32) | traced);
+            GLuint index = it != m_UniformBlockIndices.end() ? it->second : traced;
+            glUniformBlockBinding(MapName(m_Shaders, program), index, Read<GLuint>());
+            break;
+        }
+        case GLTraceCall::DrawArrays:
+        {
+            GLenum mode = Read<GLenum>();
+            GLint first = Read<GLint>();
+            glDrawArrays(mode, first, Read<GLsizei>());
+            break;
+        }
+        case GLTraceCall::CopyBufferSubData:
+        {
+            GLenum readTarget = Read<GLenum>();
+            GLenum writeTarget = Read<GLenum>();
+            unsigned long long readOffset = Read<unsigned long long>();
+            unsigned long long writeOffset = Read<unsigned long long>();
+            glCopyBufferSubData(readTarget, writeTarget, (GLintptr)readOffset, (GLintptr)writeOffset, (GLsizeiptr)Read<unsigned long long>());
+            break;
+        }
+        case GLTraceCall::Uniform1fv:
+        {
+            GLint location = MapLocation(Read<GLint>());
+            GLsizei count = Read<GLsizei>();
+            std::vector<GLfloat> values(count);
+            memcpy(values.data(), ReadBytes(count * sizeof(GLfloat)), count * sizeof(GLfloat));
+            glUniform1fv(location, count, values.data());
+            break;
+        }
+        case GLTraceCall::DrawElementsInstancedBaseVertex:
+        {
+            GLenum mode = Read<GLenum>();
+            GLsizei count = Read<GLsizei>();
+            GLenum type = Read<GLenum>();
+            const void* indices = (const void*)(size_t)Read<unsigned long long>();
+            GLsizei instanceCount = Read<GLsizei>();
+            glDrawElementsInstancedBaseVertex(mode, count, type, indices, instanceCount, Read<GLint>());
+            break;
+        }
+        default:
+            break;
+    }
+}
+
+void GLTraceReplay::Run()
+{
+    typedef std::chrono::steady_clock Clock;
+
+    while (m_Offset + 18 <= m_Data.size())
+    {
+        unsigned short call = Read<unsigned short>();
+        unsigned int argsSize = Read<unsigned int>();
+        Read<unsigned long long>();
+        unsigned int duration = Read<unsigned int>();
+        size_t next = m_Offset + argsSize;
+        if (next > m_Data.size() || call >= (unsigned short)GLTraceCall::Count)
+            break;
+        if (!CheckArguments((GLTraceCall)call, argsSize))
+        {
+            std::cout << "Error: " << GetGLTraceCallName((GLTraceCall)call) << " record at byte " << m_Offset - 18
+                << " has " << argsSize << " bytes of arguments that don't match the call, replay stopped" << std::endl;
+            break;
+        }
+
+        Clock::time_point start = Clock::now();
+        Execute((GLTraceCall)call);
+        double replayMs = std::chrono::duration<double, std::milli>(Clock::now() - start).count();
+
+        CallStats& stats = m_Stats[call];
+        stats.Count++;
+        stats.RecordedMs += duration / 1000000.0;
+        stats.ReplayMs += replayMs;
+
+        //Whatever an Execute case read, the next record starts right after this one's arguments
+        m_Offset = next;
+    }
+
+    glFinish();
+}
+
+void GLTraceReplay::PrintStats() const
+{
+    unsigned int totalCount = 0;
+    double totalRecorded = 0.0, totalReplay = 0.0;
+
+    std::cout << std::left << std::setw(32) << "call" << std::right << std::setw(10) << "count"
+        << std::setw(16) << "recorded ms" << std::setw(14) << "replay ms" << std::endl;
+    for (int i = 0; i < (int)GLTraceCall::Count; i++)
+    {
+        const CallStats& stats = m_Stats[i];
+        if (stats.Count == 0)
+            continue;
+        std::cout << std::left << std::setw(32) << GetGLTraceCallName((GLTraceCall)i) << std::right
+            << std::setw(10) << stats.Count << std::fixed << std::setprecision(3)
+            << std::setw(16) << stats.RecordedMs << std::setw(14) << stats.ReplayMs << std::endl;
+        totalCount += stats.Count;
+        totalRecorded += stats.RecordedMs;
+        totalReplay += stats.ReplayMs;
+    }
+    std::cout << std::left << std::setw(32) << "total" << std::right << std::setw(10) << totalCount
+        << std::setw(16) << totalRecorded << std::setw(14) << totalReplay << std::endl;
+}
@@ -0,0 +1,53 @@
+#pragma once
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+#include "GLTrace.h"
+
+/* Re-executes a trace written by GLTrace on the current context. Object names and uniform locations are remapped to
+   the ones the replay context hands out, and every call is timed again so the cost of the traced frames can be
+   compared between drivers (e.g. the machine it was captured on and llvmpipe). */
+class GLTraceReplay {
+public:
+	struct CallStats {
+		unsigned int Count = 0;
+		double RecordedMs = 0.0;
+		double ReplayMs = 0.0;
+	};
+
+private:
+	std::vector<unsigned char> m_Data;
+	size_t m_Offset;
+
+	std::unordered_map<unsigned int, unsigned int> m_Buffers;
+	std::unordered_map<unsigned int, unsigned int> m_VertexArrays;
+	std::unordered_map<unsigned int, unsigned int> m_Textures;
+	std::unordered_map<unsigned int, unsigned int> m_Shaders;
+	//Keyed by traced program << 32 | traced location
+	std::unordered_map<unsigned long long, int> m_UniformLocations;
+	//Same key with the traced block index
+	std::unordered_map<unsigned long long, unsigned int> m_UniformBlockIndices;
+	unsigned int m_CurrentProgram;
+
+	CallStats m_Stats[(int)GLTraceCall::Count];
+
+	template<typename T>
+	T Read();
+	const void* ReadPayload(unsigned int& size);
+	const void* ReadBytes(size_t size);
+
+	unsigned int MapName(std::unordered_map<unsigned int, unsigned int>& names, unsigned int traced) const;
+	int MapLocation(int traced) const;
+	bool CheckArguments(GLTraceCall call, unsigned int argsSize) const;
+	void Execute(GLTraceCall call);
+
+public:
+	GLTraceReplay();
+
+	bool Load(const std::string& path);
+	void Run();
+	void PrintStats() const;
+
+	inline const CallStats& GetStats(GLTraceCall call) const { return m_Stats[(int)call]; }
+};
@@ -0,0 +1,169 @@
+#include "GpuBufferArena.h"
+#include "Renderer.h"
+
+#include <algorithm>
+#include <iostream>
+
+GpuBufferArena::GpuBufferArena(const VertexBufferLayout& layout, unsigned int maxVertices, unsigned int maxIndices, unsigned int indexType)
+    : m_Layout(layout), m_MaxVertices(maxVertices), m_MaxIndices(maxIndices), m_IndexType(indexType),
+      m_VertexAllocator(maxVertices), m_IndexAllocator(maxIndices), m_MeshCount(0)
+{
+    CreateBuffers();
+}
+
+void GpuBufferArena::CreateBuffers()
+{
+    m_VertexBuffer.reset(new VertexBuffer(m_MaxVertices * m_Layout.GetStride()));
+    m_IndexBuffer.reset(new IndexBuffer(m_MaxIndices, m_IndexType));
+    m_VertexArray.reset(new VertexArray());
+    m_VertexArray->AddBuffer(*m_VertexBuffer, m_Layout);
+}
+
+bool GpuBufferArena::AllocateMesh(Mesh& mesh)
+{
+    mesh.Vertices = m_VertexAllocator.Allocate(mesh.VertexCount);
+    mesh.Indices = m_IndexAllocator.Allocate(mesh.IndexCount);
+    if (mesh.Vertices.Offset != OffsetAllocator::Invalid && mesh.Indices.Offset != OffsetAllocator::Invalid)
+        return true;
+
+    m_VertexAllocator.Free(mesh.Vertices);
+    m_IndexAllocator.Free(mesh.Indices);
+    mesh.Vertices = OffsetAllocator::Allocation();
+    mesh.Indices = OffsetAllocator::Allocation();
+    return false;
+}
+
+/* @brief: Copies the mesh into the arena. When no free range is big enough but there's enough free space overall the
+           arena gets defragmented first. A free range of exactly the mesh size is found without defragmenting, see
+           OffsetAllocator::Allocate. Returns InvalidMesh when the mesh is empty, doesn't fit, or has more vertices
+           than the index type can address.
+*/
+GpuMeshHandle GpuBufferArena::Add(const void* vertices, unsigned int vertexCount, const unsigned int* indices, unsigned int indexCount)
+{
+    //An allocator never hands out an empty range, it would look like a full arena and trigger a defragmentation
+    if (vertexCount == 0 || indexCount == 0)
+        return InvalidMesh;
+    if (m_IndexType != GL_UNSIGNED_INT && vertexCount > (1u << (8 * IndexBuffer::GetSizeOfType(m_IndexType))))
+        return InvalidMesh;
+
+    Mesh mesh;
+    mesh.VertexCount = vertexCount;
+    mesh.IndexCount = indexCount;
+    mesh.Live = true;
+
+    if (!AllocateMesh(mesh))
+    {
+        if (vertexCount > m_VertexAllocator.GetFreeSpace() || indexCount > m_IndexAllocator.GetFreeSpace())
+            return InvalidMesh;
+        Defragment();
+        if (!AllocateMesh(mesh))
+            return InvalidMesh;
+    }
+
+    unsigned int stride = m_Layout.GetStride();
+    m_VertexBuffer->Update(mesh.Vertices.Offset * stride, vertices, vertexCount * stride);
+    m_IndexBuffer->Update(mesh.Indices.Offset, indices, indexCount);
+
+    GpuMeshHandle handle;
+    if (!m_FreeHandles.empty())
+    {
+        handle = m_FreeHandles.back();
+        m_FreeHandles.pop_back();
+        m_Meshes[handle] = mesh;
+    }
+    else
+    {
+        handle = (GpuMeshHandle)m_Meshes.size();
+        m_Meshes.push_back(mesh);
+    }
+    m_MeshCount++;
+    return handle;
+}
+
+/* @brief: The ranges may be handed out again right away, like any buffer update a mesh drawn this frame shouldn't be
+           replaced before the frame ends
+*/
+void GpuBufferArena::Remove(GpuMeshHandle handle)
+{
+    if (handle >= m_Meshes.size() || !m_Meshes[handle].Live)
+        return;
+
+    Mesh& mesh = m_Meshes[handle];
+    m_VertexAllocator.Free(mesh.Vertices);
+    m_IndexAllocator.Free(mesh.Indices);
+    mesh.Live = false;
+    m_FreeHandles.push_back(handle);
+    m_MeshCount--;
+}
+
+static void CopyBuffer(unsigned int source, unsigned int destination, unsigned int sourceOffset, unsigned int destinationOffset, unsigned int size)
+{
+    if (GLDirectStateAccessActive())
+    {
+        GLCall(glCopyNamedBufferSubData(source, destination, sourceOffset, destinationOffset, size));
+        return;
+    }
+    GLCall(glBindBuffer(GL_COPY_READ_BUFFER, source));
+    GLCall(glBindBuffer(GL_COPY_WRITE_BUFFER, destination));
+    GLCall(glCopyBufferSubData(GL_COPY_READ_BUFFER, GL_COPY_WRITE_BUFFER, sourceOffset, destinationOffset, size));
+}
+
+/* @brief: Packs the live meshes at the start of new buffers, in their current order, with glCopyBufferSubData. The
+           copy stays on the GPU. Source and destination ranges can't overlap within a buffer, hence the new buffers.
+*/
+void GpuBufferArena::Defragment()
+{
+    std::vector<GpuMeshHandle> live;
+    for (GpuMeshHandle handle = 0; handle < m_Meshes.size(); handle++)
+    {
+        if (m_Meshes[handle].Live)
+            live.push_back(handle);
+    }
+    std::sort(live.begin(), live.end(), [this](GpuMeshHandle a, GpuMeshHandle b) {
+        return m_Meshes[a].Vertices.Offset < m_Meshes[b].Vertices.Offset;
+    });
+
+    std::unique_ptr<VertexBuffer> oldVertices = std::move(m_VertexBuffer);
+    std::unique_ptr<IndexBuffer> oldIndices = std::move(m_IndexBuffer);
+    m_VertexArray.reset();
+    CreateBuffers();
+    m_VertexAllocator.Reset();
+    m_IndexAllocator.Reset();
+
+    unsigned int stride = m_Layout.GetStride();
+    unsigned int indexSize = IndexBuffer::GetSizeOfType(m_IndexType);
+    for (GpuMeshHandle handle : live)
+    {
+        Mesh& mesh = m_Meshes[handle];
+        unsigned int oldVertexOffset = mesh.Vertices.Offset;
+        unsigned int oldIndexOffset = mesh.Indices.Offset;
+        //Packed from the start of empty buffers of the same size, what fitted before always fits
+        if (!AllocateMesh(mesh))
+        {
+            std::cout << "Error: GpuBufferArena lost mesh " << handle << " while defragmenting" << std::endl;
+            ASSERT(false);
+            mesh.Live = false;
+            m_FreeHandles.push_back(handle);
+            m_MeshCount--;
+            continue;
+        }
+
+        CopyBuffer(oldVertices->GetRendererID(), m_VertexBuffer->GetRendererID(),
+            oldVertexOffset * stride, mesh.Vertices.Offset * stride, mesh.VertexCount * stride);
+        CopyBuffer(oldIndices->GetRendererID(), m_IndexBuffer->GetRendererID(),
+            oldIndexOffset * indexSize, mesh.Indices.Offset * indexSize, mesh.IndexCount * indexSize);
+    }
+}
+
+GpuBufferArena::MeshRange GpuBufferArena::GetRange(GpuMeshHandle handle) const
+{
+    ASSERT(handle < m_Meshes.size() && m_Meshes[handle].Live);
+    const Mesh& mesh = m_Meshes[handle];
+    return { mesh.Indices.Offset, mesh.IndexCount, (int)mesh.Vertices.Offset, mesh.VertexCount };
+}
+
+void GpuBufferArena::AddDraw(IndirectDrawBuffer& commands, GpuMeshHandle handle, unsigned int instanceCount) const
+{
+    MeshRange range = GetRange(handle);
+    commands.AddDraw(range.IndexCount, range.FirstIndex, range.BaseVertex, instanceCount);
+}
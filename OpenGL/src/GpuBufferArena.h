@@ -0,0 +1,75 @@
+#pragma once
+#include <memory>
+#include <vector>
+
+#include "OffsetAllocator.h"
+#include "VertexArray.h"
+#include "IndexBuffer.h"
+#include "VertexBufferLayout.h"
+#include "IndirectDrawBuffer.h"
+
+typedef unsigned int GpuMeshHandle;
+
+/* Shares one big vertex buffer and one big index buffer between many meshes of the same vertex format, so they all
+   draw from a single vertex array without any buffer or vertex array switch in between. Ranges are handed out by
+   OffsetAllocators, in vertices and in indices. Indices stay relative to their mesh, draws add the base vertex, so
+   the index buffer can be 16 bit whatever the arena size as long as each mesh is under 65536 vertices.
+   Meshes are referred to by handles since Defragment() moves them around. */
+class GpuBufferArena {
+public:
+	static const GpuMeshHandle InvalidMesh = 0xFFFFFFFF;
+
+	struct MeshRange {
+		unsigned int FirstIndex;
+		unsigned int IndexCount;
+		int BaseVertex;
+		unsigned int VertexCount;
+	};
+
+private:
+	struct Mesh {
+		OffsetAllocator::Allocation Vertices;
+		OffsetAllocator::Allocation Indices;
+		unsigned int VertexCount;
+		unsigned int IndexCount;
+		bool Live;
+	};
+
+	VertexBufferLayout m_Layout;
+	unsigned int m_MaxVertices;
+	unsigned int m_MaxIndices;
+	unsigned int m_IndexType;
+
+	std::unique_ptr<VertexBuffer> m_VertexBuffer;
+	std::unique_ptr<IndexBuffer> m_IndexBuffer;
+	std::unique_ptr<VertexArray> m_VertexArray;
+
+	OffsetAllocator m_VertexAllocator;
+	OffsetAllocator m_IndexAllocator;
+	std::vector<Mesh> m_Meshes;
+	std::vector<GpuMeshHandle> m_FreeHandles;
+	unsigned int m_MeshCount;
+
+	void CreateBuffers();
+	bool AllocateMesh(Mesh& mesh);
+
+public:
+	GpuBufferArena(const VertexBufferLayout& layout, unsigned int maxVertices, unsigned int maxIndices, unsigned int indexType = GL_UNSIGNED_SHORT);
+
+	GpuMeshHandle Add(const void* vertices, unsigned int vertexCount, const unsigned int* indices, unsigned int indexCount);
+	void Remove(GpuMeshHandle mesh);
+	void Defragment();
+
+	MeshRange GetRange(GpuMeshHandle mesh) const;
+	void AddDraw(IndirectDrawBuffer& commands, GpuMeshHandle mesh, unsigned int instanceCount = 1) const;
+
+	inline const VertexArray& GetVertexArray() const { return *m_VertexArray; }
+	inline const IndexBuffer& GetIndexBuffer() const { return *m_IndexBuffer; }
+	inline const VertexBufferLayout& GetLayout() const { return m_Layout; }
+
+	inline unsigned int GetMeshCount() const { return m_MeshCount; }
+	inline unsigned int GetFreeVertices() const { return m_VertexAllocator.GetFreeSpace(); }
+	inline unsigned int GetFreeIndices() const { return m_IndexAllocator.GetFreeSpace(); }
+	inline unsigned int GetLargestFreeVertexRange() const { return m_VertexAllocator.GetLargestFreeRange(); }
+	inline unsigned int GetLargestFreeIndexRange() const { return m_IndexAllocator.GetLargestFreeRange(); }
+};
@@ -0,0 +1,198 @@
+#include "HeadlessContext.h"
+
+#include <GLFW/glfw3.h>
+#include <iostream>
+
+#ifndef _WIN32
+#include <EGL/egl.h>
+#include <EGL/eglext.h>
+#include <cstring>
+#endif
+
+HeadlessContext::HeadlessContext()
+    : m_Display(nullptr), m_Context(nullptr), m_Surface(nullptr), m_Window(nullptr)
+{
+}
+
+HeadlessContext::~HeadlessContext()
+{
+    Destroy();
+}
+
+bool HeadlessContext::IsCreated() const
+{
+    return m_Context != nullptr || m_Window != nullptr;
+}
+
+#ifdef _WIN32
+
+bool HeadlessContext::Create(int majorVersion, int minorVersion, bool debug)
+{
+    if (!glfwInit())
+        return false;
+
+    glfwWindowHint(GLFW_CONTEXT_VERSION_MAJOR, majorVersion);
+    glfwWindowHint(GLFW_CONTEXT_VERSION_MINOR, minorVersion);
+    glfwWindowHint(GLFW_OPENGL_PROFILE, GLFW_OPENGL_CORE_PROFILE);
+    glfwWindowHint(GLFW_OPENGL_DEBUG_CONTEXT, debug ? GLFW_TRUE : GLFW_FALSE);
+    glfwWindowHint(GLFW_VISIBLE, GLFW_FALSE);
+
+    m_Window = glfwCreateWindow(1, 1, "Headless", NULL, NULL);
+    if (!m_Window)
+    {
+        glfwTerminate();
+        return false;
+    }
+    glfwMakeContextCurrent(m_Window);
+    glfwSwapInterval(0);
+    return true;
+}
+
+void HeadlessContext::Destroy()
+{
+    if (!m_Window)
+        return;
+    glfwDestroyWindow(m_Window);
+    glfwTerminate();
+    m_Window = nullptr;
+}
+
+const char* HeadlessContext::GetBackendName() const
+{
+    return "hidden GLFW window";
+}
+
+#else
+
+static bool HasExtension(const char* extensions, const char* name)
+{
+    if (!extensions)
+        return false;
+    size_t length = strlen(name);
+    for (const char* it = strstr(extensions, name); it; it = strstr(it + length, name))
+    {
+        if ((it == extensions || it[-1] == ' ') && (it[length] == ' ' || it[length] == '\0'))
+            return true;
+    }
+    return false;
+}
+
+/* @brief: Prefers the surfaceless platform, it doesn't need any display server. Falls back to the default display
+*/
+static EGLDisplay OpenDisplay()
+{
+    const char* clientExtensions = eglQueryString(EGL_NO_DISPLAY, EGL_EXTENSIONS);
+    if (HasExtension(clientExtensions, "EGL_MESA_platform_surfaceless"))
+    {
+        PFNEGLGETPLATFORMDISPLAYEXTPROC getPlatformDisplay =
+            (PFNEGLGETPLATFORMDISPLAYEXTPROC)eglGetProcAddress("eglGetPlatformDisplayEXT");
+        if (getPlatformDisplay)
+        {
+            EGLDisplay display = getPlatformDisplay(EGL_PLATFORM_SURFACELESS_MESA, EGL_DEFAULT_DISPLAY, nullptr);
+            if (display != EGL_NO_DISPLAY && eglInitialize(display, nullptr, nullptr))
+                return display;
+        }
+    }
+
+    EGLDisplay display = eglGetDisplay(EGL_DEFAULT_DISPLAY);
+    if (display != EGL_NO_DISPLAY && eglInitialize(display, nullptr, nullptr))
+        return display;
+    return EGL_NO_DISPLAY;
+}
+
+bool HeadlessContext::Create(int majorVersion, int minorVersion, bool debug)
+{
+    EGLDisplay display = OpenDisplay();
+    if (display == EGL_NO_DISPLAY)
+    {
+        std::cout << "[Headless] No EGL display" << std::endl;
+        return false;
+    }
+    m_Display = display;
+
+    if (!eglBindAPI(EGL_OPENGL_API))
+    {
+        std::cout << "[Headless] EGL can't create desktop GL contexts" << std::endl;
+        Destroy();
+        return false;
+    }
+
+    bool surfaceless = HasExtension(eglQueryString(display, EGL_EXTENSIONS), "EGL_KHR_surfaceless_context");
+    const EGLint configAttribs[] = {
+        EGL_SURFACE_TYPE, surfaceless ? 0 : EGL_PBUFFER_BIT,
+        EGL_RENDERABLE_TYPE, EGL_OPENGL_BIT,
+        EGL_RED_SIZE, 8, EGL_GREEN_SIZE, 8, EGL_BLUE_SIZE, 8, EGL_ALPHA_SIZE, 8,
+        EGL_NONE
+    };
+    EGLConfig config;
+    EGLint configCount = 0;
+    if (!eglChooseConfig(display, configAttribs, &config, 1, &configCount) || configCount == 0)
+    {
+        std::cout << "[Headless] No suitable EGL config" << std::endl;
+        Destroy();
+        return false;
+    }
+
+    const EGLint contextAttribs[] = {
+        EGL_CONTEXT_MAJOR_VERSION, majorVersion,
+        EGL_CONTEXT_MINOR_VERSION, minorVersion,
+        EGL_CONTEXT_OPENGL_PROFILE_MASK, EGL_CONTEXT_OPENGL_CORE_PROFILE_BIT,
+        EGL_CONTEXT_OPENGL_DEBUG, debug ? EGL_TRUE : EGL_FALSE,
+        EGL_NONE
+    };
+    m_Context = eglCreateContext(display, config, EGL_NO_CONTEXT, contextAttribs);
+    if (m_Context == EGL_NO_CONTEXT)
+    {
+        m_Context = nullptr;
+        std::cout << "[Headless] Couldn't create a GL " << majorVersion << "." << minorVersion << " core context" << std::endl;
+        Destroy();
+        return false;
+    }
+
+    if (!surfaceless)
+    {
+        const EGLint pbufferAttribs[] = { EGL_WIDTH, 1, EGL_HEIGHT, 1, EGL_NONE };
+        m_Surface = eglCreatePbufferSurface(display, config, pbufferAttribs);
+        if (m_Surface == EGL_NO_SURFACE)
+        {
+            m_Surface = nullptr;
+            std::cout << "[Headless] Couldn't create a pbuffer" << std::endl;
+            Destroy();
+            return false;
+        }
+    }
+
+    EGLSurface surface = m_Surface ? (EGLSurface)m_Surface : EGL_NO_SURFACE;
+    if (!eglMakeCurrent(display, surface, surface, (EGLContext)m_Context))
+    {
+        std::cout << "[Headless] Couldn't make the context current" << std::endl;
+        Destroy();
+        return false;
+    }
+    return true;
+}
+
+void HeadlessContext::Destroy()
+{
+    if (!m_Display)
+        return;
+
+    EGLDisplay display = (EGLDisplay)m_Display;
+    eglMakeCurrent(display, EGL_NO_SURFACE, EGL_NO_SURFACE, EGL_NO_CONTEXT);
+    if (m_Surface)
+        eglDestroySurface(display, (EGLSurface)m_Surface);
+    if (m_Context)
+        eglDestroyContext(display, (EGLContext)m_Context);
+    eglTerminate(display);
+
+    m_Display = nullptr;
+    m_Context = nullptr;
+    m_Surface = nullptr;
+}
+
+const char* HeadlessContext::GetBackendName() const
+{
+    return m_Surface ? "EGL pbuffer" : "EGL surfaceless";
+}
+
+#endif
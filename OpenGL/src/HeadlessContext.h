@@ -0,0 +1,23 @@
+#pragma once
+
+struct GLFWwindow;
+
+/* GL context without a visible window, for automated runs on machines without a display.
+   On Linux it is an EGL context (surfaceless when EGL_MESA_platform_surfaceless or EGL_KHR_surfaceless_context
+   are there, a 1x1 pbuffer otherwise), which works with Mesa llvmpipe and no GPU. On Windows, where EGL
+   isn't available, it falls back to a hidden GLFW window. Either way rendering has to go into a Framebuffer. */
+class HeadlessContext {
+private:
+	void* m_Display;
+	void* m_Context;
+	void* m_Surface;
+	GLFWwindow* m_Window;
+public:
+	HeadlessContext();
+	~HeadlessContext();
+
+	bool Create(int majorVersion, int minorVersion, bool debug);
+	void Destroy();
+	bool IsCreated() const;
+	const char* GetBackendName() const;
+};
@@ -1,28 +1,151 @@
 #include "IndexBuffer.h"
 #include "Renderer.h"
 
-IndexBuffer::IndexBuffer(const unsigned int* data, unsigned int count)
-    : m_Count(count)
+#include <algorithm>
+#include <vector>
+
+template<typename To, typename From>
+static std::vector<To> ConvertIndices(const From* data, unsigned int count)
 {
+    std::vector<To> converted(count);
+    for (unsigned int i = 0; i < count; i++)
+    {
+        converted[i] = (To)data[i];
+        ASSERT(converted[i] == data[i]);
+    }
+    return converted;
+}
 
+IndexBuffer::IndexBuffer(const unsigned int* data, unsigned int count)
+    : m_Count(count), m_Type(GL_UNSIGNED_INT)
+{
     ASSERT(sizeof(unsigned int) == sizeof(GLuint));
 
-    GLCall(glGenBuffers(1, &m_RendererID));
-    GLCall(glBindBuffer(GL_ELEMENT_ARRAY_BUFFER,m_RendererID));
-    GLCall(glBufferData(GL_ELEMENT_ARRAY_BUFFER, count * sizeof(unsigned int), data, GL_STATIC_DRAW));
+    unsigned int maxIndex = count > 0 ? *std::max_element(data, data + count) : 0;
+    if (maxIndex <= 0xFFFF)
+    {
+        m_Type = GL_UNSIGNED_SHORT;
+        Create(ConvertIndices<uint16_t>(data, count).data(), BufferUsage::Static);
+    }
+    else
+        Create(data, BufferUsage::Static);
+}
+
+IndexBuffer::IndexBuffer(const uint16_t* data, unsigned int count)
+    : m_Count(count), m_Type(GL_UNSIGNED_SHORT)
+{
+    Create(data, BufferUsage::Static);
+}
+
+IndexBuffer::IndexBuffer(const uint8_t* data, unsigned int count)
+    : m_Count(count), m_Type(GL_UNSIGNED_BYTE)
+{
+    Create(data, BufferUsage::Static);
+}
+
+/* @brief: Allocates room for count indices of the type meant to be filled through Update, see BufferUsage
+*/
+IndexBuffer::IndexBuffer(unsigned int count, unsigned int type, BufferUsage usage)
+    : m_Count(count), m_Type(type)
+{
+    Create(nullptr, usage);
+}
+
+void IndexBuffer::Create(const void* data, BufferUsage usage)
+{
+    m_RendererID = BufferUploader::CreateBuffer();
+    BufferUploader::Get().Allocate(m_RendererID, m_Storage, m_Count * GetIndexSize(), data, usage);
 }
 
 IndexBuffer::~IndexBuffer()
 {
+    Destroy();
+}
+
+IndexBuffer::IndexBuffer(IndexBuffer&& other) noexcept
+    : m_RendererID(other.m_RendererID), m_Count(other.m_Count), m_Type(other.m_Type), m_Storage(other.m_Storage)
+{
+    other.m_RendererID = 0;
+    other.m_Count = 0;
+    other.m_Storage = BufferStorage();
+}
+
+IndexBuffer& IndexBuffer::operator=(IndexBuffer&& other) noexcept
+{
+    if (this != &other)
+    {
+        Destroy();
+        m_RendererID = other.m_RendererID;
+        m_Count = other.m_Count;
+        m_Type = other.m_Type;
+        m_Storage = other.m_Storage;
+        other.m_RendererID = 0;
+        other.m_Count = 0;
+        other.m_Storage = BufferStorage();
+    }
+    return *this;
+}
+
+void IndexBuffer::Destroy()
+{
+    if (m_RendererID == 0)
+        return;
+    BufferUploader::Get().Release(m_RendererID, m_Storage);
+    GLStateCache::Get().OnBufferDeleted(m_RendererID);
     GLCall(glDeleteBuffers(1, &m_RendererID));
+    m_RendererID = 0;
 }
 
 void IndexBuffer::Bind() const
 {
-    GLCall(glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, m_RendererID));
+    GLStateCache::Get().BindElementBuffer(m_RendererID);
 }
 
 void IndexBuffer::Unbind() const
 {
-    GLCall(glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, 0));
+    GLStateCache::Get().BindElementBuffer(0);
+}
+
+unsigned int IndexBuffer::GetSizeOfType(unsigned int type)
+{
+    switch (type)
+    {
+        case GL_UNSIGNED_INT:   return 4;
+        case GL_UNSIGNED_SHORT: return 2;
+        case GL_UNSIGNED_BYTE:  return 1;
+    }
+    ASSERT(false);
+    return 0;
+}
+
+/* @brief: Overwrites count indices starting at the index offset, converting them when the stored type differs
+*/
+template<typename T>
+void IndexBuffer::UpdateIndices(unsigned int offset, const T* data, unsigned int count)
+{
+    unsigned int size = GetIndexSize();
+    BufferUploader& uploader = BufferUploader::Get();
+    if (sizeof(T) == size)
+        uploader.Update(m_RendererID, m_Storage, offset * size, data, count * size);
+    else if (m_Type == GL_UNSIGNED_INT)
+        uploader.Update(m_RendererID, m_Storage, offset * size, ConvertIndices<uint32_t>(data, count).data(), count * size);
+    else if (m_Type == GL_UNSIGNED_SHORT)
+        uploader.Update(m_RendererID, m_Storage, offset * size, ConvertIndices<uint16_t>(data, count).data(), count * size);
+    else
+        uploader.Update(m_RendererID, m_Storage, offset * size, ConvertIndices<uint8_t>(data, count).data(), count * size);
+}
+
+void IndexBuffer::Update(unsigned int offset, const unsigned int* data, unsigned int count)
+{
+    UpdateIndices(offset, data, count);
+}
+
+void IndexBuffer::Update(unsigned int offset, const uint16_t* data, unsigned int count)
+{
+    UpdateIndices(offset, data, count);
+}
+
+void IndexBuffer::Update(unsigned int offset, const uint8_t* data, unsigned int count)
+{
+    UpdateIndices(offset, data, count);
 }
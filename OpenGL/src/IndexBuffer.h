@@ -1,19 +1,50 @@
 #pragma once
+#include <cstdint>
 
+#include "BufferUploader.h"
+
+/* Indices are stored as GL_UNSIGNED_INT, GL_UNSIGNED_SHORT or GL_UNSIGNED_BYTE and every draw uses the stored type.
+   32 bit indices are narrowed to 16 bit when the biggest one fits, halving the index memory and bandwidth of meshes
+   under 65536 vertices. 8 bit indices are only used when given as such: most hardware has no native 8 bit index
+   fetch and the driver would convert them on every draw. */
 class IndexBuffer {
 
 private:
 	unsigned int m_RendererID;
 	unsigned int m_Count;
+	unsigned int m_Type;
+	BufferStorage m_Storage;
+
+	void Create(const void* data, BufferUsage usage);
+	void Destroy();
+	template<typename T>
+	void UpdateIndices(unsigned int offset, const T* data, unsigned int count);
 
 public:
 	IndexBuffer(const unsigned int* data, unsigned int count);
+	IndexBuffer(const uint16_t* data, unsigned int count);
+	IndexBuffer(const uint8_t* data, unsigned int count);
+	IndexBuffer(unsigned int count, unsigned int type = GL_UNSIGNED_INT, BufferUsage usage = BufferUsage::Dynamic);
 	~IndexBuffer();
+	IndexBuffer(const IndexBuffer&) = delete;
+	IndexBuffer& operator=(const IndexBuffer&) = delete;
+	IndexBuffer(IndexBuffer&& other) noexcept;
+	IndexBuffer& operator=(IndexBuffer&& other) noexcept;
 
 	void Bind() const;
 	void Unbind() const;
 
-	inline unsigned int getCount() const { return m_Count; }
+	//Indices are converted to the stored type, they have to fit in it
+	void Update(unsigned int offset, const unsigned int* data, unsigned int count);
+	void Update(unsigned int offset, const uint16_t* data, unsigned int count);
+	void Update(unsigned int offset, const uint8_t* data, unsigned int count);
 
+	static unsigned int GetSizeOfType(unsigned int type);
 
-};
\ No newline at end of file
+	inline unsigned int getCount() const { return m_Count; }
+	inline unsigned int GetRendererID() const { return m_RendererID; }
+	inline unsigned int GetType() const { return m_Type; }
+	inline unsigned int GetIndexSize() const { return GetSizeOfType(m_Type); }
+	//What glDrawElements takes as indices to start drawing from firstIndex
+	inline const void* GetOffset(unsigned int firstIndex) const { return (const void*)((size_t)firstIndex * GetIndexSize()); }
+};
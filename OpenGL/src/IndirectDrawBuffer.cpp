@@ -0,0 +1,92 @@
+#include "IndirectDrawBuffer.h"
+#include "Renderer.h"
+
+IndirectDrawBuffer::IndirectDrawBuffer()
+    : m_RendererID(0), m_Capacity(0)
+{
+    //Without multi draw indirect the commands are only read on the CPU, there is nothing to upload them to
+    if (IsMultiDrawSupported())
+    {
+        GLCall(glGenBuffers(1, &m_RendererID));
+    }
+}
+
+IndirectDrawBuffer::~IndirectDrawBuffer()
+{
+    Destroy();
+}
+
+IndirectDrawBuffer::IndirectDrawBuffer(IndirectDrawBuffer&& other) noexcept
+    : m_RendererID(other.m_RendererID), m_Capacity(other.m_Capacity), m_Commands(std::move(other.m_Commands))
+{
+    other.m_RendererID = 0;
+    other.m_Capacity = 0;
+}
+
+IndirectDrawBuffer& IndirectDrawBuffer::operator=(IndirectDrawBuffer&& other) noexcept
+{
+    if (this != &other)
+    {
+        Destroy();
+        m_RendererID = other.m_RendererID;
+        m_Capacity = other.m_Capacity;
+        m_Commands = std::move(other.m_Commands);
+        other.m_RendererID = 0;
+        other.m_Capacity = 0;
+    }
+    return *this;
+}
+
+void IndirectDrawBuffer::Destroy()
+{
+    if (m_RendererID == 0)
+        return;
+    GLCall(glDeleteBuffers(1, &m_RendererID));
+    m_RendererID = 0;
+}
+
+/* @brief: glMultiDrawElementsIndirect needs GL 4.3 and the shaders need gl_DrawID (ARB_shader_draw_parameters)
+           to find their per draw data, otherwise the renderer falls back to one glDrawElementsInstancedBaseVertex per command
+*/
+bool IndirectDrawBuffer::IsMultiDrawSupported()
+{
+    return (GLEW_VERSION_4_3 || GLEW_ARB_multi_draw_indirect)
+        && (GLEW_VERSION_4_6 || GLEW_ARB_shader_draw_parameters);
+}
+
+void IndirectDrawBuffer::AddDraw(unsigned int count, unsigned int firstIndex, int baseVertex, unsigned int instanceCount)
+{
+    m_Commands.push_back({ count, instanceCount, firstIndex, baseVertex, 0 });
+}
+
+/* @brief: Copies the commands to the GL buffer. The buffer is reallocated when it's too small, otherwise it's orphaned
+           so the upload never waits on a previous frame still reading it
+*/
+void IndirectDrawBuffer::Upload()
+{
+    if (!m_RendererID)
+        return;
+
+    unsigned int size = GetCount() * sizeof(DrawElementsIndirectCommand);
+    if (GetCount() > m_Capacity)
+        m_Capacity = GetCount();
+
+    Bind();
+    GLCall(glBufferData(GL_DRAW_INDIRECT_BUFFER, m_Capacity * sizeof(DrawElementsIndirectCommand), nullptr, GL_STREAM_DRAW));
+    GLCall(glBufferSubData(GL_DRAW_INDIRECT_BUFFER, 0, size, m_Commands.data()));
+}
+
+void IndirectDrawBuffer::Clear()
+{
+    m_Commands.clear();
+}
+
+void IndirectDrawBuffer::Bind() const
+{
+    GLCall(glBindBuffer(GL_DRAW_INDIRECT_BUFFER, m_RendererID));
+}
+
+void IndirectDrawBuffer::Unbind() const
+{
+    GLCall(glBindBuffer(GL_DRAW_INDIRECT_BUFFER, 0));
+}
@@ -0,0 +1,42 @@
+#pragma once
+#include <vector>
+
+//Matches the layout glMultiDrawElementsIndirect reads from GL_DRAW_INDIRECT_BUFFER
+struct DrawElementsIndirectCommand {
+	unsigned int Count;
+	unsigned int InstanceCount;
+	unsigned int FirstIndex;
+	int BaseVertex;
+	unsigned int BaseInstance;
+};
+
+/* CPU list of indirect draw commands plus the GL_DRAW_INDIRECT_BUFFER they get uploaded to. Every command
+   draws from the same vertex array and index buffer, meshes are told apart by their first index and base vertex. */
+class IndirectDrawBuffer {
+private:
+	unsigned int m_RendererID;
+	unsigned int m_Capacity;
+	std::vector<DrawElementsIndirectCommand> m_Commands;
+
+	void Destroy();
+
+public:
+	IndirectDrawBuffer();
+	~IndirectDrawBuffer();
+	IndirectDrawBuffer(const IndirectDrawBuffer&) = delete;
+	IndirectDrawBuffer& operator=(const IndirectDrawBuffer&) = delete;
+	IndirectDrawBuffer(IndirectDrawBuffer&& other) noexcept;
+	IndirectDrawBuffer& operator=(IndirectDrawBuffer&& other) noexcept;
+
+	static bool IsMultiDrawSupported();
+
+	void AddDraw(unsigned int count, unsigned int firstIndex, int baseVertex, unsigned int instanceCount = 1);
+	void Upload();
+	void Clear();
+
+	void Bind() const;
+	void Unbind() const;
+
+	inline const std::vector<DrawElementsIndirectCommand>& GetCommands() const { return m_Commands; }
+	inline unsigned int GetCount() const { return (unsigned int)m_Commands.size(); }
+};
@@ -0,0 +1,44 @@
+#include "LodMesh.h"
+#include "Renderer.h"
+
+#include <algorithm>
+
+LodMesh::LodMesh(const std::vector<MeshLod>& lods)
+{
+    std::vector<unsigned int> indices;
+    for (const MeshLod& lod : lods)
+    {
+        Lod range = { (unsigned int)indices.size(), (unsigned int)lod.Indices.size(), lod.Error };
+        m_Lods.push_back(range);
+        indices.insert(indices.end(), lod.Indices.begin(), lod.Indices.end());
+    }
+    ASSERT(!indices.empty());
+    m_IndexBuffer.reset(new IndexBuffer(indices.data(), (unsigned int)indices.size()));
+}
+
+/* @brief: Both projections scale y by projection[1][1] (cot(fovy / 2) or 2 / height), only a perspective has
+           -1 in projection[2][3] to divide by the distance
+*/
+LodSelector::LodSelector(const glm::mat4& projection, float viewportHeight, float thresholdPixels)
+    : m_PixelsPerUnit(projection[1][1] * viewportHeight * 0.5f), m_Perspective(projection[2][3] != 0.0f),
+    m_ThresholdPixels(thresholdPixels)
+{
+}
+
+float LodSelector::GetScreenError(float error, float distance) const
+{
+    if (!m_Perspective)
+        return error * m_PixelsPerUnit;
+    //Inside the bounds, the full detail is needed
+    return error * m_PixelsPerUnit / std::max(distance, 1e-4f);
+}
+
+unsigned int LodSelector::Select(const LodMesh& mesh, float distance, float scale) const
+{
+    for (unsigned int lod = mesh.GetLodCount() - 1; lod > 0; lod--)
+    {
+        if (GetScreenError(mesh.GetLod(lod).Error * scale, distance) <= m_ThresholdPixels)
+            return lod;
+    }
+    return 0;
+}
@@ -0,0 +1,52 @@
+#pragma once
+#include <memory>
+#include <vector>
+
+#include "IndexBuffer.h"
+#include "MeshSimplifier.h"
+
+#include "glm/glm.hpp"
+
+/* The index buffers of a LOD chain packed one after the other in a single IndexBuffer, drawn with the VertexArray of
+   the source mesh: switching LOD only changes the index range of the draw. */
+class LodMesh {
+public:
+	struct Lod {
+		unsigned int FirstIndex;
+		unsigned int IndexCount;
+		float Error;
+	};
+
+private:
+	std::vector<Lod> m_Lods;
+	std::unique_ptr<IndexBuffer> m_IndexBuffer;
+
+public:
+	LodMesh(const std::vector<MeshLod>& lods);
+
+	inline unsigned int GetLodCount() const { return (unsigned int)m_Lods.size(); }
+	inline const Lod& GetLod(unsigned int lod) const { return m_Lods[lod]; }
+	inline const IndexBuffer& GetIndexBuffer() const { return *m_IndexBuffer; }
+};
+
+/* Picks the coarsest LOD whose error, projected on screen, stays under a threshold in pixels. Works from the
+   projection matrix: the projected size shrinks with the distance under a perspective, not under an orthographic one. */
+class LodSelector {
+private:
+	//Pixels covered by one unit at distance 1 under a perspective, at any distance under an orthographic projection
+	float m_PixelsPerUnit;
+	bool m_Perspective;
+	float m_ThresholdPixels;
+
+public:
+	LodSelector(const glm::mat4& projection, float viewportHeight, float thresholdPixels = 1.0f);
+
+	float GetScreenError(float error, float distance) const;
+	/* @brief: distance is from the camera to the nearest point of the object's bounds, scale is the model matrix
+	   scale applied to the LOD errors
+	*/
+	unsigned int Select(const LodMesh& mesh, float distance, float scale = 1.0f) const;
+
+	inline void SetThreshold(float pixels) { m_ThresholdPixels = pixels; }
+	inline float GetThreshold() const { return m_ThresholdPixels; }
+};
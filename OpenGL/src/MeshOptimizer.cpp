@@ -0,0 +1,326 @@
+#include "MeshOptimizer.h"
+#include "Renderer.h"
+
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <cstring>
+#include <iostream>
+
+/* FIFO cache emulated with timestamps: the time only moves on a miss, so a vertex is still in the cache while fewer
+   than cacheSize misses happened since it was loaded. Restarting the cache is moving the time past every entry. */
+class VertexCacheTimestamps {
+private:
+    std::vector<unsigned int> m_LoadTime;
+    unsigned int m_Time;
+    unsigned int m_CacheSize;
+
+public:
+    VertexCacheTimestamps(unsigned int vertexCount, unsigned int cacheSize)
+        : m_LoadTime(vertexCount, 0), m_Time(cacheSize + 1), m_CacheSize(cacheSize) {}
+
+    //Returns true on a miss
+    bool Access(unsigned int vertex)
+    {
+        if (m_Time - m_LoadTime[vertex] <= m_CacheSize)
+            return false;
+        m_LoadTime[vertex] = m_Time++;
+        return true;
+    }
+
+    inline void Restart() { m_Time += m_CacheSize + 1; }
+};
+
+VertexCacheStats MeshOptimizer::AnalyzeVertexCache(const unsigned int* indices, unsigned int indexCount, unsigned int vertexCount,
+    unsigned int cacheSize)
+{
+    VertexCacheTimestamps cache(vertexCount, cacheSize);
+    std::vector<bool> referenced(vertexCount, false);
+    unsigned int misses = 0, uniqueVertices = 0;
+    for (unsigned int i = 0; i < indexCount; i++)
+    {
+        misses += cache.Access(indices[i]);
+        if (!referenced[indices[i]])
+        {
+            referenced[indices[i]] = true;
+            uniqueVertices++;
+        }
+    }
+
+    VertexCacheStats stats;
+    stats.Acmr = indexCount ? (float)misses / (indexCount / 3) : 0.0f;
+    stats.Atvr = uniqueVertices ? (float)misses / uniqueVertices : 0.0f;
+    return stats;
+}
+
+/* @brief: Tipsify. Fans out around a vertex, emitting all its remaining triangles, then moves on to the neighbour that
+           is still in the cache and will be evicted the soonest without losing the vertices it needs. Without such a
+           neighbour, it goes back to the most recent vertex that still has triangles left (dead end stack), then to
+           the next one in input order.
+*/
+void MeshOptimizer::OptimizeVertexCache(unsigned int* indices, unsigned int indexCount, unsigned int vertexCount,
+    unsigned int cacheSize)
+{
+    unsigned int triangleCount = indexCount / 3;
+
+    //Triangles of each vertex, as offsets into one array
+    std::vector<unsigned int> liveTriangles(vertexCount, 0);
+    for (unsigned int i = 0; i < indexCount; i++)
+        liveTriangles[indices[i]]++;
+    std::vector<unsigned int> adjacencyOffsets(vertexCount + 1, 0);
+    for (unsigned int v = 0; v < vertexCount; v++)
+        adjacencyOffsets[v + 1] = adjacencyOffsets[v] + liveTriangles[v];
+    std::vector<unsigned int> adjacency(indexCount);
+    std::vector<unsigned int> fill(adjacencyOffsets.begin(), adjacencyOffsets.end() - 1);
+    for (unsigned int t = 0; t < triangleCount; t++)
+    {
+        for (unsigned int k = 0; k < 3; k++)
+            adjacency[fill[indices[t * 3 + k]]++] = t;
+    }
+
+    std::vector<unsigned int> input(indices, indices + indexCount);
+    std::vector<unsigned int> cacheTime(vertexCount, 0);
+    std::vector<bool> emitted(triangleCount, false);
+    std::vector<unsigned int> deadEnds;
+    std::vector<unsigned int> candidates;
+    deadEnds.reserve(indexCount);
+
+    unsigned int time = cacheSize + 1;
+    unsigned int cursor = 0;
+    unsigned int output = 0;
+    int fanning = vertexCount > 0 ? 0 : -1;
+    while (fanning >= 0)
+    {
+        candidates.clear();
+        for (unsigned int a = adjacencyOffsets[fanning]; a < adjacencyOffsets[fanning + 1]; a++)
+        {
+            unsigned int t = adjacency[a];
+            if (emitted[t])
+                continue;
+            emitted[t] = true;
+
+            for (unsigned int k = 0; k < 3; k++)
+            {
+                unsigned int v = input[t * 3 + k];
+                indices[output++] = v;
+                deadEnds.push_back(v);
+                candidates.push_back(v);
+                liveTriangles[v]--;
+                if (time - cacheTime[v] > cacheSize)
+                    cacheTime[v] = time++;
+            }
+        }
+
+        /*Best candidate: in the cache, with all its triangles emittable before it gets evicted, the oldest. Candidates
+          that don't qualify have priority 0 and never win, the dead-end stack picks the next vertex then*/
+        int best = -1, bestPriority = 0;
+        for (unsigned int v : candidates)
+        {
+            if (liveTriangles[v] == 0)
+                continue;
+            int priority = 0;
+            if (time - cacheTime[v] + 2 * liveTriangles[v] <= cacheSize)
+                priority = time - cacheTime[v];
+            if (priority > bestPriority)
+            {
+                best = v;
+                bestPriority = priority;
+            }
+        }
+
+        if (best == -1)
+        {
+            while (!deadEnds.empty() && best == -1)
+            {
+                unsigned int v = deadEnds.back();
+                deadEnds.pop_back();
+                if (liveTriangles[v] > 0)
+                    best = v;
+            }
+            while (best == -1 && cursor < vertexCount)
+            {
+                if (liveTriangles[cursor] > 0)
+                    best = cursor;
+                cursor++;
+            }
+        }
+        fanning = best;
+    }
+    ASSERT(output == triangleCount * 3);
+}
+
+/* @brief: Cuts the triangles in clusters and sorts the clusters by how much they face away from the mesh center.
+           Hard boundaries are where the cache restarts (all 3 vertices of a triangle miss), soft ones cut a hard
+           cluster as soon as its ACMR so far is within threshold of the whole hard cluster's.
+*/
+void MeshOptimizer::OptimizeOverdraw(unsigned int* indices, unsigned int indexCount, const void* vertices, unsigned int vertexCount,
+    unsigned int vertexSize, unsigned int positionOffset, unsigned int cacheSize, float threshold)
+{
+    unsigned int triangleCount = indexCount / 3;
+    if (triangleCount == 0)
+        return;
+
+    const unsigned char* bytes = (const unsigned char*)vertices;
+    auto position = [bytes, vertexSize, positionOffset](unsigned int vertex) {
+        return (const float*)(bytes + (size_t)vertex * vertexSize + positionOffset);
+    };
+
+    std::vector<unsigned int> hardBoundaries;
+    {
+        VertexCacheTimestamps cache(vertexCount, cacheSize);
+        for (unsigned int t = 0; t < triangleCount; t++)
+        {
+            unsigned int misses = cache.Access(indices[t * 3]) + cache.Access(indices[t * 3 + 1]) + cache.Access(indices[t * 3 + 2]);
+            if (t == 0 || misses == 3)
+                hardBoundaries.push_back(t);
+        }
+        hardBoundaries.push_back(triangleCount);
+    }
+
+    std::vector<unsigned int> clusters;
+    {
+        VertexCacheTimestamps cache(vertexCount, cacheSize);
+        for (unsigned int h = 0; h + 1 < hardBoundaries.size(); h++)
+        {
+            unsigned int start = hardBoundaries[h], end = hardBoundaries[h + 1];
+
+            cache.Restart();
+            unsigned int clusterMisses = 0;
+            for (unsigned int i = start * 3; i < end * 3; i++)
+                clusterMisses += cache.Access(indices[i]);
+            float clusterAcmr = (float)clusterMisses / (end - start);
+
+            cache.Restart();
+            clusters.push_back(start);
+            unsigned int misses = 0, clusterStart = start;
+            for (unsigned int t = start; t < end; t++)
+            {
+                misses += cache.Access(indices[t * 3]) + cache.Access(indices[t * 3 + 1]) + cache.Access(indices[t * 3 + 2]);
+                if (t + 1 < end && (float)misses / (t + 1 - clusterStart) <= clusterAcmr * threshold)
+                {
+                    clusters.push_back(t + 1);
+                    clusterStart = t + 1;
+                    misses = 0;
+                    cache.Restart();
+                }
+            }
+        }
+        clusters.push_back(triangleCount);
+    }
+
+    //Area weighted centroid and normal of every cluster, and of the whole mesh
+    unsigned int clusterCount = (unsigned int)clusters.size() - 1;
+    std::vector<float> centroids(clusterCount * 3, 0.0f), normals(clusterCount * 3, 0.0f), areas(clusterCount, 0.0f);
+    float meshCentroid[3] = { 0.0f, 0.0f, 0.0f }, meshArea = 0.0f;
+    for (unsigned int c = 0; c < clusterCount; c++)
+    {
+        for (unsigned int t = clusters[c]; t < clusters[c + 1]; t++)
+        {
+            const float* p0 = position(indices[t * 3]);
+            const float* p1 = position(indices[t * 3 + 1]);
+            const float* p2 = position(indices[t * 3 + 2]);
+            float e1[3] = { p1[0] - p0[0], p1[1] - p0[1], p1[2] - p0[2] };
+            float e2[3] = { p2[0] - p0[0], p2[1] - p0[1], p2[2] - p0[2] };
+            float n[3] = { e1[1] * e2[2] - e1[2] * e2[1], e1[2] * e2[0] - e1[0] * e2[2], e1[0] * e2[1] - e1[1] * e2[0] };
+            float area = std::sqrt(n[0] * n[0] + n[1] * n[1] + n[2] * n[2]);
+            for (unsigned int k = 0; k < 3; k++)
+            {
+                float center = (p0[k] + p1[k] + p2[k]) / 3.0f;
+                centroids[c * 3 + k] += center * area;
+                meshCentroid[k] += center * area;
+                normals[c * 3 + k] += n[k];
+            }
+            areas[c] += area;
+            meshArea += area;
+        }
+    }
+    for (unsigned int k = 0; k < 3; k++)
+        meshCentroid[k] /= meshArea > 0.0f ? meshArea : 1.0f;
+
+    std::vector<float> sortKeys(clusterCount);
+    for (unsigned int c = 0; c < clusterCount; c++)
+    {
+        float* n = &normals[c * 3];
+        float length = std::sqrt(n[0] * n[0] + n[1] * n[1] + n[2] * n[2]);
+        float key = 0.0f;
+        for (unsigned int k = 0; k < 3; k++)
+        {
+            float centroid = areas[c] > 0.0f ? centroids[c * 3 + k] / areas[c] : 0.0f;
+            key += (centroid - meshCentroid[k]) * (length > 0.0f ? n[k] / length : 0.0f);
+        }
+        sortKeys[c] = key;
+    }
+
+    std::vector<unsigned int> order(clusterCount);
+    for (unsigned int c = 0; c < clusterCount; c++)
+        order[c] = c;
+    std::stable_sort(order.begin(), order.end(), [&sortKeys](unsigned int a, unsigned int b) { return sortKeys[a] > sortKeys[b]; });
+
+    std::vector<unsigned int> input(indices, indices + triangleCount * 3);
+    unsigned int output = 0;
+    for (unsigned int c : order)
+    {
+        unsigned int count = (clusters[c + 1] - clusters[c]) * 3;
+        memcpy(indices + output, &input[clusters[c] * 3], count * sizeof(unsigned int));
+        output += count;
+    }
+}
+
+/* @brief: Returns the vertex count left, vertices no index uses are dropped from the end
+*/
+unsigned int MeshOptimizer::OptimizeVertexFetch(void* vertices, unsigned int* indices, unsigned int indexCount, unsigned int vertexCount,
+    unsigned int vertexSize)
+{
+    const unsigned int Unused = 0xFFFFFFFF;
+    std::vector<unsigned int> remap(vertexCount, Unused);
+    unsigned int next = 0;
+    for (unsigned int i = 0; i < indexCount; i++)
+    {
+        unsigned int& target = remap[indices[i]];
+        if (target == Unused)
+            target = next++;
+        indices[i] = target;
+    }
+
+    unsigned char* bytes = (unsigned char*)vertices;
+    std::vector<unsigned char> input(bytes, bytes + (size_t)vertexCount * vertexSize);
+    for (unsigned int v = 0; v < vertexCount; v++)
+    {
+        if (remap[v] != Unused)
+            memcpy(bytes + (size_t)remap[v] * vertexSize, &input[(size_t)v * vertexSize], vertexSize);
+    }
+    return next;
+}
+
+MeshOptimizerReport MeshOptimizer::Optimize(unsigned int* indices, unsigned int indexCount, void* vertices, unsigned int& vertexCount,
+    unsigned int vertexSize, unsigned int positionOffset, unsigned int cacheSize)
+{
+    typedef std::chrono::high_resolution_clock Clock;
+    auto elapsedMs = [](Clock::time_point start) { return std::chrono::duration<double, std::milli>(Clock::now() - start).count(); };
+
+    MeshOptimizerReport report;
+    report.Before = AnalyzeVertexCache(indices, indexCount, vertexCount, cacheSize);
+
+    Clock::time_point start = Clock::now();
+    OptimizeVertexCache(indices, indexCount, vertexCount, cacheSize);
+    report.VertexCacheMs = elapsedMs(start);
+
+    start = Clock::now();
+    OptimizeOverdraw(indices, indexCount, vertices, vertexCount, vertexSize, positionOffset, cacheSize);
+    report.OverdrawMs = elapsedMs(start);
+
+    start = Clock::now();
+    vertexCount = OptimizeVertexFetch(vertices, indices, indexCount, vertexCount, vertexSize);
+    report.VertexFetchMs = elapsedMs(start);
+
+    report.After = AnalyzeVertexCache(indices, indexCount, vertexCount, cacheSize);
+    report.VertexCount = vertexCount;
+    return report;
+}
+
+void MeshOptimizerReport::Print() const
+{
+    std::cout << "  ACMR " << Before.Acmr << " -> " << After.Acmr << ", ATVR " << Before.Atvr << " -> " << After.Atvr << std::endl;
+    std::cout << "  Vertex cache " << VertexCacheMs << " ms, overdraw " << OverdrawMs << " ms, vertex fetch "
+        << VertexFetchMs << " ms, " << VertexCount << " vertices" << std::endl;
+}
@@ -0,0 +1,49 @@
+#pragma once
+#include <vector>
+
+//Post-transform vertex cache efficiency of an index order, simulated with a FIFO cache
+struct VertexCacheStats {
+	//Average cache miss ratio, vertex shader runs per triangle: 3 is the worst, ~0.5 the best on a regular grid
+	float Acmr;
+	//Average transform to vertex ratio, vertex shader runs per referenced vertex: 1 is the best
+	float Atvr;
+};
+
+struct MeshOptimizerReport {
+	VertexCacheStats Before;
+	VertexCacheStats After;
+	double VertexCacheMs;
+	double OverdrawMs;
+	double VertexFetchMs;
+	unsigned int VertexCount;
+
+	void Print() const;
+};
+
+/* CPU pass over the indices and vertices of a triangle list before they go to the VertexBuffer and IndexBuffer:
+     1. OptimizeVertexCache reorders triangles so vertices get reused from the post-transform cache (Tipsify,
+        Sander et al. 2007), linear in the mesh size
+     2. OptimizeOverdraw cuts that order in clusters where the cache starts over, or where the local ACMR stays
+        within a threshold of the cluster's, and sorts the clusters outward facing first so the front of a convex
+        part tends to be drawn before its back
+     3. OptimizeVertexFetch reorders the vertices in the order the indices first use them, so the vertex fetch
+        reads memory sequentially, and drops unreferenced ones
+   Indices are 32 bit here, IndexBuffer narrows them afterwards. */
+class MeshOptimizer {
+public:
+	static const unsigned int DefaultCacheSize = 16;
+
+	static VertexCacheStats AnalyzeVertexCache(const unsigned int* indices, unsigned int indexCount, unsigned int vertexCount,
+		unsigned int cacheSize = DefaultCacheSize);
+
+	static void OptimizeVertexCache(unsigned int* indices, unsigned int indexCount, unsigned int vertexCount,
+		unsigned int cacheSize = DefaultCacheSize);
+	static void OptimizeOverdraw(unsigned int* indices, unsigned int indexCount, const void* vertices, unsigned int vertexCount,
+		unsigned int vertexSize, unsigned int positionOffset, unsigned int cacheSize = DefaultCacheSize, float threshold = 1.05f);
+	static unsigned int OptimizeVertexFetch(void* vertices, unsigned int* indices, unsigned int indexCount, unsigned int vertexCount,
+		unsigned int vertexSize);
+
+	//The three passes in order. Positions are 3 floats at positionOffset of each vertex, vertexCount gets updated
+	static MeshOptimizerReport Optimize(unsigned int* indices, unsigned int indexCount, void* vertices, unsigned int& vertexCount,
+		unsigned int vertexSize, unsigned int positionOffset, unsigned int cacheSize = DefaultCacheSize);
+};
@@ -0,0 +1,417 @@
+#include "MeshSimplifier.h"
+#include "MeshOptimizer.h"
+
+#include <algorithm>
+#include <cfloat>
+#include <cmath>
+#include <cstring>
+
+//Open border planes weigh more than the surface, so the outline of a mesh moves last
+static const double BorderWeight = 10.0;
+
+//Sum of squared distances to weighted planes, as the symmetric 4x4 matrix [A b; b c]
+struct Quadric {
+    double A00, A01, A02, A11, A12, A22;
+    double B0, B1, B2;
+    double C;
+    double Weight;
+};
+
+enum class VertexKind : unsigned char {
+    Manifold,
+    Border,
+    Locked
+};
+
+//Triangles around each welded vertex
+struct TriangleAdjacency {
+    std::vector<unsigned int> Offsets;
+    std::vector<unsigned int> Triangles;
+};
+
+static Quadric MakePlaneQuadric(const double* n, double d, double weight)
+{
+    Quadric q;
+    q.A00 = n[0] * n[0] * weight; q.A01 = n[0] * n[1] * weight; q.A02 = n[0] * n[2] * weight;
+    q.A11 = n[1] * n[1] * weight; q.A12 = n[1] * n[2] * weight; q.A22 = n[2] * n[2] * weight;
+    q.B0 = n[0] * d * weight; q.B1 = n[1] * d * weight; q.B2 = n[2] * d * weight;
+    q.C = d * d * weight;
+    q.Weight = weight;
+    return q;
+}
+
+static void AddQuadric(Quadric& q, const Quadric& other)
+{
+    q.A00 += other.A00; q.A01 += other.A01; q.A02 += other.A02;
+    q.A11 += other.A11; q.A12 += other.A12; q.A22 += other.A22;
+    q.B0 += other.B0; q.B1 += other.B1; q.B2 += other.B2;
+    q.C += other.C;
+    q.Weight += other.Weight;
+}
+
+//Mean squared distance of p to the planes
+static double GetQuadricError(const Quadric& q, const float* p)
+{
+    double x = p[0], y = p[1], z = p[2];
+    double rx = q.A00 * x + q.A01 * y + q.A02 * z;
+    double ry = q.A01 * x + q.A11 * y + q.A12 * z;
+    double rz = q.A02 * x + q.A12 * y + q.A22 * z;
+    double error = rx * x + ry * y + rz * z + 2.0 * (q.B0 * x + q.B1 * y + q.B2 * z) + q.C;
+    return q.Weight > 0.0 ? std::fabs(error) / q.Weight : 0.0;
+}
+
+static void Cross(const double* a, const double* b, double* result)
+{
+    result[0] = a[1] * b[2] - a[2] * b[1];
+    result[1] = a[2] * b[0] - a[0] * b[2];
+    result[2] = a[0] * b[1] - a[1] * b[0];
+}
+
+static void BuildAdjacency(TriangleAdjacency& adjacency, const unsigned int* indices, unsigned int indexCount,
+    const std::vector<unsigned int>& weld)
+{
+    unsigned int vertexCount = (unsigned int)weld.size();
+    adjacency.Offsets.assign(vertexCount + 1, 0);
+    for (unsigned int i = 0; i < indexCount; i++)
+        adjacency.Offsets[weld[indices[i]] + 1]++;
+    for (unsigned int v = 0; v < vertexCount; v++)
+        adjacency.Offsets[v + 1] += adjacency.Offsets[v];
+
+    adjacency.Triangles.resize(indexCount);
+    std::vector<unsigned int> fill(adjacency.Offsets.begin(), adjacency.Offsets.end() - 1);
+    for (unsigned int i = 0; i < indexCount; i++)
+        adjacency.Triangles[fill[weld[indices[i]]]++] = i / 3;
+}
+
+//Triangles sharing the welded vertices a and b, 1 on an open border, 2 inside
+static unsigned int CountSharedTriangles(const TriangleAdjacency& adjacency, const unsigned int* indices,
+    const std::vector<unsigned int>& weld, unsigned int a, unsigned int b)
+{
+    unsigned int count = 0;
+    for (unsigned int i = adjacency.Offsets[a]; i < adjacency.Offsets[a + 1]; i++)
+    {
+        const unsigned int* triangle = indices + adjacency.Triangles[i] * 3;
+        count += weld[triangle[0]] == b || weld[triangle[1]] == b || weld[triangle[2]] == b;
+    }
+    return count;
+}
+
+/* @brief: Moving from onto to must not flip or flatten any triangle left around from, and the triangles that collapse
+           have to all use the same vertex at to's position, otherwise a seam would get torn.
+*/
+static bool CanCollapse(const TriangleAdjacency& adjacency, const unsigned int* indices, const std::vector<unsigned int>& weld,
+    const unsigned char* bytes, unsigned int vertexSize, unsigned int positionOffset, unsigned int from, unsigned int to)
+{
+    unsigned int weldTo = weld[to];
+    const float* target = (const float*)(bytes + (size_t)to * vertexSize + positionOffset);
+    for (unsigned int i = adjacency.Offsets[from]; i < adjacency.Offsets[from + 1]; i++)
+    {
+        const unsigned int* triangle = indices + adjacency.Triangles[i] * 3;
+        bool collapses = false;
+        for (unsigned int k = 0; k < 3; k++)
+        {
+            if (weld[triangle[k]] == weldTo)
+            {
+                if (triangle[k] != to)
+                    return false;
+                collapses = true;
+            }
+        }
+        if (collapses)
+            continue;
+
+        double before[3][3], after[3][3];
+        for (unsigned int k = 0; k < 3; k++)
+        {
+            const float* p = (const float*)(bytes + (size_t)triangle[k] * vertexSize + positionOffset);
+            const float* moved = triangle[k] == from ? target : p;
+            for (unsigned int c = 0; c < 3; c++)
+            {
+                before[k][c] = p[c];
+                after[k][c] = moved[c];
+            }
+        }
+        double e1[3], e2[3], normalBefore[3], normalAfter[3];
+        for (unsigned int c = 0; c < 3; c++)
+        {
+            e1[c] = before[1][c] - before[0][c];
+            e2[c] = before[2][c] - before[0][c];
+        }
+        Cross(e1, e2, normalBefore);
+        for (unsigned int c = 0; c < 3; c++)
+        {
+            e1[c] = after[1][c] - after[0][c];
+            e2[c] = after[2][c] - after[0][c];
+        }
+        Cross(e1, e2, normalAfter);
+        if (normalBefore[0] * normalAfter[0] + normalBefore[1] * normalAfter[1] + normalBefore[2] * normalAfter[2] <= 0.0)
+            return false;
+    }
+    return true;
+}
+
+unsigned int MeshSimplifier::Simplify(unsigned int* destination, const unsigned int* indices, unsigned int indexCount,
+    const void* vertices, unsigned int vertexCount, unsigned int vertexSize, unsigned int positionOffset,
+    unsigned int targetIndexCount, float targetError, float* error,
+    const SimplifyAttribute* attributes, unsigned int attributeCount)
+{
+    const unsigned char* bytes = (const unsigned char*)vertices;
+    auto position = [bytes, vertexSize, positionOffset](unsigned int vertex) {
+        return (const float*)(bytes + (size_t)vertex * vertexSize + positionOffset);
+    };
+
+    //Vertices at the same position are welded to the first of them in position order
+    std::vector<unsigned int> weld(vertexCount), wedgeSize(vertexCount, 0);
+    {
+        auto less = [&position](unsigned int a, unsigned int b) {
+            const float* pa = position(a);
+            const float* pb = position(b);
+            if (pa[0] != pb[0])
+                return pa[0] < pb[0];
+            if (pa[1] != pb[1])
+                return pa[1] < pb[1];
+            return pa[2] < pb[2];
+        };
+        std::vector<unsigned int> order(vertexCount);
+        for (unsigned int v = 0; v < vertexCount; v++)
+            order[v] = v;
+        std::sort(order.begin(), order.end(), less);
+        for (unsigned int i = 0; i < vertexCount;)
+        {
+            unsigned int end = i + 1;
+            while (end < vertexCount && !less(order[i], order[end]))
+                end++;
+            for (unsigned int k = i; k < end; k++)
+                weld[order[k]] = order[i];
+            wedgeSize[order[i]] = end - i;
+            i = end;
+        }
+    }
+
+    TriangleAdjacency adjacency;
+    BuildAdjacency(adjacency, indices, indexCount, weld);
+
+    //Edges used by one triangle are open borders, by more than two non-manifold
+    std::vector<VertexKind> kinds(vertexCount, VertexKind::Locked);
+    std::vector<unsigned int> neighbours;
+    for (unsigned int v = 0; v < vertexCount; v++)
+    {
+        if (weld[v] != v || wedgeSize[v] > 1)
+            continue;
+
+        neighbours.clear();
+        for (unsigned int i = adjacency.Offsets[v]; i < adjacency.Offsets[v + 1]; i++)
+        {
+            const unsigned int* triangle = indices + adjacency.Triangles[i] * 3;
+            for (unsigned int k = 0; k < 3; k++)
+            {
+                if (weld[triangle[k]] != v)
+                    neighbours.push_back(weld[triangle[k]]);
+            }
+        }
+        std::sort(neighbours.begin(), neighbours.end());
+
+        unsigned int borderEdges = 0;
+        bool manifold = true;
+        for (size_t i = 0; i < neighbours.size();)
+        {
+            size_t end = i + 1;
+            while (end < neighbours.size() && neighbours[end] == neighbours[i])
+                end++;
+            borderEdges += end - i == 1;
+            manifold = manifold && end - i <= 2;
+            i = end;
+        }
+        if (manifold && borderEdges == 0)
+            kinds[v] = VertexKind::Manifold;
+        else if (manifold && borderEdges == 2)
+            kinds[v] = VertexKind::Border;
+    }
+
+    std::vector<Quadric> quadrics(vertexCount, Quadric());
+    for (unsigned int t = 0; t < indexCount / 3; t++)
+    {
+        const unsigned int* triangle = indices + t * 3;
+        double p[3][3];
+        for (unsigned int k = 0; k < 3; k++)
+        {
+            for (unsigned int c = 0; c < 3; c++)
+                p[k][c] = position(triangle[k])[c];
+        }
+        double e1[3] = { p[1][0] - p[0][0], p[1][1] - p[0][1], p[1][2] - p[0][2] };
+        double e2[3] = { p[2][0] - p[0][0], p[2][1] - p[0][1], p[2][2] - p[0][2] };
+        double normal[3];
+        Cross(e1, e2, normal);
+        double length = std::sqrt(normal[0] * normal[0] + normal[1] * normal[1] + normal[2] * normal[2]);
+        if (length == 0.0)
+            continue;
+        for (unsigned int c = 0; c < 3; c++)
+            normal[c] /= length;
+
+        Quadric plane = MakePlaneQuadric(normal, -(normal[0] * p[0][0] + normal[1] * p[0][1] + normal[2] * p[0][2]), length * 0.5);
+        for (unsigned int k = 0; k < 3; k++)
+            AddQuadric(quadrics[weld[triangle[k]]], plane);
+
+        //A plane through each border edge, perpendicular to the triangle, keeps the border from moving inward
+        for (unsigned int k = 0; k < 3; k++)
+        {
+            unsigned int a = weld[triangle[k]], b = weld[triangle[(k + 1) % 3]];
+            if (CountSharedTriangles(adjacency, indices, weld, a, b) != 1)
+                continue;
+            const double* pa = p[k];
+            const double* pb = p[(k + 1) % 3];
+            double edge[3] = { pb[0] - pa[0], pb[1] - pa[1], pb[2] - pa[2] };
+            double edgeLengthSquared = edge[0] * edge[0] + edge[1] * edge[1] + edge[2] * edge[2];
+            double borderNormal[3];
+            Cross(edge, normal, borderNormal);
+            double borderLength = std::sqrt(borderNormal[0] * borderNormal[0] + borderNormal[1] * borderNormal[1] + borderNormal[2] * borderNormal[2]);
+            if (borderLength == 0.0)
+                continue;
+            for (unsigned int c = 0; c < 3; c++)
+                borderNormal[c] /= borderLength;
+            Quadric border = MakePlaneQuadric(borderNormal, -(borderNormal[0] * pa[0] + borderNormal[1] * pa[1] + borderNormal[2] * pa[2]),
+                edgeLengthSquared * BorderWeight);
+            AddQuadric(quadrics[a], border);
+            AddQuadric(quadrics[b], border);
+        }
+    }
+
+    auto getAttributeCost = [bytes, vertexSize, attributes, attributeCount](unsigned int a, unsigned int b) {
+        double cost = 0.0;
+        for (unsigned int i = 0; i < attributeCount; i++)
+        {
+            const float* va = (const float*)(bytes + (size_t)a * vertexSize + attributes[i].Offset);
+            const float* vb = (const float*)(bytes + (size_t)b * vertexSize + attributes[i].Offset);
+            for (unsigned int c = 0; c < attributes[i].Count; c++)
+                cost += attributes[i].Weight * (va[c] - vb[c]) * (va[c] - vb[c]);
+        }
+        return cost;
+    };
+
+    struct Collapse {
+        unsigned int From;
+        unsigned int To;
+        double Cost;
+    };
+
+    std::vector<unsigned int> result(indices, indices + indexCount);
+    unsigned int resultCount = indexCount;
+    std::vector<unsigned int> collapseRemap(vertexCount);
+    std::vector<unsigned char> locked(vertexCount), pinned(vertexCount);
+    std::vector<Collapse> collapses;
+    double errorLimit = (double)targetError * targetError;
+    double maxError = 0.0;
+
+    /* Each pass sorts every possible collapse by cost and applies the cheapest ones. A vertex is used by one collapse
+       per pass and the neighbours of a moved vertex stay in place until the next one, so no triangle has two
+       vertices moving at once and the flip checks stay valid */
+    while (resultCount > targetIndexCount)
+    {
+        BuildAdjacency(adjacency, result.data(), resultCount, weld);
+
+        collapses.clear();
+        for (unsigned int i = 0; i < resultCount; i++)
+        {
+            //An inner edge shows up in both directions from its two triangles, one on a border only from one
+            unsigned int a = result[i], b = result[i - i % 3 + (i + 1) % 3];
+            bool border = kinds[a] == VertexKind::Border || kinds[b] == VertexKind::Border;
+            for (unsigned int direction = 0; direction < (border ? 2u : 1u); direction++)
+            {
+                unsigned int from = direction ? b : a, to = direction ? a : b;
+                if (kinds[from] == VertexKind::Locked)
+                    continue;
+                if (kinds[from] == VertexKind::Border && CountSharedTriangles(adjacency, result.data(), weld, from, weld[to]) != 1)
+                    continue;
+
+                Quadric merged = quadrics[from];
+                AddQuadric(merged, quadrics[weld[to]]);
+                Collapse collapse = { from, to, GetQuadricError(merged, position(to)) + getAttributeCost(from, to) };
+                collapses.push_back(collapse);
+            }
+        }
+        std::sort(collapses.begin(), collapses.end(), [](const Collapse& a, const Collapse& b) { return a.Cost < b.Cost; });
+
+        for (unsigned int v = 0; v < vertexCount; v++)
+            collapseRemap[v] = v;
+        std::fill(locked.begin(), locked.end(), 0);
+        std::fill(pinned.begin(), pinned.end(), 0);
+
+        unsigned int triangleCount = resultCount / 3;
+        bool collapsed = false;
+        for (const Collapse& collapse : collapses)
+        {
+            if (triangleCount <= targetIndexCount / 3 || collapse.Cost > errorLimit)
+                break;
+
+            unsigned int weldTo = weld[collapse.To];
+            if (locked[collapse.From] || pinned[collapse.From] || locked[weldTo])
+                continue;
+            if (!CanCollapse(adjacency, result.data(), weld, bytes, vertexSize, positionOffset, collapse.From, collapse.To))
+                continue;
+
+            collapseRemap[collapse.From] = collapse.To;
+            AddQuadric(quadrics[weldTo], quadrics[collapse.From]);
+            maxError = std::max(maxError, collapse.Cost);
+            triangleCount -= CountSharedTriangles(adjacency, result.data(), weld, collapse.From, weldTo);
+            for (unsigned int i = adjacency.Offsets[collapse.From]; i < adjacency.Offsets[collapse.From + 1]; i++)
+            {
+                const unsigned int* triangle = &result[adjacency.Triangles[i] * 3];
+                for (unsigned int k = 0; k < 3; k++)
+                    pinned[weld[triangle[k]]] = 1;
+            }
+            locked[collapse.From] = 1;
+            locked[weldTo] = 1;
+            collapsed = true;
+        }
+        if (!collapsed)
+            break;
+
+        unsigned int write = 0;
+        for (unsigned int i = 0; i < resultCount; i += 3)
+        {
+            unsigned int i0 = collapseRemap[result[i]], i1 = collapseRemap[result[i + 1]], i2 = collapseRemap[result[i + 2]];
+            if (weld[i0] == weld[i1] || weld[i1] == weld[i2] || weld[i0] == weld[i2])
+                continue;
+            result[write++] = i0;
+            result[write++] = i1;
+            result[write++] = i2;
+        }
+        resultCount = write;
+    }
+
+    if (resultCount > 0)
+        memcpy(destination, result.data(), resultCount * sizeof(unsigned int));
+    if (error)
+        *error = (float)std::sqrt(maxError);
+    return resultCount;
+}
+
+std::vector<MeshLod> MeshSimplifier::BuildLodChain(const unsigned int* indices, unsigned int indexCount,
+    const void* vertices, unsigned int vertexCount, unsigned int vertexSize, unsigned int positionOffset,
+    unsigned int maxLods, float ratio, const SimplifyAttribute* attributes, unsigned int attributeCount)
+{
+    std::vector<MeshLod> lods(1);
+    lods[0].Indices.assign(indices, indices + indexCount);
+    lods[0].Error = 0.0f;
+
+    std::vector<unsigned int> simplified(indexCount);
+    while (lods.size() < maxLods)
+    {
+        unsigned int previousCount = (unsigned int)lods.back().Indices.size();
+        unsigned int targetCount = (unsigned int)(previousCount / 3 * ratio) * 3;
+        float error = 0.0f;
+        unsigned int count = Simplify(simplified.data(), indices, indexCount, vertices, vertexCount, vertexSize, positionOffset,
+            targetCount, FLT_MAX, &error, attributes, attributeCount);
+
+        //Locked vertices can keep it far from the target, a LOD that barely differs isn't worth its memory
+        if (count == 0 || count > previousCount - (previousCount - targetCount) / 2)
+            break;
+
+        MeshOptimizer::OptimizeVertexCache(simplified.data(), count, vertexCount);
+        MeshLod lod;
+        lod.Indices.assign(simplified.begin(), simplified.begin() + count);
+        lod.Error = std::max(error, lods.back().Error);
+        lods.push_back(lod);
+    }
+    return lods;
+}
@@ -0,0 +1,40 @@
+#pragma once
+#include <vector>
+
+//Floats at Offset of each vertex whose change is added to the collapse cost, e.g. UVs or normals
+struct SimplifyAttribute {
+	unsigned int Offset;
+	unsigned int Count;
+	//Cost of a unit of difference, in squared position units
+	float Weight;
+};
+
+struct MeshLod {
+	std::vector<unsigned int> Indices;
+	//Distance from the source surface, in position units
+	float Error;
+};
+
+/* Quadric error metric simplification (Garland and Heckbert 1997) by half edge collapses: a vertex is moved onto a
+   neighbour, so every LOD keeps indexing the source vertex buffer and one VertexArray serves all of them.
+   Vertices are welded by position first, the collapse cost is the squared distance of the merged vertex to the planes
+   of the triangles it stands for, plus the weighted attribute change. Open borders only collapse along themselves,
+   attribute seams (a position shared by several vertices) and non-manifold vertices stay in place. */
+class MeshSimplifier {
+public:
+	/* @brief: Writes at most indexCount indices to destination, as few as targetIndexCount, stopping earlier when the next
+	   collapse would go past targetError. Returns the index count written, error gets the error reached.
+	*/
+	static unsigned int Simplify(unsigned int* destination, const unsigned int* indices, unsigned int indexCount,
+		const void* vertices, unsigned int vertexCount, unsigned int vertexSize, unsigned int positionOffset,
+		unsigned int targetIndexCount, float targetError, float* error = nullptr,
+		const SimplifyAttribute* attributes = nullptr, unsigned int attributeCount = 0);
+
+	/* @brief: LOD 0 is the source, every next one has about ratio times the triangles of the previous. Each one is simplified
+	   from the source, so its error is measured against it, and optimized for the vertex cache. The chain stops at
+	   maxLods or when simplifying doesn't remove enough triangles anymore.
+	*/
+	static std::vector<MeshLod> BuildLodChain(const unsigned int* indices, unsigned int indexCount,
+		const void* vertices, unsigned int vertexCount, unsigned int vertexSize, unsigned int positionOffset,
+		unsigned int maxLods, float ratio = 0.5f, const SimplifyAttribute* attributes = nullptr, unsigned int attributeCount = 0);
+};
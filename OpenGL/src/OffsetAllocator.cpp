@@ -0,0 +1,256 @@
+#include "OffsetAllocator.h"
+#include "Renderer.h"
+
+#ifdef _MSC_VER
+#include <intrin.h>
+#endif
+
+static unsigned int LowestBit(unsigned int mask)
+{
+#ifdef _MSC_VER
+    unsigned long index;
+    _BitScanForward(&index, mask);
+    return index;
+#else
+    return __builtin_ctz(mask);
+#endif
+}
+
+static unsigned int HighestBit(unsigned int mask)
+{
+#ifdef _MSC_VER
+    unsigned long index;
+    _BitScanReverse(&index, mask);
+    return index;
+#else
+    return 31 - __builtin_clz(mask);
+#endif
+}
+
+OffsetAllocator::OffsetAllocator(unsigned int size)
+    : m_Size(size)
+{
+    Reset();
+}
+
+/* @brief: Bin whose sizes are all smaller or equal, where a free range of that size goes. Sizes under 8 get a bin each,
+           above the first level is the highest bit and the second level the 3 bits under it.
+*/
+unsigned int OffsetAllocator::BinRoundDown(unsigned int size)
+{
+    if (size < SecondLevelCount)
+        return size;
+    unsigned int highBit = HighestBit(size);
+    unsigned int firstLevel = highBit - SecondLevelBits + 1;
+    unsigned int secondLevel = (size >> (highBit - SecondLevelBits)) & (SecondLevelCount - 1);
+    return firstLevel * SecondLevelCount + secondLevel;
+}
+
+/* @brief: Bin whose sizes are all bigger or equal, any range found from there fits without looking at its size
+*/
+unsigned int OffsetAllocator::BinRoundUp(unsigned int size)
+{
+    unsigned int bin = BinRoundDown(size);
+    if (size >= SecondLevelCount)
+    {
+        unsigned int lowBits = (1u << (HighestBit(size) - SecondLevelBits)) - 1;
+        if (size & lowBits)
+            bin++;
+    }
+    return bin;
+}
+
+unsigned int OffsetAllocator::FindFreeBin(unsigned int minBin) const
+{
+    unsigned int firstLevel = minBin / SecondLevelCount;
+    if (firstLevel >= FirstLevelCount)
+        return Invalid;
+
+    unsigned int secondLevelMask = m_SecondLevelMap[firstLevel] & (0xFFu << (minBin % SecondLevelCount));
+    if (secondLevelMask)
+        return firstLevel * SecondLevelCount + LowestBit(secondLevelMask);
+
+    unsigned int firstLevelMask = firstLevel + 1 < FirstLevelCount ? m_FirstLevelMap & (~0u << (firstLevel + 1)) : 0;
+    if (!firstLevelMask)
+        return Invalid;
+    firstLevel = LowestBit(firstLevelMask);
+    return firstLevel * SecondLevelCount + LowestBit(m_SecondLevelMap[firstLevel]);
+}
+
+/* @brief: Bins above the size's own are rounded up so any of their ranges fits. When they're all empty, a range of the
+           size's own bin may still be big enough, e.g. one of exactly the requested size: it's searched linearly.
+*/
+unsigned int OffsetAllocator::FindFitInBin(unsigned int bin, unsigned int size) const
+{
+    for (unsigned int node = m_BinHeads[bin]; node != Invalid; node = m_Nodes[node].NextFree)
+    {
+        if (m_Nodes[node].Size >= size)
+            return node;
+    }
+    return Invalid;
+}
+
+unsigned int OffsetAllocator::NewNode(unsigned int offset, unsigned int size)
+{
+    unsigned int index;
+    if (!m_UnusedNodes.empty())
+    {
+        index = m_UnusedNodes.back();
+        m_UnusedNodes.pop_back();
+    }
+    else
+    {
+        index = (unsigned int)m_Nodes.size();
+        m_Nodes.push_back(Node());
+    }
+    m_Nodes[index] = { offset, size, Invalid, Invalid, Invalid, Invalid, false };
+    return index;
+}
+
+void OffsetAllocator::InsertFree(unsigned int node)
+{
+    unsigned int bin = BinRoundDown(m_Nodes[node].Size);
+    unsigned int head = m_BinHeads[bin];
+
+    m_Nodes[node].PrevFree = Invalid;
+    m_Nodes[node].NextFree = head;
+    if (head != Invalid)
+        m_Nodes[head].PrevFree = node;
+    m_BinHeads[bin] = node;
+
+    m_SecondLevelMap[bin / SecondLevelCount] |= 1 << (bin % SecondLevelCount);
+    m_FirstLevelMap |= 1u << (bin / SecondLevelCount);
+    m_FreeSpace += m_Nodes[node].Size;
+}
+
+void OffsetAllocator::RemoveFree(unsigned int node)
+{
+    Node& n = m_Nodes[node];
+    unsigned int bin = BinRoundDown(n.Size);
+
+    if (n.PrevFree != Invalid)
+        m_Nodes[n.PrevFree].NextFree = n.NextFree;
+    else
+        m_BinHeads[bin] = n.NextFree;
+    if (n.NextFree != Invalid)
+        m_Nodes[n.NextFree].PrevFree = n.PrevFree;
+
+    if (m_BinHeads[bin] == Invalid)
+    {
+        unsigned int firstLevel = bin / SecondLevelCount;
+        m_SecondLevelMap[firstLevel] &= ~(1 << (bin % SecondLevelCount));
+        if (!m_SecondLevelMap[firstLevel])
+            m_FirstLevelMap &= ~(1u << firstLevel);
+    }
+    m_FreeSpace -= n.Size;
+}
+
+/* @brief: Returns an allocation with an Invalid offset when no free range is big enough
+*/
+OffsetAllocator::Allocation OffsetAllocator::Allocate(unsigned int size)
+{
+    Allocation allocation;
+    if (size == 0)
+        return allocation;
+
+    unsigned int bin = FindFreeBin(BinRoundUp(size));
+    unsigned int node = bin != Invalid ? m_BinHeads[bin] : FindFitInBin(BinRoundDown(size), size);
+    if (node == Invalid)
+        return allocation;
+
+    RemoveFree(node);
+    m_Nodes[node].Used = true;
+
+    //What's left goes back to the free ranges, right after the allocated one
+    unsigned int remainder = m_Nodes[node].Size - size;
+    if (remainder > 0)
+    {
+        unsigned int split = NewNode(m_Nodes[node].Offset + size, remainder);
+        m_Nodes[split].PrevNeighbor = node;
+        m_Nodes[split].NextNeighbor = m_Nodes[node].NextNeighbor;
+        if (m_Nodes[node].NextNeighbor != Invalid)
+            m_Nodes[m_Nodes[node].NextNeighbor].PrevNeighbor = split;
+        m_Nodes[node].NextNeighbor = split;
+        m_Nodes[node].Size = size;
+        InsertFree(split);
+    }
+
+    allocation.Offset = m_Nodes[node].Offset;
+    allocation.Node = node;
+    return allocation;
+}
+
+void OffsetAllocator::Free(const Allocation& allocation)
+{
+    if (allocation.Node == Invalid)
+        return;
+
+    unsigned int node = allocation.Node;
+    ASSERT(m_Nodes[node].Used);
+    m_Nodes[node].Used = false;
+
+    unsigned int prev = m_Nodes[node].PrevNeighbor;
+    if (prev != Invalid && !m_Nodes[prev].Used)
+    {
+        RemoveFree(prev);
+        m_Nodes[node].Offset = m_Nodes[prev].Offset;
+        m_Nodes[node].Size += m_Nodes[prev].Size;
+        m_Nodes[node].PrevNeighbor = m_Nodes[prev].PrevNeighbor;
+        if (m_Nodes[prev].PrevNeighbor != Invalid)
+            m_Nodes[m_Nodes[prev].PrevNeighbor].NextNeighbor = node;
+        m_UnusedNodes.push_back(prev);
+    }
+
+    unsigned int next = m_Nodes[node].NextNeighbor;
+    if (next != Invalid && !m_Nodes[next].Used)
+    {
+        RemoveFree(next);
+        m_Nodes[node].Size += m_Nodes[next].Size;
+        m_Nodes[node].NextNeighbor = m_Nodes[next].NextNeighbor;
+        if (m_Nodes[next].NextNeighbor != Invalid)
+            m_Nodes[m_Nodes[next].NextNeighbor].PrevNeighbor = node;
+        m_UnusedNodes.push_back(next);
+    }
+
+    InsertFree(node);
+}
+
+/* @brief: Forgets every allocation, the whole range is free again
+*/
+void OffsetAllocator::Reset()
+{
+    m_FreeSpace = 0;
+    m_FirstLevelMap = 0;
+    for (unsigned int i = 0; i < FirstLevelCount; i++)
+        m_SecondLevelMap[i] = 0;
+    for (unsigned int i = 0; i < BinCount; i++)
+        m_BinHeads[i] = Invalid;
+    m_Nodes.clear();
+    m_UnusedNodes.clear();
+
+    if (m_Size > 0)
+        InsertFree(NewNode(0, m_Size));
+}
+
+unsigned int OffsetAllocator::GetAllocationSize(const Allocation& allocation) const
+{
+    return allocation.Node == Invalid ? 0 : m_Nodes[allocation.Node].Size;
+}
+
+/* @brief: Size of the biggest free range, what's free in total can't be allocated at once when it's fragmented
+*/
+unsigned int OffsetAllocator::GetLargestFreeRange() const
+{
+    if (!m_FirstLevelMap)
+        return 0;
+
+    unsigned int firstLevel = HighestBit(m_FirstLevelMap);
+    unsigned int bin = firstLevel * SecondLevelCount + HighestBit(m_SecondLevelMap[firstLevel]);
+    unsigned int largest = 0;
+    for (unsigned int node = m_BinHeads[bin]; node != Invalid; node = m_Nodes[node].NextFree)
+    {
+        if (m_Nodes[node].Size > largest)
+            largest = m_Nodes[node].Size;
+    }
+    return largest;
+}
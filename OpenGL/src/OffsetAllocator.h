@@ -0,0 +1,62 @@
+#pragma once
+#include <vector>
+
+/* Two level segregated fit (TLSF) allocator of ranges in [0, size), it never touches the memory itself so it can
+   hand out ranges of GPU buffers. Free ranges are kept in 256 size bins: the first level is the power of two of the
+   size, the second splits it in 8 linear steps. Bitmaps of the non empty bins make finding a fitting range O(1).
+   A range is taken from a bin whose smallest size is at least the requested one, or when there's none from the
+   requested size's own bin if one of its ranges is big enough. The rest is split off, and freeing merges a range with
+   its free neighbours right away. */
+class OffsetAllocator {
+public:
+	static const unsigned int Invalid = 0xFFFFFFFF;
+
+	struct Allocation {
+		unsigned int Offset = Invalid;
+		unsigned int Node = Invalid;
+	};
+
+private:
+	static const unsigned int SecondLevelBits = 3;
+	static const unsigned int SecondLevelCount = 1 << SecondLevelBits;
+	static const unsigned int FirstLevelCount = 32;
+	static const unsigned int BinCount = FirstLevelCount * SecondLevelCount;
+
+	struct Node {
+		unsigned int Offset;
+		unsigned int Size;
+		unsigned int PrevFree;
+		unsigned int NextFree;
+		unsigned int PrevNeighbor;
+		unsigned int NextNeighbor;
+		bool Used;
+	};
+
+	unsigned int m_Size;
+	unsigned int m_FreeSpace;
+	unsigned int m_FirstLevelMap;
+	unsigned char m_SecondLevelMap[FirstLevelCount];
+	unsigned int m_BinHeads[BinCount];
+	std::vector<Node> m_Nodes;
+	std::vector<unsigned int> m_UnusedNodes;
+
+	static unsigned int BinRoundDown(unsigned int size);
+	static unsigned int BinRoundUp(unsigned int size);
+	unsigned int FindFreeBin(unsigned int minBin) const;
+	unsigned int FindFitInBin(unsigned int bin, unsigned int size) const;
+	unsigned int NewNode(unsigned int offset, unsigned int size);
+	void InsertFree(unsigned int node);
+	void RemoveFree(unsigned int node);
+
+public:
+	OffsetAllocator(unsigned int size);
+
+	Allocation Allocate(unsigned int size);
+	void Free(const Allocation& allocation);
+	void Reset();
+
+	unsigned int GetAllocationSize(const Allocation& allocation) const;
+	inline unsigned int GetSize() const { return m_Size; }
+	inline unsigned int GetFreeSpace() const { return m_FreeSpace; }
+	unsigned int GetLargestFreeRange() const;
+};
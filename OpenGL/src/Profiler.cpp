@@ -0,0 +1,283 @@
+#include "Profiler.h"
+#include "Renderer.h"
+
+#include <algorithm>
+#include <fstream>
+#include <functional>
+#include <iomanip>
+#include <iostream>
+#include <thread>
+
+//A capture stops growing past this, a long capture would otherwise eat all the memory
+static const size_t MaxCapturedEvents = 4 * 1024 * 1024;
+
+//std::min takes it by reference
+const unsigned int Profiler::HistorySize;
+
+static unsigned int GetThreadID()
+{
+    return (unsigned int)std::hash<std::thread::id>()(std::this_thread::get_id());
+}
+
+Profiler::Profiler()
+    : m_Enabled(false), m_Capturing(false), m_GpuTimersAvailable(false), m_Frame(0),
+      m_Start(Clock::now()), m_DroppedGpuFrames(0)
+{
+}
+
+Profiler::~Profiler()
+{
+    //The context is usually gone by the time statics are destroyed, the queries go with it
+}
+
+Profiler& Profiler::Get()
+{
+    static Profiler instance;
+    return instance;
+}
+
+/* @brief: Has to be called with the context current, GPU scopes are only recorded when timer queries are supported
+*/
+void Profiler::SetEnabled(bool enabled)
+{
+    m_Enabled = enabled;
+    if (enabled)
+        m_GpuTimersAvailable = GLEW_VERSION_3_3 || GLEW_ARB_timer_query;
+}
+
+double Profiler::GetTimeUs() const
+{
+    return std::chrono::duration<double, std::micro>(Clock::now() - m_Start).count();
+}
+
+void Profiler::BeginFrame()
+{
+    if (!m_Enabled)
+        return;
+
+    GpuFrame& frame = m_GpuFrames[m_Frame % FramesInFlight];
+    if (m_GpuTimersAvailable)
+    {
+        //This slot was last used FramesInFlight frames ago, its results should be there by now
+        CollectGpuFrame(frame);
+
+        GLint64 gpuTime = 0;
+        glGetInteger64v(GL_TIMESTAMP, &gpuTime);
+        frame.GpuToCpuOffsetUs = GetTimeUs() - gpuTime / 1000.0;
+    }
+    frame.QueriesUsed = 0;
+    frame.Scopes.clear();
+}
+
+void Profiler::EndFrame()
+{
+    if (!m_Enabled)
+        return;
+
+    std::lock_guard<std::mutex> lock(m_Mutex);
+    PushHistory(m_CpuHistory);
+    m_Frame++;
+}
+
+/* @brief: Reads the timestamps of a previous frame if the GPU is done with them. If the last query isn't available
+           yet the whole frame is dropped instead of waiting for it.
+*/
+void Profiler::CollectGpuFrame(GpuFrame& frame)
+{
+    if (frame.Scopes.empty())
+        return;
+
+    GLint available = 0;
+    glGetQueryObjectiv(frame.Queries[frame.QueriesUsed - 1], GL_QUERY_RESULT_AVAILABLE, &available);
+    if (!available)
+    {
+        m_DroppedGpuFrames++;
+        return;
+    }
+
+    std::lock_guard<std::mutex> lock(m_Mutex);
+    for (const GpuScope& scope : frame.Scopes)
+    {
+        if (scope.EndQuery == 0)
+            continue;
+
+        GLuint64 begin = 0, end = 0;
+        glGetQueryObjectui64v(scope.BeginQuery, GL_QUERY_RESULT, &begin);
+        glGetQueryObjectui64v(scope.EndQuery, GL_QUERY_RESULT, &end);
+        double durationUs = (end - begin) / 1000.0;
+
+        m_GpuHistory[scope.Name].FrameTotalMs += durationUs / 1000.0;
+        if (m_Capturing && m_Events.size() < MaxCapturedEvents)
+            m_Events.push_back({ scope.Name, begin / 1000.0 + frame.GpuToCpuOffsetUs, durationUs, 0, true });
+    }
+    PushHistory(m_GpuHistory);
+}
+
+void Profiler::PushHistory(std::unordered_map<std::string, History>& histories)
+{
+    for (auto& entry : histories)
+    {
+        History& history = entry.second;
+        history.Samples[history.SampleCount % HistorySize] = history.FrameTotalMs;
+        history.SampleCount++;
+        history.FrameTotalMs = 0.0;
+    }
+}
+
+unsigned int Profiler::AcquireQuery(GpuFrame& frame)
+{
+    if (frame.QueriesUsed == frame.Queries.size())
+    {
+        //Grown in blocks so a frame with many scopes doesn't generate queries one by one
+        size_t oldSize = frame.Queries.size();
+        frame.Queries.resize(oldSize + 64);
+        glGenQueries(64, &frame.Queries[oldSize]);
+    }
+    return frame.Queries[frame.QueriesUsed++];
+}
+
+void Profiler::RecordCpu(const char* name, double startUs, double durationUs)
+{
+    std::lock_guard<std::mutex> lock(m_Mutex);
+    m_CpuHistory[name].FrameTotalMs += durationUs / 1000.0;
+    if (m_Capturing && m_Events.size() < MaxCapturedEvents)
+        m_Events.push_back({ name, startUs, durationUs, GetThreadID(), false });
+}
+
+/* @brief: GPU scopes must be opened and closed on the GL thread. Returns the scope to give back to EndGpu
+*/
+unsigned int Profiler::BeginGpu(const char* name)
+{
+    if (!m_Enabled || !m_GpuTimersAvailable)
+        return 0xFFFFFFFF;
+
+    GpuFrame& frame = m_GpuFrames[m_Frame % FramesInFlight];
+    unsigned int query = AcquireQuery(frame);
+    glQueryCounter(query, GL_TIMESTAMP);
+    frame.Scopes.push_back({ name, query, 0 });
+    return (unsigned int)frame.Scopes.size() - 1;
+}
+
+void Profiler::EndGpu(unsigned int scope)
+{
+    if (scope == 0xFFFFFFFF)
+        return;
+
+    GpuFrame& frame = m_GpuFrames[m_Frame % FramesInFlight];
+    if (scope >= frame.Scopes.size())
+        return;
+
+    unsigned int query = AcquireQuery(frame);
+    glQueryCounter(query, GL_TIMESTAMP);
+    frame.Scopes[scope].EndQuery = query;
+}
+
+void Profiler::StartCapture()
+{
+    std::lock_guard<std::mutex> lock(m_Mutex);
+    m_Events.clear();
+    m_Capturing = true;
+}
+
+/* @brief: Stops the capture and writes its events in the Chrome trace-event format, GPU events go on their own track
+*/
+bool Profiler::WriteChromeTrace(const std::string& path)
+{
+    std::lock_guard<std::mutex> lock(m_Mutex);
+    m_Capturing = false;
+
+    std::ofstream file(path);
+    if (!file)
+        return false;
+
+    file << std::fixed << std::setprecision(3);
+    file << "{\"traceEvents\":[\n";
+    file << "{\"name\":\"thread_name\",\"ph\":\"M\",\"pid\":1,\"tid\":0,\"args\":{\"name\":\"GPU\"}}";
+    for (const Event& event : m_Events)
+    {
+        file << ",\n{\"name\":\"" << event.Name << "\",\"cat\":\"" << (event.Gpu ? "gpu" : "cpu")
+            << "\",\"ph\":\"X\",\"ts\":" << event.StartUs << ",\"dur\":" << event.DurationUs
+            << ",\"pid\":1,\"tid\":" << event.ThreadID << "}";
+    }
+    file << "\n]}\n";
+    m_Events.clear();
+    return true;
+}
+
+template<typename HistoryMap>
+static bool Summarize(const HistoryMap& histories, const std::string& name, Profiler::ScopeSummary& summary)
+{
+    auto it = histories.find(name);
+    if (it == histories.end() || it->second.SampleCount == 0)
+        return false;
+
+    const auto& history = it->second;
+    unsigned int count = std::min(history.SampleCount, Profiler::HistorySize);
+    summary = { 0.0, history.Samples[0], history.Samples[0] };
+    for (unsigned int i = 0; i < count; i++)
+    {
+        summary.AverageMs += history.Samples[i];
+        summary.MinMs = std::min(summary.MinMs, history.Samples[i]);
+        summary.MaxMs = std::max(summary.MaxMs, history.Samples[i]);
+    }
+    summary.AverageMs /= count;
+    return true;
+}
+
+/* @brief: Time spent per frame in a scope over the last HistorySize frames, every call in a frame adds up
+*/
+bool Profiler::GetCpuSummary(const std::string& name, ScopeSummary& summary) const
+{
+    return Summarize(m_CpuHistory, name, summary);
+}
+
+bool Profiler::GetGpuSummary(const std::string& name, ScopeSummary& summary) const
+{
+    return Summarize(m_GpuHistory, name, summary);
+}
+
+void Profiler::PrintHistory(const char* title, const std::unordered_map<std::string, History>& histories)
+{
+    for (const auto& entry : histories)
+    {
+        ScopeSummary summary;
+        if (!Summarize(histories, entry.first, summary))
+            continue;
+        std::cout << title << " " << std::left << std::setw(24) << entry.first << std::right << std::fixed
+            << std::setprecision(3) << " avg " << summary.AverageMs << " ms, min " << summary.MinMs
+            << " ms, max " << summary.MaxMs << " ms" << std::endl;
+    }
+}
+
+void Profiler::PrintSummary() const
+{
+    PrintHistory("[CPU]", m_CpuHistory);
+    PrintHistory("[GPU]", m_GpuHistory);
+    if (m_DroppedGpuFrames)
+        std::cout << m_DroppedGpuFrames << " GPU frames dropped, their queries weren't ready" << std::endl;
+}
+
+ProfileScope::ProfileScope(const char* name)
+    : m_Name(name), m_StartUs(-1.0)
+{
+    if (Profiler::Get().IsEnabled())
+        m_StartUs = Profiler::Get().GetTimeUs();
+}
+
+ProfileScope::~ProfileScope()
+{
+    if (m_StartUs < 0.0)
+        return;
+    Profiler& profiler = Profiler::Get();
+    profiler.RecordCpu(m_Name, m_StartUs, profiler.GetTimeUs() - m_StartUs);
+}
+
+GpuProfileScope::GpuProfileScope(const char* name)
+    : m_Scope(Profiler::Get().BeginGpu(name))
+{
+}
+
+GpuProfileScope::~GpuProfileScope()
+{
+    Profiler::Get().EndGpu(m_Scope);
+}
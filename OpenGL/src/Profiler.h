@@ -0,0 +1,121 @@
+#pragma once
+#include <chrono>
+#include <mutex>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+/* CPU and GPU frame profiler.
+   CPU scopes are timed with a high resolution clock. GPU scopes write a GL_TIMESTAMP query at their beginning and
+   end (timestamps nest, unlike GL_TIME_ELAPSED queries). Queries are pooled per frame in flight and a frame's
+   results are only read FramesInFlight frames later, once the GPU is done with them, so reading never stalls.
+   Results feed a rolling per-scope summary and, while capturing, a Chrome trace-event JSON (chrome://tracing). */
+class Profiler {
+public:
+	static const unsigned int FramesInFlight = 2;
+	static const unsigned int HistorySize = 120;
+
+	struct ScopeSummary {
+		double AverageMs;
+		double MinMs;
+		double MaxMs;
+	};
+
+private:
+	typedef std::chrono::high_resolution_clock Clock;
+
+	struct Event {
+		const char* Name;
+		double StartUs;
+		double DurationUs;
+		unsigned int ThreadID;
+		bool Gpu;
+	};
+
+	struct History {
+		double FrameTotalMs = 0.0;
+		double Samples[HistorySize] = {};
+		unsigned int SampleCount = 0;
+	};
+
+	struct GpuScope {
+		const char* Name;
+		unsigned int BeginQuery;
+		unsigned int EndQuery;
+	};
+
+	struct GpuFrame {
+		std::vector<unsigned int> Queries;
+		unsigned int QueriesUsed = 0;
+		std::vector<GpuScope> Scopes;
+		//CPU time minus GPU time when the frame started, to put GPU events on the CPU timeline
+		double GpuToCpuOffsetUs = 0.0;
+	};
+
+	bool m_Enabled;
+	bool m_Capturing;
+	bool m_GpuTimersAvailable;
+	unsigned int m_Frame;
+	Clock::time_point m_Start;
+
+	std::mutex m_Mutex;
+	std::vector<Event> m_Events;
+	std::unordered_map<std::string, History> m_CpuHistory;
+	std::unordered_map<std::string, History> m_GpuHistory;
+
+	GpuFrame m_GpuFrames[FramesInFlight];
+	unsigned int m_DroppedGpuFrames;
+
+	Profiler();
+	unsigned int AcquireQuery(GpuFrame& frame);
+	void CollectGpuFrame(GpuFrame& frame);
+	static void PushHistory(std::unordered_map<std::string, History>& histories);
+	static void PrintHistory(const char* title, const std::unordered_map<std::string, History>& histories);
+
+public:
+	~Profiler();
+	static Profiler& Get();
+
+	void SetEnabled(bool enabled);
+	inline bool IsEnabled() const { return m_Enabled; }
+
+	void BeginFrame();
+	void EndFrame();
+
+	double GetTimeUs() const;
+	void RecordCpu(const char* name, double startUs, double durationUs);
+	unsigned int BeginGpu(const char* name);
+	void EndGpu(unsigned int scope);
+
+	void StartCapture();
+	bool WriteChromeTrace(const std::string& path);
+
+	bool GetCpuSummary(const std::string& name, ScopeSummary& summary) const;
+	bool GetGpuSummary(const std::string& name, ScopeSummary& summary) const;
+	void PrintSummary() const;
+
+	inline unsigned int GetDroppedGpuFrames() const { return m_DroppedGpuFrames; }
+};
+
+class ProfileScope {
+private:
+	const char* m_Name;
+	double m_StartUs;
+public:
+	ProfileScope(const char* name);
+	~ProfileScope();
+};
+
+class GpuProfileScope {
+private:
+	unsigned int m_Scope;
+public:
+	GpuProfileScope(const char* name);
+	~GpuProfileScope();
+};
+
+//The built-in scopes are in every build, they only cost a check of Profiler::IsEnabled until it is enabled
+#define PROFILE_CONCAT_INNER(a, b) a##b
+#define PROFILE_CONCAT(a, b) PROFILE_CONCAT_INNER(a, b)
+#define PROFILE_SCOPE(name) ProfileScope PROFILE_CONCAT(profileScope, __LINE__)(name)
+#define PROFILE_GPU_SCOPE(name) GpuProfileScope PROFILE_CONCAT(gpuProfileScope, __LINE__)(name)
@@ -1,4 +1,8 @@
 #include "Renderer.h"
+#include "Texture.h"
+#include "GpuBufferArena.h"
+#include "LodMesh.h"
+#include "VertexFormatCache.h"
 #include <iostream>
 
 void GLClearError() {
@@ -17,15 +21,203 @@ bool GLLogCall(const char* function, const char* file, int line) {
 
 void Renderer::Clear() const
 {
+    PROFILE_SCOPE("Renderer::Clear");
+    PROFILE_GPU_SCOPE("Renderer::Clear");
     GLCall(glClear(GL_COLOR_BUFFER_BIT));
 }
 
+/* @brief: Binds shader, or the fallback shader when it isn't ready. Returns false when the draw has to be skipped
+*/
+bool Renderer::BindShader(const Shader& shader) const
+{
+    if (shader.IsReady())
+    {
+        shader.Bind();
+        return true;
+    }
+    if (m_FallbackShader && m_FallbackShader->IsReady())
+    {
+        m_FallbackShader->Bind();
+        shader.ApplyDeferredUniforms(*m_FallbackShader);
+        m_FallbackDraws++;
+        return true;
+    }
+    m_SkippedDraws++;
+    return false;
+}
+
 void Renderer::Draw(const VertexArray& va, const IndexBuffer& ib, const Shader& shader) const
 {
+    PROFILE_SCOPE("Renderer::Draw");
+    PROFILE_GPU_SCOPE("Renderer::Draw");
+
+    if (!BindShader(shader))
+        return;
+    va.Bind();
+    ib.Bind();
+    GLCall(glDrawElements(GL_TRIANGLES, ib.getCount(), ib.GetType(), nullptr));
+
+}
+
+/* @brief: Same as Draw but only uses the first count indices of the index buffer, which lets a partially filled batch reuse a shared index buffer
+*/
+void Renderer::Draw(const VertexArray& va, const IndexBuffer& ib, const Shader& shader, unsigned int count) const
+{
+    PROFILE_SCOPE("Renderer::Draw");
+    PROFILE_GPU_SCOPE("Renderer::Draw");
+    if (!BindShader(shader))
+        return;
+    va.Bind();
+    ib.Bind();
+    GLCall(glDrawElements(GL_TRIANGLES, count, ib.GetType(), nullptr));
+}
+
+/* @brief: Draws count indices from firstIndex on, offset by baseVertex. E.g. to draw vertices written at an offset of a
+           StreamingVertexBuffer, or one mesh of a GpuBufferArena
+*/
+void Renderer::Draw(const VertexArray& va, const IndexBuffer& ib, const Shader& shader, unsigned int count, int baseVertex, unsigned int firstIndex) const
+{
+    PROFILE_SCOPE("Renderer::Draw");
+    PROFILE_GPU_SCOPE("Renderer::Draw");
+    if (!BindShader(shader))
+        return;
+    va.Bind();
+    ib.Bind();
+    GLCall(glDrawElementsBaseVertex(GL_TRIANGLES, count, ib.GetType(), (void*)ib.GetOffset(firstIndex), baseVertex));
+}
+
+/* @brief: Meshes of the same arena share their vertex array and buffers, drawing one after the other binds nothing
+*/
+void Renderer::Draw(const GpuBufferArena& arena, unsigned int mesh, const Shader& shader) const
+{
+    GpuBufferArena::MeshRange range = arena.GetRange(mesh);
+    Draw(arena.GetVertexArray(), arena.GetIndexBuffer(), shader, range.IndexCount, range.BaseVertex, range.FirstIndex);
+}
+
+/* @brief: va is the vertex array of the mesh the LOD chain was built from
+*/
+void Renderer::Draw(const VertexArray& va, const LodMesh& mesh, unsigned int lod, const Shader& shader) const
+{
+    const LodMesh::Lod& range = mesh.GetLod(lod);
+    Draw(va, mesh.GetIndexBuffer(), shader, range.IndexCount, 0, range.FirstIndex);
+}
+
+/* @brief: Draws vb through the shared vertex array of its format (see VertexFormatCache) instead of a vertex array of its own
+*/
+void Renderer::Draw(const VertexFormat& format, const VertexBuffer& vb, const IndexBuffer& ib, const Shader& shader) const
+{
+    PROFILE_SCOPE("Renderer::Draw");
+    PROFILE_GPU_SCOPE("Renderer::Draw");
+    if (!BindShader(shader))
+        return;
+    VertexFormatCache::Get().Bind(format, vb);
+    ib.Bind();
+    GLCall(glDrawElements(GL_TRIANGLES, ib.getCount(), ib.GetType(), nullptr));
+}
+
+/* @brief: Draws instanceCount copies of the geometry in a single call, per-instance data comes from the instanced
+           elements of the vertex array (see VertexBufferLayout::PushInstanced)
+*/
+void Renderer::DrawInstanced(const VertexArray& va, const IndexBuffer& ib, const Shader& shader, unsigned int instanceCount) const
+{
+    PROFILE_SCOPE("Renderer::DrawInstanced");
+    PROFILE_GPU_SCOPE("Renderer::DrawInstanced");
+    if (!BindShader(shader))
+        return;
+    va.Bind();
+    ib.Bind();
+    GLCall(glDrawElementsInstanced(GL_TRIANGLES, ib.getCount(), ib.GetType(), nullptr, instanceCount));
+}
 
+/* @brief: Issues every command of the buffer (already uploaded) with a single glMultiDrawElementsIndirect.
+           Shaders find their per draw data with gl_DrawID + u_DrawID (see MultiDraw.shader): u_DrawID is 0 here,
+           while the fallback loop sets it to the index of each command since gl_DrawID is then always 0.
+*/
+void Renderer::DrawIndirect(const VertexArray& va, const IndexBuffer& ib, Shader& shader, const IndirectDrawBuffer& commands) const
+{
+    if (!shader.IsReady())
+    {
+        m_SkippedDraws++;
+        return;
+    }
     shader.Bind();
     va.Bind();
     ib.Bind();
-    GLCall(glDrawElements(GL_TRIANGLES, ib.getCount(), GL_UNSIGNED_INT, nullptr));
 
+    static constexpr UniformName s_DrawID("u_DrawID");
+    int drawIdLocation = shader.GetUniformLocation(shader.GetUniformHandle(s_DrawID));
+    if (IndirectDrawBuffer::IsMultiDrawSupported())
+    {
+        GLCall(glUniform1i(drawIdLocation, 0));
+        commands.Bind();
+        GLCall(glMultiDrawElementsIndirect(GL_TRIANGLES, ib.GetType(), nullptr, commands.GetCount(), 0));
+        commands.Unbind();
+        return;
+    }
+
+    const std::vector<DrawElementsIndirectCommand>& list = commands.GetCommands();
+    for (unsigned int i = 0; i < list.size(); i++)
+    {
+        const DrawElementsIndirectCommand& command = list[i];
+        //Like glMultiDrawElementsIndirect, a command without instances draws nothing
+        if (command.InstanceCount == 0)
+            continue;
+        GLCall(glUniform1i(drawIdLocation, i));
+        GLCall(glDrawElementsInstancedBaseVertex(GL_TRIANGLES, command.Count, ib.GetType(),
+            (void*)ib.GetOffset(command.FirstIndex), command.InstanceCount, command.BaseVertex));
+    }
+}
+
+/* @brief: Records the draw instead of issuing it. Textures are bound to units 0, 1, ... in the given order and the
+           uniforms are copied, so the blob can be reused right away. Nothing reaches GL before Flush.
+*/
+void Renderer::Submit(const VertexArray& va, const IndexBuffer& ib, const Shader& shader, unsigned int layer, float depth,
+    std::initializer_list<const Texture*> textures, const UniformBlob* uniforms)
+{
+    ASSERT(textures.size() <= DrawItem::MaxTextures);
+    //The uniform locations of the blob belong to shader, the fallback can't take them
+    if (!shader.IsReady())
+    {
+        m_SkippedDraws++;
+        return;
+    }
+
+    DrawItem item = {};
+    item.Program = shader.GetRendererID();
+    item.VertexArray = va.GetRendererID();
+    item.IndexBuffer = ib.GetRendererID();
+    item.IndexCount = ib.getCount();
+    item.IndexType = ib.GetType();
+
+    unsigned int unit = 0;
+    for (const Texture* texture : textures)
+        item.Textures[unit++] = texture ? texture->GetRendererID() : 0;
+
+    item.SortKey = DrawQueue::MakeSortKey(layer, item.Program, item.Textures[0], depth);
+    m_DrawQueue.Submit(item, uniforms);
+}
+
+/* @brief: Sorts everything submitted since the last flush by key and draws it
+*/
+void Renderer::Flush()
+{
+    m_DrawQueue.Sort();
+    m_DrawQueue.Execute();
+    m_DrawQueue.Clear();
+}
+
+/* @brief: Replays recorded commands on the GL context, this has to be called from the thread owning it
+*/
+void Renderer::Execute(const CommandBuffer& commands) const
+{
+    GLCommandBackend backend;
+    commands.Replay(backend);
+    m_SkippedDraws += backend.GetSkippedDraws();
+}
+
+void Renderer::Execute(const ParallelCommandRecorder& recorder) const
+{
+    GLCommandBackend backend;
+    recorder.Replay(backend);
+    m_SkippedDraws += backend.GetSkippedDraws();
 }
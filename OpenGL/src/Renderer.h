@@ -1,18 +1,34 @@
 #pragma once
 #include <GL/glew.h>
+#include "GLDebug.h"
+#include "GLDirectStateAccess.h"
+#include "GLTrace.h"
+#include "Profiler.h"
 
 #include "VertexArray.h"
 #include "IndexBuffer.h"
 #include "Shader.h"
+#include "GLStateCache.h"
+#include "DrawQueue.h"
+#include "CommandBuffer.h"
+#include "IndirectDrawBuffer.h"
+
+#include <initializer_list>
 
 #ifdef OGL_DEBUG == 1
+#ifndef _MSC_VER
+#define __debugbreak() __builtin_trap()
+#endif
 #define LOG(x) std::cout << x << std::endl
 #define ASSERT(y) if (!(y)) __debugbreak();
-#define GLCall(x) GLClearError();\
+//With debug output active, the glGetError round trips are skipped and only the call site breadcrumb is left
+#define GLCall(x) GLSetCallSite(#x, __FILE__, __LINE__);\
+        if (!GLDebugOutputActive()) GLClearError();\
         x;\
-        ASSERT(GLLogCall(#x, __FILE__, __LINE__ ))
+        if (!GLDebugOutputActive()) ASSERT(GLLogCall(#x, __FILE__, __LINE__ ))
 #elif defined(OGL_RELEASE)
 #define GLCall(x) x
+#define ASSERT(y)
 #define LOG(x)
 #else
 #define LOG(x)
@@ -23,12 +39,48 @@ void AdjustIncrement(float& increment, float component);
 void GLClearError();
 bool GLLogCall(const char* function, const char* file, int line);
 
+class Texture;
+class GpuBufferArena;
+class LodMesh;
+class VertexFormat;
+class VertexBuffer;
+
 class Renderer {
 
 private:
+    DrawQueue m_DrawQueue;
+    const Shader* m_FallbackShader = nullptr;
+    mutable unsigned int m_FallbackDraws = 0;
+    mutable unsigned int m_SkippedDraws = 0;
+
+    bool BindShader(const Shader& shader) const;
+
 public:
     void Clear() const;
     void Draw(const VertexArray& va, const IndexBuffer& ib, const Shader& shader) const; 
+    void Draw(const VertexArray& va, const IndexBuffer& ib, const Shader& shader, unsigned int count) const;
+    void Draw(const VertexArray& va, const IndexBuffer& ib, const Shader& shader, unsigned int count, int baseVertex, unsigned int firstIndex = 0) const;
+    void Draw(const GpuBufferArena& arena, unsigned int mesh, const Shader& shader) const;
+    void Draw(const VertexArray& va, const LodMesh& mesh, unsigned int lod, const Shader& shader) const;
+    void Draw(const VertexFormat& format, const VertexBuffer& vb, const IndexBuffer& ib, const Shader& shader) const;
+    void DrawInstanced(const VertexArray& va, const IndexBuffer& ib, const Shader& shader, unsigned int instanceCount) const;
+    void DrawIndirect(const VertexArray& va, const IndexBuffer& ib, Shader& shader, const IndirectDrawBuffer& commands) const;
+
+    void Submit(const VertexArray& va, const IndexBuffer& ib, const Shader& shader, unsigned int layer, float depth,
+        std::initializer_list<const Texture*> textures = {}, const UniformBlob* uniforms = nullptr);
+    void Flush();
+
+    void Execute(const CommandBuffer& commands) const;
+    void Execute(const ParallelCommandRecorder& recorder) const;
 
+    /* Used by the Draw calls in place of a shader that isn't ready (still compiling in a ShaderCompileQueue, or failed).
+       The uniforms set on the pending shader are also set on the fallback when it has them with the same name and
+       type, the others keep the fallback's own values. Without one those draws are skipped. DrawIndirect sets
+       uniforms of its shader, Submit records uniform locations of its shader and Execute replays command buffers:
+       they always skip the draws of a shader that isn't ready. */
+    inline void SetFallbackShader(const Shader* shader) { m_FallbackShader = shader; }
+    inline unsigned int GetFallbackDraws() const { return m_FallbackDraws; }
+    inline unsigned int GetSkippedDraws() const { return m_SkippedDraws; }
+    inline void ResetDrawCounters() { m_FallbackDraws = 0; m_SkippedDraws = 0; }
 
 };
\ No newline at end of file
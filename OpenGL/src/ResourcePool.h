@@ -0,0 +1,120 @@
+#pragma once
+#include <cstdint>
+#include <utility>
+#include <vector>
+
+#include "Renderer.h"
+
+/* Owns move-only GL objects (VertexBuffer, Texture, Shader...) in one contiguous array and refers to them by 32 bit
+   handles: the slot index in the low 20 bits and the slot generation in the high 12. Destroying bumps the
+   generation, so an old handle to a reused slot is rejected instead of reaching the new object.
+   Objects stay packed: destroying moves the last one into the hole, a slot table maps handles to the current
+   position. Create and Destroy are O(1). The GL objects of destroyed entries are only deleted at EndFrame, so
+   commands recorded earlier in the frame can still use their ids. */
+template<typename T>
+class ResourcePool {
+public:
+	struct Handle {
+		uint32_t Value;
+
+		inline bool operator==(const Handle& other) const { return Value == other.Value; }
+		inline bool operator!=(const Handle& other) const { return Value != other.Value; }
+	};
+
+	static const uint32_t IndexBits = 20;
+	static const uint32_t MaxObjects = (1u << IndexBits) - 1;
+	static const uint32_t GenerationMask = 0xFFF;
+	//Generations start at 1, so the null handle is never valid
+	static Handle InvalidHandle() { return Handle{ 0 }; }
+
+private:
+	static const uint32_t NoSlot = MaxObjects;
+
+	struct Slot {
+		//Position in m_Objects while used, next free slot while free
+		uint32_t Dense;
+		uint32_t Generation;
+	};
+
+	std::vector<T> m_Objects;
+	std::vector<uint32_t> m_ObjectSlots;
+	std::vector<Slot> m_Slots;
+	uint32_t m_FreeSlot;
+	std::vector<T> m_PendingDestroy;
+
+	inline static uint32_t GetIndex(Handle handle) { return handle.Value & MaxObjects; }
+	inline static uint32_t GetGeneration(Handle handle) { return handle.Value >> IndexBits; }
+
+public:
+	ResourcePool()
+		: m_FreeSlot(NoSlot) {}
+
+	template<typename... Args>
+	Handle Create(Args&&... args)
+	{
+		uint32_t slot = m_FreeSlot;
+		if (slot != NoSlot)
+			m_FreeSlot = m_Slots[slot].Dense;
+		else
+		{
+			ASSERT(m_Slots.size() < MaxObjects);
+			slot = (uint32_t)m_Slots.size();
+			m_Slots.push_back(Slot{ 0, 1 });
+		}
+
+		m_Slots[slot].Dense = (uint32_t)m_Objects.size();
+		m_Objects.emplace_back(std::forward<Args>(args)...);
+		m_ObjectSlots.push_back(slot);
+		return Handle{ (m_Slots[slot].Generation << IndexBits) | slot };
+	}
+
+	/* @brief: Returns false for a stale or invalid handle. The object leaves the pool right away, its GL object is deleted
+	   at the next EndFrame.
+	*/
+	bool Destroy(Handle handle)
+	{
+		if (!IsValid(handle))
+			return false;
+
+		uint32_t slot = GetIndex(handle);
+		uint32_t dense = m_Slots[slot].Dense;
+		uint32_t last = (uint32_t)m_Objects.size() - 1;
+		m_PendingDestroy.push_back(std::move(m_Objects[dense]));
+		if (dense != last)
+		{
+			m_Objects[dense] = std::move(m_Objects[last]);
+			m_ObjectSlots[dense] = m_ObjectSlots[last];
+			m_Slots[m_ObjectSlots[dense]].Dense = dense;
+		}
+		m_Objects.pop_back();
+		m_ObjectSlots.pop_back();
+
+		uint32_t generation = (m_Slots[slot].Generation + 1) & GenerationMask;
+		m_Slots[slot].Generation = generation ? generation : 1;
+		m_Slots[slot].Dense = m_FreeSlot;
+		m_FreeSlot = slot;
+		return true;
+	}
+
+	inline bool IsValid(Handle handle) const
+	{
+		uint32_t slot = GetIndex(handle);
+		return slot < m_Slots.size() && m_Slots[slot].Generation == GetGeneration(handle);
+	}
+
+	//nullptr for a stale handle. The pointer is only good until the next Create or Destroy, they move objects
+	inline T* Get(Handle handle) { return IsValid(handle) ? &m_Objects[m_Slots[GetIndex(handle)].Dense] : nullptr; }
+	inline const T* Get(Handle handle) const { return IsValid(handle) ? &m_Objects[m_Slots[GetIndex(handle)].Dense] : nullptr; }
+
+	//Deletes the GL objects destroyed during the frame
+	void EndFrame() { m_PendingDestroy.clear(); }
+
+	inline unsigned int GetCount() const { return (unsigned int)m_Objects.size(); }
+	inline unsigned int GetPendingDestroyCount() const { return (unsigned int)m_PendingDestroy.size(); }
+
+	//Live objects in no particular order, for passes over all of them
+	inline typename std::vector<T>::iterator begin() { return m_Objects.begin(); }
+	inline typename std::vector<T>::iterator end() { return m_Objects.end(); }
+	inline typename std::vector<T>::const_iterator begin() const { return m_Objects.begin(); }
+	inline typename std::vector<T>::const_iterator end() const { return m_Objects.end(); }
+};
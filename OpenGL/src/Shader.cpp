@@ -1,5 +1,8 @@
 #include "Shader.h"
 #include "Renderer.h"
+#include "ShaderBinaryCache.h"
+#include "ShaderCompileQueue.h"
+#include "UniformBuffer.h"
 
 #include <fstream>
 #include <sstream>
@@ -9,25 +12,158 @@
 
 
 Shader::Shader(const std::string& filepath)
-    : m_Filepath(filepath), m_RendererID(0)
+    : m_Filepath(filepath), m_RendererID(0), m_Reflected(false), m_Status(ShaderStatus::Ready), m_Queue(nullptr)
 {
     ShaderProgramSource source = ParseShader(filepath);
     m_RendererID = CreateShader(source.VertexSource, source.FragmentSource);
 }
 
+Shader::Shader(const std::string& filepath, ShaderCompileQueue& queue)
+    : m_RendererID(0), m_Filepath(filepath), m_Reflected(false), m_Status(ShaderStatus::Pending), m_Queue(&queue)
+{
+    m_RendererID = queue.Submit(ParseShader(filepath), filepath);
+}
+
 Shader::~Shader()
 {
+    Destroy();
+}
+
+//The uniform table belongs to the program, it moves with it
+Shader::Shader(Shader&& other) noexcept
+    : m_RendererID(other.m_RendererID), m_Filepath(std::move(other.m_Filepath)),
+    m_Uniforms(std::move(other.m_Uniforms)), m_Reflected(other.m_Reflected), m_Status(other.m_Status), m_Queue(other.m_Queue),
+    m_Deferred(std::move(other.m_Deferred))
+{
+    other.m_RendererID = 0;
+    other.m_Queue = nullptr;
+    other.m_Uniforms.clear();
+    other.m_Deferred.clear();
+}
+
+Shader& Shader::operator=(Shader&& other) noexcept
+{
+    if (this != &other)
+    {
+        Destroy();
+        m_RendererID = other.m_RendererID;
+        m_Filepath = std::move(other.m_Filepath);
+        m_Uniforms = std::move(other.m_Uniforms);
+        m_Reflected = other.m_Reflected;
+        m_Status = other.m_Status;
+        m_Queue = other.m_Queue;
+        m_Deferred = std::move(other.m_Deferred);
+        other.m_RendererID = 0;
+        other.m_Queue = nullptr;
+        other.m_Uniforms.clear();
+        other.m_Deferred.clear();
+    }
+    return *this;
+}
+
+void Shader::Destroy()
+{
+    if (m_RendererID == 0)
+        return;
+    if (m_Queue)
+        m_Queue->Cancel(m_RendererID);
+    m_Queue = nullptr;
+    GLStateCache::Get().OnProgramDeleted(m_RendererID);
     GLCall(glDeleteProgram(m_RendererID));
+    m_RendererID = 0;
+    m_Uniforms.clear();
+    m_Deferred.clear();
+    m_Reflected = false;
 }
 
+/* @brief: Doesn't wait for the queue, a pending shader stays pending until a ShaderCompileQueue::Poll has seen it done
+*/
+ShaderStatus Shader::GetStatus() const
+{
+    if (m_Queue)
+    {
+        m_Status = m_Queue->Collect(m_RendererID);
+        if (m_Status != ShaderStatus::Pending)
+            m_Queue = nullptr;
+    }
+    return m_Status;
+}
+
+ShaderStatus Shader::PeekStatus() const
+{
+    return m_Queue ? m_Queue->Peek(m_RendererID) : m_Status;
+}
+
+bool Shader::CheckLinkStatus(unsigned int program, const std::string& filepath)
+{
+    int linked = GL_FALSE;
+    GLCall(glGetProgramiv(program, GL_LINK_STATUS, &linked));
+    if (linked == GL_TRUE)
+        return true;
+
+    int length = 0;
+    GLCall(glGetProgramiv(program, GL_INFO_LOG_LENGTH, &length));
+    std::string message(length > 0 ? length : 1, '\0');
+    GLCall(glGetProgramInfoLog(program, length, nullptr, &message[0]));
+    std::cout << "Failed to link '" << filepath << "'" << std::endl;
+    std::cout << message.c_str() << std::endl;
+    return false;
+}
+
+/* @brief: The first Bind once ready also sets the uniforms kept while pending, their handles get a location now
+*/
 void Shader::Bind() const
 {
-    GLCall(glUseProgram(m_RendererID));
+    if (!IsReady())
+        return;
+    GLStateCache::Get().UseProgram(m_RendererID);
+    if (m_Deferred.empty())
+        return;
+
+    if (!m_Reflected)
+        Reflect();
+    for (const DeferredUniform& uniform : m_Deferred)
+    {
+        UniformHandle handle;
+        handle.Index = uniform.Index;
+        SetDeferredUniform(GetLocation(handle, uniform.Type), uniform);
+    }
+    m_Deferred.clear();
 }
 
 void Shader::Unbind() const
 {
-    GLCall(glUseProgram(0));
+    GLStateCache::Get().UseProgram(0);
+}
+
+//What glUniform1i and glUniform1iv can set
+static bool IsIntUniformType(unsigned int type)
+{
+    switch (type)
+    {
+    case GL_INT: case GL_BOOL:
+    case GL_SAMPLER_1D: case GL_SAMPLER_2D: case GL_SAMPLER_3D: case GL_SAMPLER_CUBE:
+    case GL_SAMPLER_2D_SHADOW: case GL_SAMPLER_2D_ARRAY: case GL_SAMPLER_BUFFER: case GL_SAMPLER_2D_MULTISAMPLE:
+        return true;
+    default:
+        return false;
+    }
+}
+
+void Shader::ApplyDeferredUniforms(const Shader& target) const
+{
+    for (const DeferredUniform& uniform : m_Deferred)
+    {
+        int index = target.FindUniform(m_Uniforms[uniform.Index].Hash);
+        if (index == -1)
+            continue;
+        const UniformInfo& info = target.m_Uniforms[index];
+        bool sameType = uniform.Type == 0 ? IsIntUniformType(info.Type) : info.Type == uniform.Type;
+        //An int array only fits an array at least as long
+        bool fits = uniform.Type != 0 || uniform.Value.size() / sizeof(int) <= (size_t)info.Size;
+        if (info.Location != -1 && sameType && fits)
+            SetDeferredUniform(info.Location, uniform);
+    }
 }
 
 ShaderProgramSource Shader::ParseShader(const std::string& filepath)
@@ -92,8 +228,22 @@ unsigned int Shader::CompileShader(unsigned int type, const std::string & source
 }
 
 
+/* @brief: Loads the program from the binary cache when it has a valid entry for these sources, compiles and links
+           them otherwise and caches the result
+*/
 unsigned int Shader::CreateShader(const std::string& vertexShader, const std::string fragmentShader)
 {
+    ShaderBinaryCache& cache = ShaderBinaryCache::Get();
+    bool cached = cache.IsEnabled();
+    unsigned long long key = 0;
+    if (cached)
+    {
+        key = cache.GetKey(vertexShader, fragmentShader);
+        if (unsigned int program = cache.Load(key))
+            return program;
+    }
+
+    PROFILE_SCOPE("Shader::Compile");
     GLCall(unsigned int program = glCreateProgram());
     GLCall(unsigned int vs = CompileShader(GL_VERTEX_SHADER, vertexShader));
     GLCall(unsigned int fs = CompileShader(GL_FRAGMENT_SHADER, fragmentShader));
@@ -101,9 +251,15 @@ unsigned int Shader::CreateShader(const std::string& vertexShader, const std::st
     //Attach the 2 shaders to our program. This specifies that our shaders will be included in the linking of the program
     GLCall(glAttachShader(program, vs));
     GLCall(glAttachShader(program, fs));
-    //Links and validate the program
+    if (cached)
+    {
+        GLCall(glProgramParameteri(program, GL_PROGRAM_BINARY_RETRIEVABLE_HINT, GL_TRUE));
+    }
+    //Links and validate the program. Validation checks it against the current state and can stall, debug builds only
     GLCall(glLinkProgram(program));
+#ifdef OGL_DEBUG
     GLCall(glValidateProgram(program));
+#endif
 
     /*We can delete the shaders since the program is an intermediate file that executes our shaders.
       Technically we should use glDetachShader, after the linking but since it deletes the source code and that we migth need
@@ -111,40 +267,270 @@ unsigned int Shader::CreateShader(const std::string& vertexShader, const std::st
     GLCall(glDeleteShader(vs));
     GLCall(glDeleteShader(fs));
 
+    bool linked = CheckLinkStatus(program, m_Filepath);
+    m_Status = linked ? ShaderStatus::Ready : ShaderStatus::Failed;
+    if (cached && linked)
+        cache.Store(key, program);
+
     return program;
 }
 
 void Shader::SetUniform1i(const std::string& name, int value)
 {
-    GLCall(glUniform1i(GetUniformLocation(name), value));
+    SetUniform1i(GetUniformHandle(name), value);
+}
+
+void Shader::SetUniform1iv(const std::string& name, int count, const int* values)
+{
+    SetUniform1iv(GetUniformHandle(name), count, values);
 }
 
 void Shader::SetUniform1f(const std::string& name, float value)
 {
-    GLCall(glUniform1f(GetUniformLocation(name), value));
+    SetUniform1f(GetUniformHandle(name), value);
 }
 
 void Shader::SetUniform4f(const std::string& name, float v0, float v1, float v2, float v3)
 {
-    GLCall(glUniform4f(GetUniformLocation(name), v0, v1, v2, v3));
+    SetUniform4f(GetUniformHandle(name), v0, v1, v2, v3);
 }
 
 void Shader::SetUniformMat4f(const std::string& name, const glm::mat4& matrix) 
 {
-    GLCall(glUniformMatrix4fv(GetUniformLocation(name),1, GL_FALSE, &matrix[0][0]));
+    SetUniformMat4f(GetUniformHandle(name), matrix);
+}
+
+//Ints also set samplers and bools, their type isn't checked
+void Shader::SetUniform1i(UniformHandle handle, int value)
+{
+    if (Defer(handle, 0, &value, sizeof(int)))
+        return;
+    GLCall(glUniform1i(GetLocation(handle, 0), value));
+}
+
+void Shader::SetUniform1iv(UniformHandle handle, int count, const int* values)
+{
+    if (Defer(handle, 0, values, count * sizeof(int)))
+        return;
+    GLCall(glUniform1iv(GetLocation(handle, 0), count, values));
+}
+
+void Shader::SetUniform1f(UniformHandle handle, float value)
+{
+    if (Defer(handle, GL_FLOAT, &value, sizeof(float)))
+        return;
+    GLCall(glUniform1f(GetLocation(handle, GL_FLOAT), value));
+}
+
+void Shader::SetUniform4f(UniformHandle handle, float v0, float v1, float v2, float v3)
+{
+    float values[] = { v0, v1, v2, v3 };
+    if (Defer(handle, GL_FLOAT_VEC4, values, sizeof(values)))
+        return;
+    GLCall(glUniform4f(GetLocation(handle, GL_FLOAT_VEC4), v0, v1, v2, v3));
+}
+
+void Shader::SetUniformMat4f(UniformHandle handle, const glm::mat4& matrix)
+{
+    if (Defer(handle, GL_FLOAT_MAT4, &matrix[0][0], sizeof(glm::mat4)))
+        return;
+    GLCall(glUniformMatrix4fv(GetLocation(handle, GL_FLOAT_MAT4), 1, GL_FALSE, &matrix[0][0]));
+}
+
+/* @brief: Keeps the value when the program isn't ready to take it and returns true. Once ready, a value kept for the
+           same uniform is dropped so the next Bind doesn't overwrite this newer one.
+*/
+bool Shader::Defer(UniformHandle handle, unsigned int type, const void* value, unsigned int size)
+{
+    bool ready = IsReady();
+    if (ready && m_Deferred.empty())
+        return false;
+
+    for (auto it = m_Deferred.begin(); it != m_Deferred.end(); ++it)
+    {
+        if (it->Index != handle.Index)
+            continue;
+        if (ready)
+        {
+            m_Deferred.erase(it);
+            return false;
+        }
+        it->Value.assign((const unsigned char*)value, (const unsigned char*)value + size);
+        return true;
+    }
+    if (ready)
+        return false;
+    if (handle.IsValid())
+        m_Deferred.push_back({ handle.Index, type, std::vector<unsigned char>((const unsigned char*)value, (const unsigned char*)value + size) });
+    return true;
+}
+
+//type says which glUniform* stored the value, see Defer
+void Shader::SetDeferredUniform(int location, const DeferredUniform& uniform)
+{
+    const void* value = uniform.Value.data();
+    if (uniform.Type == GL_FLOAT)
+    {
+        GLCall(glUniform1fv(location, 1, (const float*)value));
+    }
+    else if (uniform.Type == GL_FLOAT_VEC4)
+    {
+        GLCall(glUniform4fv(location, 1, (const float*)value));
+    }
+    else if (uniform.Type == GL_FLOAT_MAT4)
+    {
+        GLCall(glUniformMatrix4fv(location, 1, GL_FALSE, (const float*)value));
+    }
+    else
+    {
+        GLCall(glUniform1iv(location, (GLsizei)(uniform.Value.size() / sizeof(int)), (const int*)value));
+    }
+}
+
+//type is what the setter writes, 0 skips the check. A name the program doesn't have has type 0 and location -1, GL ignores it
+int Shader::GetLocation(UniformHandle handle, unsigned int type) const
+{
+    if (!handle.IsValid())
+        return -1;
+    const UniformInfo& uniform = m_Uniforms[handle.Index];
+    //Only checked by debug builds
+    (void)type;
+    ASSERT(type == 0 || uniform.Type == 0 || uniform.Type == type);
+    return uniform.Location;
+}
+
+/* @brief: Reads the active uniforms of the program into the table. Members of uniform blocks have no location and
+           are left out. Only done once the program is ready, querying a program still linking (see
+           ShaderCompileQueue) would wait for it. Names looked up before keep their entry and handle.
+*/
+void Shader::Reflect() const
+{
+    m_Reflected = true;
+    if (m_RendererID == 0)
+        return;
+
+    int count = 0, maxLength = 0;
+    GLCall(glGetProgramiv(m_RendererID, GL_ACTIVE_UNIFORMS, &count));
+    GLCall(glGetProgramiv(m_RendererID, GL_ACTIVE_UNIFORM_MAX_LENGTH, &maxLength));
+    std::vector<char> name(maxLength + 1);
+    for (int i = 0; i < count; i++)
+    {
+        GLsizei length = 0;
+        GLint size = 0;
+        GLenum type = 0;
+        GLCall(glGetActiveUniform(m_RendererID, i, (GLsizei)name.size(), &length, &size, &type, name.data()));
+        std::string uniformName(name.data(), length);
+        if (uniformName.size() > 3 && uniformName.compare(uniformName.size() - 3, 3, "[0]") == 0)
+            uniformName.resize(uniformName.size() - 3);
+
+        GLCall(int location = glGetUniformLocation(m_RendererID, uniformName.c_str()));
+        if (location == -1)
+            continue;
+        uint32_t hash = HashUniformName(uniformName.c_str());
+        int index = FindUniform(hash);
+        if (index != -1 && m_Uniforms[index].Location == -1)
+        {
+            m_Uniforms[index] = { uniformName, hash, location, type, size };
+            continue;
+        }
+        if (index != -1)
+            std::cout << "Warning: uniform '" << uniformName << "' has the same name hash as another uniform of '" << m_Filepath << "'" << std::endl;
+        m_Uniforms.push_back({ uniformName, hash, location, type, size });
+    }
+
+    for (const UniformInfo& uniform : m_Uniforms)
+    {
+        if (uniform.Location != -1)
+            continue;
+        if (uniform.Name.empty())
+            std::cout << "Warning: uniform with name hash " << std::hex << uniform.Hash << std::dec << " doesn't exist!" << std::endl;
+        else
+            std::cout << "Warning: uniform '" << uniform.Name << "' doesn't exist!" << std::endl;
+    }
+}
+
+//A linear scan over the hashes, programs only have a handful of uniforms
+int Shader::FindUniform(uint32_t hash) const
+{
+    if (!m_Reflected && IsReady())
+        Reflect();
+    for (unsigned int i = 0; i < m_Uniforms.size(); i++)
+    {
+        if (m_Uniforms[i].Hash == hash)
+            return (int)i;
+    }
+    return -1;
+}
+
+UniformHandle Shader::GetUniformHandle(UniformName name)
+{
+    UniformHandle handle;
+    handle.Index = FindUniform(name.Hash);
+    if (handle.Index == -1)
+    {
+        //Before reflecting it may still exist, Reflect reports it if not
+        if (m_Reflected)
+            std::cout << "Warning: uniform with name hash " << std::hex << name.Hash << std::dec << " doesn't exist!" << std::endl;
+        handle.Index = (int)m_Uniforms.size();
+        m_Uniforms.push_back({ std::string(), name.Hash, -1, 0, 0 });
+    }
+    return handle;
+}
+
+UniformHandle Shader::GetUniformHandle(const std::string& name)
+{
+    uint32_t hash = HashUniformName(name.c_str());
+    UniformHandle handle;
+    handle.Index = FindUniform(hash);
+    if (handle.Index == -1)
+    {
+        if (m_Reflected)
+            std::cout << "Warning: uniform '" << name << "' doesn't exist!" << std::endl;
+        handle.Index = (int)m_Uniforms.size();
+        m_Uniforms.push_back({ name, hash, -1, 0, 0 });
+    }
+    return handle;
+}
+
+//Empty while the shader isn't ready
+const std::vector<UniformInfo>& Shader::GetUniforms()
+{
+    if (!m_Reflected && IsReady())
+        Reflect();
+    return m_Uniforms;
 }
 
 int Shader::GetUniformLocation(const std::string& name)
 {
-    if (m_UniformLocationCache.find(name) != m_UniformLocationCache.end())
-        return m_UniformLocationCache[name];
+    return GetUniformLocation(GetUniformHandle(name));
+}
 
-    GLCall(unsigned int location = glGetUniformLocation(m_RendererID, name.c_str()));
+/* @brief: The binding is stored in the program, it only has to be set once after linking. Querying a program still
+           linking waits for it like Reflect does.
+*/
+bool Shader::SetUniformBlockBinding(const std::string& blockName, unsigned int binding)
+{
+    GLCall(unsigned int index = glGetUniformBlockIndex(m_RendererID, blockName.c_str()));
+    if (index == GL_INVALID_INDEX)
+    {
+        std::cout << "Warning: uniform block '" << blockName << "' doesn't exist in '" << m_Filepath << "'" << std::endl;
+        return false;
+    }
+    GLCall(glUniformBlockBinding(m_RendererID, index, binding));
+    return true;
+}
 
-    if (location == -1)
-        std::cout << "Warning: uniform '" << name << "' doesn't exist!" << std::endl;
-    
-    m_UniformLocationCache[name] = location;
+bool Shader::SetUniformBlockBinding(const std::string& blockName)
+{
+    return SetUniformBlockBinding(blockName, UniformBuffer::GetBindingPoint(blockName));
+}
 
-    return location;
-}
\ No newline at end of file
+unsigned int Shader::GetUniformBlockSize(const std::string& blockName) const
+{
+    GLCall(unsigned int index = glGetUniformBlockIndex(m_RendererID, blockName.c_str()));
+    if (index == GL_INVALID_INDEX)
+        return 0;
+    int size = 0;
+    GLCall(glGetActiveUniformBlockiv(m_RendererID, index, GL_UNIFORM_BLOCK_DATA_SIZE, &size));
+    return (unsigned int)size;
+}
@@ -1,6 +1,7 @@
 #pragma once
+#include <cstdint>
 #include <string>
-#include <unordered_map>
+#include <vector>
 #include "glm/glm.hpp"
 
 struct ShaderProgramSource {
@@ -8,28 +9,132 @@ struct ShaderProgramSource {
 	std::string FragmentSource;
 };
 
+class ShaderCompileQueue;
+
+//FNV-1a of a uniform name, the key of the uniform table of a Shader
+inline constexpr uint32_t HashUniformName(const char* name)
+{
+	uint32_t hash = 2166136261u;
+	while (*name)
+	{
+		hash ^= (unsigned char)*name++;
+		hash *= 16777619u;
+	}
+	return hash;
+}
+
+//A uniform name hashed at compile time: static constexpr UniformName s_MVP("u_MVP");
+struct UniformName {
+	uint32_t Hash;
+	explicit constexpr UniformName(const char* name) : Hash(HashUniformName(name)) {}
+};
+
+//Index of a uniform in the table of the shader that returned it, only valid for that shader
+struct UniformHandle {
+	int Index = -1;
+	inline bool IsValid() const { return Index >= 0; }
+};
+
+/* An active uniform of a program, from glGetActiveUniform. Arrays are named without their [0] suffix. Names looked up
+   but not in the program get an entry too, with location -1 and type 0, so they're only reported once. */
+struct UniformInfo {
+	std::string Name;
+	uint32_t Hash;
+	int Location;
+	unsigned int Type;
+	int Size;
+};
+
+//Pending while a ShaderCompileQueue still works on the program, Failed when it didn't compile or link
+enum class ShaderStatus {
+	Pending, Ready, Failed
+};
+
+/* A shader is only usable once Ready. Until then Bind does nothing, and the uniforms set on it are kept and applied by
+   the first Bind once it is ready. Renderer::SetFallbackShader draws with another shader meanwhile, the fallback
+   receives the kept uniforms it shares by name and type with the pending shader. */
 
 class Shader {
 private:
 	unsigned int m_RendererID;
 	std::string m_Filepath;
-	std::unordered_map<std::string, int> m_UniformLocationCache;
+	//Filled on the first lookup once the program is linked, names looked up before that get their entry first
+	mutable std::vector<UniformInfo> m_Uniforms;
+	mutable bool m_Reflected;
+	//Both are refreshed from the queue by GetStatus, m_Queue is only set while pending
+	mutable ShaderStatus m_Status;
+	mutable ShaderCompileQueue* m_Queue;
 
-	int GetUniformLocation(const std::string& name);
+	//A uniform set while the program wasn't ready. Type is the one GetLocation checks, 0 for ints
+	struct DeferredUniform {
+		int Index;
+		unsigned int Type;
+		std::vector<unsigned char> Value;
+	};
+	mutable std::vector<DeferredUniform> m_Deferred;
 
-	ShaderProgramSource ParseShader(const std::string& filepath);
 	unsigned int CreateShader(const std::string& vertexShader, const std::string fragmentShader);
 	unsigned int CompileShader(unsigned int type, const std::string& source);
+	void Destroy();
+	void Reflect() const;
+	int FindUniform(uint32_t hash) const;
+	int GetLocation(UniformHandle handle, unsigned int type) const;
+	bool Defer(UniformHandle handle, unsigned int type, const void* value, unsigned int size);
+	static void SetDeferredUniform(int location, const DeferredUniform& uniform);
 
 public:
 	Shader(const std::string& filepath);
+	//Hands the compile and link to queue and returns without waiting, see ShaderCompileQueue
+	Shader(const std::string& filepath, ShaderCompileQueue& queue);
+	//Splits a .shader file into its vertex and fragment sources
+	static ShaderProgramSource ParseShader(const std::string& filepath);
 	~Shader();
+	Shader(const Shader&) = delete;
+	Shader& operator=(const Shader&) = delete;
+	Shader(Shader&& other) noexcept;
+	Shader& operator=(Shader&& other) noexcept;
 
+	ShaderStatus GetStatus() const;
+	//GetStatus without collecting the program from the queue, for code recording commands on another thread
+	ShaderStatus PeekStatus() const;
+	inline bool IsReady() const { return GetStatus() == ShaderStatus::Ready; }
+	//Prints the link log when it failed
+	static bool CheckLinkStatus(unsigned int program, const std::string& filepath);
+
+	//Does nothing while the shader isn't ready, glUseProgram would wait for the link or fail
 	void Bind() const;
 	void Unbind() const;
+	/* @brief: Sets the uniforms kept while pending on target, which has to be bound: those it has with the same name
+	   and type. Used by Renderer to give them to its fallback shader.
+	*/
+	void ApplyDeferredUniforms(const Shader& target) const;
+	int GetUniformLocation(const std::string& name);
+	inline int GetUniformLocation(UniformHandle handle) const { return handle.IsValid() ? m_Uniforms[handle.Index].Location : -1; }
+	inline unsigned int GetRendererID() const { return m_RendererID; }
+
+	/* Resolve a handle once and set the uniform through it, that's an index in the table. A UniformName is hashed at
+	   compile time, the string version hashes at run time. */
+	UniformHandle GetUniformHandle(UniformName name);
+	UniformHandle GetUniformHandle(const std::string& name);
+	const std::vector<UniformInfo>& GetUniforms();
+
+	/* Connects a uniform block of the program to a binding point, the one of UniformBuffer::GetBindingPoint when none
+	   is given. Returns false when the program has no such block. */
+	bool SetUniformBlockBinding(const std::string& blockName, unsigned int binding);
+	bool SetUniformBlockBinding(const std::string& blockName);
+	//GL_UNIFORM_BLOCK_DATA_SIZE, 0 when the block doesn't exist
+	unsigned int GetUniformBlockSize(const std::string& blockName) const;
+
 	void SetUniform1i(const std::string& name, int value);
+	void SetUniform1iv(const std::string& name, int count, const int* values);
 	void SetUniform1f(const std::string& name, float value);
 	void SetUniform4f(const std::string& name, float v0, float v1, float v2, float v3);
 	void SetUniformMat4f(const std::string& name, const glm::mat4& matrix);
+
+	void SetUniform1i(UniformHandle handle, int value);
+	void SetUniform1iv(UniformHandle handle, int count, const int* values);
+	void SetUniform1f(UniformHandle handle, float value);
+	void SetUniform4f(UniformHandle handle, float v0, float v1, float v2, float v3);
+	void SetUniformMat4f(UniformHandle handle, const glm::mat4& matrix);
 };
 
@@ -0,0 +1,186 @@
+#include "ShaderBinaryCache.h"
+#include "CacheDirectory.h"
+#include "Renderer.h"
+
+#include <cstdio>
+#include <cstring>
+#include <fstream>
+
+static const char s_Magic[4] = { 'O', 'G', 'L', 'B' };
+//Program binaries are a few hundred KB at most, anything bigger is a damaged entry
+static const unsigned int s_MaxBinarySize = 64 * 1024 * 1024;
+
+//FNV-1a, continued from hash
+static unsigned long long HashBytes(unsigned long long hash, const void* data, size_t size)
+{
+    const unsigned char* bytes = (const unsigned char*)data;
+    for (size_t i = 0; i < size; i++)
+    {
+        hash ^= bytes[i];
+        hash *= 1099511628211ull;
+    }
+    return hash;
+}
+
+ShaderBinaryCache::ShaderBinaryCache()
+    : m_Directory(GetCacheDirectory() + "/shaders"), m_Supported(false), m_Enabled(true), m_Initialized(false),
+      m_Hits(0), m_Misses(0), m_Rejected(0)
+{
+}
+
+ShaderBinaryCache& ShaderBinaryCache::Get()
+{
+    static ShaderBinaryCache cache;
+    return cache;
+}
+
+/* @brief: Reads what the key depends on from the context, on first use since there's no context when Get() may first run
+*/
+void ShaderBinaryCache::Initialize()
+{
+    if (m_Initialized)
+        return;
+    m_Initialized = true;
+
+#ifndef OGL_TRACE
+    if (!GLEW_VERSION_4_1 && !GLEW_ARB_get_program_binary)
+        return;
+    int formatCount = 0;
+    GLCall(glGetIntegerv(GL_NUM_PROGRAM_BINARY_FORMATS, &formatCount));
+    if (formatCount <= 0)
+        return;
+    m_Formats.resize(formatCount);
+    GLCall(glGetIntegerv(GL_PROGRAM_BINARY_FORMATS, m_Formats.data()));
+
+    GLCall(m_DriverKey = (const char*)glGetString(GL_VENDOR));
+    GLCall(m_DriverKey += std::string("|") + (const char*)glGetString(GL_RENDERER));
+    GLCall(m_DriverKey += std::string("|") + (const char*)glGetString(GL_VERSION));
+    m_Supported = true;
+#endif
+}
+
+std::string ShaderBinaryCache::GetEntryPath(unsigned long long key) const
+{
+    char name[32];
+    snprintf(name, sizeof(name), "%016llx.bin", key);
+    return m_Directory + "/" + name;
+}
+
+void ShaderBinaryCache::SetDirectory(const std::string& directory)
+{
+    m_Directory = directory;
+}
+
+void ShaderBinaryCache::SetEnabled(bool enabled)
+{
+    m_Enabled = enabled;
+}
+
+bool ShaderBinaryCache::IsEnabled()
+{
+    Initialize();
+    return m_Enabled && m_Supported;
+}
+
+unsigned long long ShaderBinaryCache::GetKey(const std::string& vertexSource, const std::string& fragmentSource)
+{
+    Initialize();
+    unsigned long long hash = 14695981039346656037ull;
+    hash = HashBytes(hash, m_DriverKey.data(), m_DriverKey.size());
+    hash = HashBytes(hash, m_Formats.data(), m_Formats.size() * sizeof(int));
+    //Sizes keep "ab" + "c" from hashing like "a" + "bc"
+    unsigned long long sizes[2] = { vertexSource.size(), fragmentSource.size() };
+    hash = HashBytes(hash, sizes, sizeof(sizes));
+    hash = HashBytes(hash, vertexSource.data(), vertexSource.size());
+    return HashBytes(hash, fragmentSource.data(), fragmentSource.size());
+}
+
+unsigned int ShaderBinaryCache::Load(unsigned long long key)
+{
+    PROFILE_SCOPE("ShaderBinaryCache::Load");
+    if (!IsEnabled())
+        return 0;
+
+    std::ifstream file(GetEntryPath(key), std::ios::binary);
+    char magic[4];
+    unsigned int header[2];
+    if (!file.read(magic, sizeof(magic)) || memcmp(magic, s_Magic, sizeof(magic)) != 0
+        || !file.read((char*)header, sizeof(header)))
+    {
+        m_Misses++;
+        return 0;
+    }
+    //The size comes from the file: a damaged entry must not make us allocate whatever it says
+    std::streampos dataStart = file.tellg();
+    file.seekg(0, std::ios::end);
+    std::streamoff remaining = file.tellg() - dataStart;
+    file.seekg(dataStart);
+    if (header[1] == 0 || header[1] > s_MaxBinarySize || remaining != (std::streamoff)header[1])
+    {
+        m_Misses++;
+        return 0;
+    }
+    unsigned int format = header[0];
+    std::vector<char> binary(header[1]);
+    bool known = false;
+    for (int supported : m_Formats)
+        known = known || (unsigned int)supported == format;
+    //glProgramBinary with a format the driver doesn't list is an error, not a failed link
+    if (!known || !file.read(binary.data(), binary.size()))
+    {
+        m_Rejected++;
+        return 0;
+    }
+
+    GLCall(unsigned int program = glCreateProgram());
+    GLCall(glProgramBinary(program, format, binary.data(), (GLsizei)binary.size()));
+    int linked = GL_FALSE;
+    GLCall(glGetProgramiv(program, GL_LINK_STATUS, &linked));
+    if (linked == GL_FALSE)
+    {
+        GLCall(glDeleteProgram(program));
+        m_Rejected++;
+        return 0;
+    }
+    m_Hits++;
+    return program;
+}
+
+/* @brief: Written to a temporary file first and renamed, so a run stopped halfway doesn't leave a truncated entry
+*/
+bool ShaderBinaryCache::Store(unsigned long long key, unsigned int program)
+{
+    if (!IsEnabled())
+        return false;
+
+    int length = 0;
+    GLCall(glGetProgramiv(program, GL_PROGRAM_BINARY_LENGTH, &length));
+    if (length <= 0)
+        return false;
+    std::vector<char> binary(length);
+    GLenum format = 0;
+    GLCall(glGetProgramBinary(program, length, &length, &format, binary.data()));
+
+    MakeDirectory(m_Directory);
+    std::string path = GetEntryPath(key);
+    std::string temporaryPath = path + ".tmp";
+    bool written;
+    {
+        std::ofstream file(temporaryPath, std::ios::binary | std::ios::trunc);
+        unsigned int header[2] = { format, (unsigned int)length };
+        written = file.write(s_Magic, sizeof(s_Magic)) && file.write((const char*)header, sizeof(header))
+            && file.write(binary.data(), length);
+    }
+    if (!written)
+    {
+        std::remove(temporaryPath.c_str());
+        return false;
+    }
+    std::remove(path.c_str());
+    return std::rename(temporaryPath.c_str(), path.c_str()) == 0;
+}
+
+void ShaderBinaryCache::Remove(unsigned long long key)
+{
+    std::remove(GetEntryPath(key).c_str());
+}
@@ -0,0 +1,49 @@
+#pragma once
+#include <string>
+#include <vector>
+
+/* Linked programs saved to disk with glGetProgramBinary (GL 4.1 / ARB_get_program_binary) and loaded back with
+   glProgramBinary, so a shader is only compiled the first time a driver sees its source.
+   The key hashes the parsed sources with the GL vendor, renderer and version strings and the binary formats the driver
+   accepts, a driver update gives new keys instead of loading stale binaries. A driver can still reject a binary it
+   wrote (the link status says so), Shader then compiles from source and the entry is written again.
+   Entries go to the shaders folder of GetCacheDirectory(), next to the upload strategy record.
+   Entry file: "OGLB", binary format (u32), binary size (u32), binary. Trace builds never use the cache, a program
+   loaded from a binary would be missing its compile calls in the trace. */
+class ShaderBinaryCache {
+private:
+	std::string m_Directory;
+	std::string m_DriverKey;
+	std::vector<int> m_Formats;
+	bool m_Supported;
+	bool m_Enabled;
+	bool m_Initialized;
+	unsigned int m_Hits;
+	unsigned int m_Misses;
+	unsigned int m_Rejected;
+
+	ShaderBinaryCache();
+	void Initialize();
+
+public:
+	static ShaderBinaryCache& Get();
+
+	//The directory is created on the first write, its parent has to exist. A relative path is from the working directory
+	void SetDirectory(const std::string& directory);
+	inline const std::string& GetDirectory() const { return m_Directory; }
+	void SetEnabled(bool enabled);
+	bool IsEnabled();
+
+	unsigned long long GetKey(const std::string& vertexSource, const std::string& fragmentSource);
+	//Returns the linked program, or 0 when there's no entry or the driver rejects it
+	unsigned int Load(unsigned long long key);
+	//program has to be linked with GL_PROGRAM_BINARY_RETRIEVABLE_HINT set
+	bool Store(unsigned long long key, unsigned int program);
+	void Remove(unsigned long long key);
+	std::string GetEntryPath(unsigned long long key) const;
+
+	inline unsigned int GetHits() const { return m_Hits; }
+	inline unsigned int GetMisses() const { return m_Misses; }
+	inline unsigned int GetRejected() const { return m_Rejected; }
+	inline void ResetCounters() { m_Hits = 0; m_Misses = 0; m_Rejected = 0; }
+};
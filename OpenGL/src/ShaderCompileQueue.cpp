@@ -0,0 +1,196 @@
+#include "ShaderCompileQueue.h"
+#include "Renderer.h"
+#include "ShaderBinaryCache.h"
+
+#include <algorithm>
+#include <iostream>
+
+static unsigned int StartCompile(unsigned int type, const std::string& source)
+{
+    GLCall(unsigned int id = glCreateShader(type));
+    const char* src = source.c_str();
+    GLCall(glShaderSource(id, 1, &src, nullptr));
+    GLCall(glCompileShader(id));
+    return id;
+}
+
+//Only called once the program failed to link, the compile status doesn't block then
+static void PrintCompileLog(unsigned int id, const std::string& filepath)
+{
+    int compiled = GL_FALSE;
+    GLCall(glGetShaderiv(id, GL_COMPILE_STATUS, &compiled));
+    if (compiled == GL_TRUE)
+        return;
+
+    int type = 0, length = 0;
+    GLCall(glGetShaderiv(id, GL_SHADER_TYPE, &type));
+    GLCall(glGetShaderiv(id, GL_INFO_LOG_LENGTH, &length));
+    std::string message(length > 0 ? length : 1, '\0');
+    GLCall(glGetShaderInfoLog(id, length, nullptr, &message[0]));
+    std::cout << "Failed to compile " << (type == GL_VERTEX_SHADER ? "vertex" : "fragment") << " shader of '"
+        << filepath << "'" << std::endl;
+    std::cout << message.c_str() << std::endl;
+}
+
+ShaderCompileQueue::ShaderCompileQueue()
+    : m_Parallel(false), m_Initialized(false)
+{
+}
+
+ShaderCompileQueue& ShaderCompileQueue::Get()
+{
+    static ShaderCompileQueue queue;
+    return queue;
+}
+
+/* @brief: Lets the driver use as many compiler threads as it wants, the default is implementation defined
+*/
+void ShaderCompileQueue::Initialize()
+{
+    if (m_Initialized)
+        return;
+    m_Initialized = true;
+
+    if (GLEW_KHR_parallel_shader_compile)
+    {
+        GLCall(glMaxShaderCompilerThreadsKHR(0xFFFFFFFF));
+        m_Parallel = true;
+    }
+    else if (GLEW_ARB_parallel_shader_compile)
+    {
+        GLCall(glMaxShaderCompilerThreadsARB(0xFFFFFFFF));
+        m_Parallel = true;
+    }
+}
+
+bool ShaderCompileQueue::IsParallel()
+{
+    Initialize();
+    return m_Parallel;
+}
+
+/* @brief: Nothing here queries a compile or link status, that's what would wait for the compiler
+*/
+unsigned int ShaderCompileQueue::Submit(const ShaderProgramSource& source, const std::string& filepath)
+{
+    PROFILE_SCOPE("ShaderCompileQueue::Submit");
+    Initialize();
+
+    Job job = { 0, 0, false, 0, filepath };
+    ShaderBinaryCache& cache = ShaderBinaryCache::Get();
+    job.Cache = cache.IsEnabled();
+    if (job.Cache)
+    {
+        job.CacheKey = cache.GetKey(source.VertexSource, source.FragmentSource);
+        if (unsigned int program = cache.Load(job.CacheKey))
+        {
+            m_Finished[program] = ShaderStatus::Ready;
+            return program;
+        }
+    }
+
+    GLCall(unsigned int program = glCreateProgram());
+    job.VertexShader = StartCompile(GL_VERTEX_SHADER, source.VertexSource);
+    job.FragmentShader = StartCompile(GL_FRAGMENT_SHADER, source.FragmentSource);
+    GLCall(glAttachShader(program, job.VertexShader));
+    GLCall(glAttachShader(program, job.FragmentShader));
+    if (job.Cache)
+    {
+        GLCall(glProgramParameteri(program, GL_PROGRAM_BINARY_RETRIEVABLE_HINT, GL_TRUE));
+    }
+    GLCall(glLinkProgram(program));
+
+    m_Jobs.emplace(program, std::move(job));
+    m_Order.push_back(program);
+    return program;
+}
+
+void ShaderCompileQueue::Complete(unsigned int program)
+{
+    Job& job = m_Jobs[program];
+    bool linked = Shader::CheckLinkStatus(program, job.Filepath);
+    if (!linked)
+    {
+        PrintCompileLog(job.VertexShader, job.Filepath);
+        PrintCompileLog(job.FragmentShader, job.Filepath);
+    }
+    GLCall(glDeleteShader(job.VertexShader));
+    GLCall(glDeleteShader(job.FragmentShader));
+    if (linked && job.Cache)
+        ShaderBinaryCache::Get().Store(job.CacheKey, program);
+
+    m_Finished[program] = linked ? ShaderStatus::Ready : ShaderStatus::Failed;
+    m_Jobs.erase(program);
+}
+
+unsigned int ShaderCompileQueue::Poll(unsigned int maxBlocking)
+{
+    PROFILE_SCOPE("ShaderCompileQueue::Poll");
+    unsigned int blocking = 0;
+    unsigned int kept = 0;
+    for (unsigned int i = 0; i < m_Order.size(); i++)
+    {
+        unsigned int program = m_Order[i];
+        bool done;
+        if (m_Parallel)
+        {
+            int complete = GL_FALSE;
+            GLCall(glGetProgramiv(program, GL_COMPLETION_STATUS_KHR, &complete));
+            done = complete == GL_TRUE;
+        }
+        else
+        {
+            done = blocking < maxBlocking;
+            blocking++;
+        }
+
+        if (done)
+            Complete(program);
+        else
+            m_Order[kept++] = program;
+    }
+    m_Order.resize(kept);
+    return kept;
+}
+
+void ShaderCompileQueue::Finish()
+{
+    PROFILE_SCOPE("ShaderCompileQueue::Finish");
+    for (unsigned int program : m_Order)
+        Complete(program);
+    m_Order.clear();
+}
+
+ShaderStatus ShaderCompileQueue::Collect(unsigned int program)
+{
+    if (m_Jobs.find(program) != m_Jobs.end())
+        return ShaderStatus::Pending;
+
+    auto it = m_Finished.find(program);
+    if (it == m_Finished.end())
+        return ShaderStatus::Failed;
+    ShaderStatus status = it->second;
+    m_Finished.erase(it);
+    return status;
+}
+
+ShaderStatus ShaderCompileQueue::Peek(unsigned int program) const
+{
+    if (m_Jobs.find(program) != m_Jobs.end())
+        return ShaderStatus::Pending;
+    auto it = m_Finished.find(program);
+    return it != m_Finished.end() ? it->second : ShaderStatus::Failed;
+}
+
+void ShaderCompileQueue::Cancel(unsigned int program)
+{
+    auto it = m_Jobs.find(program);
+    if (it != m_Jobs.end())
+    {
+        GLCall(glDeleteShader(it->second.VertexShader));
+        GLCall(glDeleteShader(it->second.FragmentShader));
+        m_Jobs.erase(it);
+        m_Order.erase(std::find(m_Order.begin(), m_Order.end(), program));
+    }
+    m_Finished.erase(program);
+}
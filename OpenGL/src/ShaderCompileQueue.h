@@ -0,0 +1,55 @@
+#pragma once
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+#include "Shader.h"
+
+/* Compiles and links programs without waiting on them, for loading many shaders at startup or between levels.
+   Submit issues the compile and link calls and returns, Poll (once a frame) collects the programs that are done:
+     with GL_KHR_parallel_shader_compile (or the ARB version) the driver compiles on its own threads and
+       GL_COMPLETION_STATUS_KHR tells when a program is done without blocking
+     without it there's no way to ask without waiting, Poll finishes at most maxBlocking programs per call so
+       the wait is spread over frames
+   A program with a valid ShaderBinaryCache entry is ready right away. Shader::GetStatus reads the result and
+   Renderer draws with its fallback shader, or skips the draw, while a shader is pending. */
+class ShaderCompileQueue {
+private:
+	struct Job {
+		unsigned int VertexShader;
+		unsigned int FragmentShader;
+		bool Cache;
+		unsigned long long CacheKey;
+		std::string Filepath;
+	};
+
+	std::unordered_map<unsigned int, Job> m_Jobs;
+	//Pending programs in submission order, the oldest are finished first
+	std::vector<unsigned int> m_Order;
+	std::unordered_map<unsigned int, ShaderStatus> m_Finished;
+	bool m_Parallel;
+	bool m_Initialized;
+
+	ShaderCompileQueue();
+	void Initialize();
+	void Complete(unsigned int program);
+
+public:
+	static ShaderCompileQueue& Get();
+
+	//Returns the program, usable once its status is Ready
+	unsigned int Submit(const ShaderProgramSource& source, const std::string& filepath);
+	//Returns the number of programs still pending
+	unsigned int Poll(unsigned int maxBlocking = 1);
+	//Waits for every pending program
+	void Finish();
+
+	//A finished program is forgotten once its status has been collected
+	ShaderStatus Collect(unsigned int program);
+	//The status without forgetting the program, safe from several threads as long as nothing submits, polls or collects
+	ShaderStatus Peek(unsigned int program) const;
+	void Cancel(unsigned int program);
+
+	inline unsigned int GetPendingCount() const { return (unsigned int)m_Jobs.size(); }
+	bool IsParallel();
+};
@@ -0,0 +1,121 @@
+#include "StreamingVertexBuffer.h"
+#include "Renderer.h"
+#include "GLFence.h"
+
+static const GLbitfield s_PersistentFlags = GL_MAP_WRITE_BIT | GL_MAP_PERSISTENT_BIT | GL_MAP_COHERENT_BIT;
+
+StreamingVertexBuffer::StreamingVertexBuffer(unsigned int regionSize, unsigned int regionCount, bool allowPersistent)
+    : m_RegionSize(regionSize), m_RegionCount(regionCount), m_Region(0), m_Offset(0), m_MappedOffset(0), m_MappedSize(0),
+      m_Persistent(allowPersistent && IsPersistentMappingSupported()), m_Mapped(nullptr), m_StallCount(0), m_StallMs(0.0)
+{
+    ASSERT(regionCount > 0 && regionCount <= MaxRegions);
+    for (unsigned int i = 0; i < MaxRegions; i++)
+        m_Fences[i] = nullptr;
+
+    Bind();
+    if (m_Persistent)
+    {
+        GLCall(glBufferStorage(GL_ARRAY_BUFFER, (GLsizeiptr)regionSize * regionCount, nullptr, s_PersistentFlags));
+        GLCall(m_Mapped = (char*)glMapBufferRange(GL_ARRAY_BUFFER, 0, (GLsizeiptr)regionSize * regionCount, s_PersistentFlags));
+    }
+    else
+    {
+        //A single region, orphaned every time it fills up
+        m_RegionCount = 1;
+        GLCall(glBufferData(GL_ARRAY_BUFFER, regionSize, nullptr, GL_STREAM_DRAW));
+        m_Staging.resize(regionSize);
+    }
+}
+
+StreamingVertexBuffer::~StreamingVertexBuffer()
+{
+    for (unsigned int i = 0; i < MaxRegions; i++)
+    {
+        if (m_Fences[i])
+        {
+            GLCall(glDeleteSync(m_Fences[i]));
+        }
+    }
+    if (m_Mapped)
+    {
+        Bind();
+        GLCall(glUnmapBuffer(GL_ARRAY_BUFFER));
+    }
+}
+
+//Not with OGL_TRACE, GLTrace doesn't see the writes made through the mapping
+bool StreamingVertexBuffer::IsPersistentMappingSupported()
+{
+#ifdef OGL_TRACE
+    return false;
+#else
+    return GLEW_VERSION_4_4 || GLEW_ARB_buffer_storage;
+#endif
+}
+
+/* @brief: Returns size bytes to write the vertices into, valid until Unmap()
+*/
+void* StreamingVertexBuffer::Map(unsigned int size)
+{
+    ASSERT(size <= m_RegionSize);
+    if (m_Offset + size > m_RegionSize)
+        NextRegion();
+
+    m_MappedOffset = m_Offset;
+    m_MappedSize = size;
+    if (m_Persistent)
+        return m_Mapped + (size_t)m_Region * m_RegionSize + m_Offset;
+    return m_Staging.data();
+}
+
+/* @brief: Makes the written vertices visible to the GPU, returns their byte offset in the buffer. Divided by the
+           vertex size it gives the base vertex to draw with.
+*/
+unsigned int StreamingVertexBuffer::Unmap()
+{
+    if (!m_Persistent)
+    {
+        Bind();
+        //Starting over from the beginning, the storage still used by previous draws is given back to the driver
+        if (m_MappedOffset == 0)
+        {
+            GLCall(glBufferData(GL_ARRAY_BUFFER, m_RegionSize, nullptr, GL_STREAM_DRAW));
+        }
+        GLCall(glBufferSubData(GL_ARRAY_BUFFER, m_MappedOffset, m_MappedSize, m_Staging.data()));
+    }
+
+    m_Offset = m_MappedOffset + m_MappedSize;
+    return m_Region * m_RegionSize + m_MappedOffset;
+}
+
+/* @brief: Moves on to the next region so the next frame doesn't write where this one's draws read from
+*/
+void StreamingVertexBuffer::EndFrame()
+{
+    if (m_Offset > 0)
+        NextRegion();
+}
+
+/* @brief: Fences the draws issued from the current region and waits until the GPU is done with the next one
+*/
+void StreamingVertexBuffer::NextRegion()
+{
+    m_Offset = 0;
+    if (!m_Persistent)
+        return;
+
+    GLCall(m_Fences[m_Region] = glFenceSync(GL_SYNC_GPU_COMMANDS_COMPLETE, 0));
+    m_Region = (m_Region + 1) % m_RegionCount;
+
+    GLsync fence = m_Fences[m_Region];
+    if (!fence)
+        return;
+    m_Fences[m_Region] = nullptr;
+
+    double stallMs = WaitForFence(fence);
+    if (stallMs > 0.0)
+    {
+        m_StallCount++;
+        m_StallMs += stallMs;
+    }
+}
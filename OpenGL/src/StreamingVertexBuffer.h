@@ -0,0 +1,60 @@
+#pragma once
+#include <GL/glew.h>
+#include <vector>
+
+#include "VertexBuffer.h"
+
+/* Vertex buffer for geometry rewritten every frame.
+   With GL 4.4 / ARB_buffer_storage the buffer is split into regionCount regions kept persistently and coherently
+   mapped, each region guarded by a fence: the CPU writes into one region while the GPU still reads the previous ones,
+   and only waits (a stall) when it wraps around onto a region the GPU hasn't finished with.
+   On GL 3.3 it falls back to orphaning the buffer with glBufferData and filling it with glBufferSubData.
+   Map() returns where to write, Unmap() the byte offset of the written range to draw from (see Renderer::Draw with a
+   base vertex). Writes of a region go one after the other, a write that doesn't fit moves on to the next region.
+   The VertexBuffer base is private, its Update and SetData don't know about the regions: GetVertexBuffer() is only
+   for vertex arrays to read from. */
+class StreamingVertexBuffer : private VertexBuffer {
+public:
+	static const unsigned int MaxRegions = 8;
+
+private:
+	unsigned int m_RegionSize;
+	unsigned int m_RegionCount;
+	unsigned int m_Region;
+	unsigned int m_Offset;
+	unsigned int m_MappedOffset;
+	unsigned int m_MappedSize;
+
+	bool m_Persistent;
+	char* m_Mapped;
+	std::vector<char> m_Staging;
+	GLsync m_Fences[MaxRegions];
+
+	unsigned int m_StallCount;
+	double m_StallMs;
+
+	void NextRegion();
+
+public:
+	StreamingVertexBuffer(unsigned int regionSize, unsigned int regionCount = 3, bool allowPersistent = true);
+	~StreamingVertexBuffer();
+	StreamingVertexBuffer(const StreamingVertexBuffer&) = delete;
+	StreamingVertexBuffer& operator=(const StreamingVertexBuffer&) = delete;
+
+	using VertexBuffer::Bind;
+	using VertexBuffer::Unbind;
+	using VertexBuffer::GetRendererID;
+	inline const VertexBuffer& GetVertexBuffer() const { return *this; }
+
+	void* Map(unsigned int size);
+	unsigned int Unmap();
+	void EndFrame();
+
+	static bool IsPersistentMappingSupported();
+
+	inline bool IsPersistent() const { return m_Persistent; }
+	inline unsigned int GetRegionSize() const { return m_RegionSize; }
+	inline unsigned int GetStallCount() const { return m_StallCount; }
+	inline double GetStallMs() const { return m_StallMs; }
+	inline void ResetStats() { m_StallCount = 0; m_StallMs = 0.0; }
+};
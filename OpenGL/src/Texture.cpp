@@ -5,12 +5,52 @@
 Texture::Texture(const std::string& path)
 	:m_RendererID(0), m_Filepath(path), m_localBuffer(nullptr), m_Width(0), m_Heigth(0), m_BPP(0)
 {
+	PROFILE_SCOPE("Texture::Load");
 	stbi_set_flip_vertically_on_load(1);
 	m_localBuffer = stbi_load(path.c_str(), &m_Width, &m_Heigth, &m_BPP, 4);
 
-	GLCall(glGenTextures(1, &m_RendererID));
-	GLCall(glBindTexture(GL_TEXTURE_2D, m_RendererID));
+	Create(m_localBuffer);
+
+	if (m_localBuffer)
+		stbi_image_free(m_localBuffer);
 
+}
+
+/* @brief: Creates an RGBA8 texture straight from pixel data already in memory (e.g. the 1x1 white texture used by the batch renderer)
+*/
+Texture::Texture(int width, int height, const void* data)
+	:m_RendererID(0), m_localBuffer(nullptr), m_Width(width), m_Heigth(height), m_BPP(4)
+{
+	Create(data);
+}
+
+/* @brief: Creates the RGBA8 texture of m_Width x m_Heigth from data. With DSA the storage is immutable and nothing
+           gets bound, otherwise the texture is bound to unit 0 to be edited.
+*/
+void Texture::Create(const void* data)
+{
+	if (GLDirectStateAccessActive())
+	{
+		GLCall(glCreateTextures(GL_TEXTURE_2D, 1, &m_RendererID));
+		GLCall(glTextureParameteri(m_RendererID, GL_TEXTURE_MIN_FILTER, GL_LINEAR));
+		GLCall(glTextureParameteri(m_RendererID, GL_TEXTURE_MAG_FILTER, GL_LINEAR));
+		GLCall(glTextureParameteri(m_RendererID, GL_TEXTURE_WRAP_S, GL_CLAMP_TO_EDGE));
+		GLCall(glTextureParameteri(m_RendererID, GL_TEXTURE_WRAP_T, GL_CLAMP_TO_EDGE));
+
+		//A failed load leaves a 0x0 texture, which immutable storage can't have
+		if (m_Width > 0 && m_Heigth > 0)
+		{
+			GLCall(glTextureStorage2D(m_RendererID, 1, GL_RGBA8, m_Width, m_Heigth));
+			if (data)
+			{
+				GLCall(glTextureSubImage2D(m_RendererID, 0, 0, 0, m_Width, m_Heigth, GL_RGBA, GL_UNSIGNED_BYTE, data));
+			}
+		}
+		return;
+	}
+
+	GLCall(glGenTextures(1, &m_RendererID));
+	GLStateCache::Get().BindTexture(m_RendererID);
 
 	//These 4 parameters need to be set for the texture to be shown, otherwise it's going to be a black texture
 	GLCall(glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_LINEAR));
@@ -18,28 +58,52 @@ Texture::Texture(const std::string& path)
 	GLCall(glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_S, GL_CLAMP_TO_EDGE));
 	GLCall(glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_T, GL_CLAMP_TO_EDGE));
 
-	GLCall(glTexImage2D(GL_TEXTURE_2D, 0, GL_RGBA8, m_Width, m_Heigth, 0, GL_RGBA, GL_UNSIGNED_BYTE, m_localBuffer));
-	GLCall(glBindTexture(GL_TEXTURE_2D, 0));
+	GLCall(glTexImage2D(GL_TEXTURE_2D, 0, GL_RGBA8, m_Width, m_Heigth, 0, GL_RGBA, GL_UNSIGNED_BYTE, data));
+	GLStateCache::Get().BindTexture(0);
+}
 
-	if (m_localBuffer)
-		stbi_image_free(m_localBuffer);
+Texture::~Texture()
+{
+	Destroy();
+}
 
+Texture::Texture(Texture&& other) noexcept
+	:m_RendererID(other.m_RendererID), m_Filepath(std::move(other.m_Filepath)), m_localBuffer(nullptr),
+	m_Width(other.m_Width), m_Heigth(other.m_Heigth), m_BPP(other.m_BPP)
+{
+	other.m_RendererID = 0;
 }
 
-Texture::~Texture()
+Texture& Texture::operator=(Texture&& other) noexcept
+{
+	if (this != &other)
+	{
+		Destroy();
+		m_RendererID = other.m_RendererID;
+		m_Filepath = std::move(other.m_Filepath);
+		m_Width = other.m_Width;
+		m_Heigth = other.m_Heigth;
+		m_BPP = other.m_BPP;
+		other.m_RendererID = 0;
+	}
+	return *this;
+}
+
+void Texture::Destroy()
 {
-	
+	if (m_RendererID == 0)
+		return;
+	GLStateCache::Get().OnTextureDeleted(m_RendererID);
 	GLCall(glDeleteTextures(1, &m_RendererID));
+	m_RendererID = 0;
 }
 
 void Texture::Bind(unsigned int slot) const
 {
-
-	GLCall(glActiveTexture(GL_TEXTURE0 + slot));
-	GLCall(glBindTexture(GL_TEXTURE_2D, m_RendererID));
+	GLStateCache::Get().BindTexture(slot, m_RendererID);
 }
 
 void Texture::Unbind() const
 {
-	GLCall(glBindTexture(GL_TEXTURE_2D, 0));
+	GLStateCache::Get().BindTexture(0);
 }
@@ -8,13 +8,21 @@ private:
 	unsigned char* m_localBuffer;
 	int m_Width, m_Heigth, m_BPP;
 
+	void Create(const void* data);
+	void Destroy();
 
 public:
 	Texture(const std::string& path);
+	Texture(int width, int height, const void* data);
 	~Texture();
+	Texture(const Texture&) = delete;
+	Texture& operator=(const Texture&) = delete;
+	Texture(Texture&& other) noexcept;
+	Texture& operator=(Texture&& other) noexcept;
 	void Bind(unsigned int slot = 0) const;
 	void Unbind() const;
 
 	inline int getWidth() const { return m_Width; }
 	inline int getHeigth() const { return m_Heigth; }
+	inline unsigned int GetRendererID() const { return m_RendererID; }
 };
\ No newline at end of file
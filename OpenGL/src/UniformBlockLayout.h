@@ -0,0 +1,168 @@
+#pragma once
+#include <cstddef>
+#include <cstring>
+
+#include "glm/glm.hpp"
+
+/* Memory layout of a uniform block, declared in GLSL with layout(std140) or layout(std430). std430 doesn't pad array
+   elements and matrix columns to 16 bytes, GLSL 330 only allows it on shader storage blocks (GL 4.3). */
+enum class UniformPacking {
+	Std140, Std430
+};
+
+/* Size and alignment of the types a uniform block member can be made of, for UNIFORM_MEMBER. A matrix is an array of
+   Columns column vectors. Anything else fails to compile, bools are 4 bytes in GLSL: use an int. */
+template<typename T>
+struct UniformComponent
+{
+	static_assert(sizeof(T) == 0, "Unsupported uniform block member type, add a UniformComponent specialization for it");
+};
+
+#define UNIFORM_COMPONENT(T, columnSize, columnAlign, columns) \
+	template<> struct UniformComponent<T> { \
+		static const unsigned int ColumnSize = columnSize; \
+		static const unsigned int ColumnAlign = columnAlign; \
+		static const unsigned int Columns = columns; \
+		static const unsigned int Elements = 1; \
+		static const bool Array = false; \
+	}
+
+UNIFORM_COMPONENT(float,        4,  4,  1);
+UNIFORM_COMPONENT(int,          4,  4,  1);
+UNIFORM_COMPONENT(unsigned int, 4,  4,  1);
+UNIFORM_COMPONENT(glm::vec2,    8,  8,  1);
+UNIFORM_COMPONENT(glm::vec3,    12, 16, 1);
+UNIFORM_COMPONENT(glm::vec4,    16, 16, 1);
+UNIFORM_COMPONENT(glm::ivec2,   8,  8,  1);
+UNIFORM_COMPONENT(glm::ivec3,   12, 16, 1);
+UNIFORM_COMPONENT(glm::ivec4,   16, 16, 1);
+UNIFORM_COMPONENT(glm::mat3,    12, 16, 3);
+UNIFORM_COMPONENT(glm::mat4,    16, 16, 4);
+
+#undef UNIFORM_COMPONENT
+
+//Arrays of any of the above, e.g. glm::vec4 Lights[8]
+template<typename T, size_t N>
+struct UniformComponent<T[N]>
+{
+	static_assert(!UniformComponent<T>::Array, "Arrays of arrays aren't supported");
+	static const unsigned int ColumnSize = UniformComponent<T>::ColumnSize;
+	static const unsigned int ColumnAlign = UniformComponent<T>::ColumnAlign;
+	static const unsigned int Columns = UniformComponent<T>::Columns;
+	static const unsigned int Elements = (unsigned int)N;
+	static const bool Array = true;
+};
+
+//Offsets and strides are in bytes
+struct UniformMember
+{
+	//Where the member is in the C++ struct, its columns are tightly packed there
+	unsigned int SourceOffset;
+	unsigned int ColumnSize;
+	unsigned int ColumnAlign;
+	unsigned int Columns;
+	unsigned int Elements;
+	bool Array;
+	//Filled by UniformBlockLayout: where the member goes in the block and the distance between its columns
+	unsigned int Offset;
+	unsigned int Stride;
+};
+
+inline constexpr unsigned int RoundUpUniformOffset(unsigned int offset, unsigned int alignment)
+{
+	return (offset + alignment - 1) / alignment * alignment;
+}
+
+/* A block layout fixed at compile time, made from a C++ struct with MakeUniformBlockLayout:
+     struct Camera { glm::mat4 ViewProjection; glm::vec3 Position; float Time; };
+     constexpr auto layout = MakeUniformBlockLayout<Camera>(UniformPacking::Std140,
+                                                            UNIFORM_MEMBER(Camera, ViewProjection),
+                                                            UNIFORM_MEMBER(Camera, Position),
+                                                            UNIFORM_MEMBER(Camera, Time));
+   The members have to be listed in the order the GLSL block declares them. The constructor applies the packing rules,
+   so the offsets can be checked with static_assert, and Pack copies a struct into the block layout. */
+template<unsigned int N>
+class UniformBlockLayout
+{
+private:
+	static_assert(N > 0, "A uniform block needs at least one member");
+	UniformMember m_Members[N];
+	UniformPacking m_Packing;
+	unsigned int m_SourceSize;
+	unsigned int m_Size;
+
+public:
+	template<typename... Members>
+	constexpr UniformBlockLayout(UniformPacking packing, unsigned int sourceSize, Members... members)
+		: m_Members{ members... }, m_Packing(packing), m_SourceSize(sourceSize), m_Size(0)
+	{
+		unsigned int offset = 0;
+		unsigned int blockAlign = 4;
+		for (unsigned int i = 0; i < N; i++)
+		{
+			UniformMember& member = m_Members[i];
+			unsigned int align = member.ColumnAlign;
+			member.Stride = member.ColumnSize;
+			//Array elements and matrix columns: rounded up to a vec4 in std140, to their own alignment in std430
+			bool strided = member.Array || member.Columns > 1;
+			if (strided)
+			{
+				if (packing == UniformPacking::Std140)
+					align = RoundUpUniformOffset(align, 16);
+				member.Stride = RoundUpUniformOffset(member.ColumnSize, align);
+			}
+			member.Offset = RoundUpUniformOffset(offset, align);
+			offset = member.Offset + (strided ? member.Elements * member.Columns * member.Stride : member.ColumnSize);
+			if (align > blockAlign)
+				blockAlign = align;
+		}
+		m_Size = RoundUpUniformOffset(offset, packing == UniformPacking::Std140 ? 16 : blockAlign);
+	}
+
+	//Size of the block in the buffer, what glBindBufferRange needs at least
+	inline constexpr unsigned int GetSize() const { return m_Size; }
+	inline constexpr unsigned int GetSourceSize() const { return m_SourceSize; }
+	inline constexpr UniformPacking GetPacking() const { return m_Packing; }
+	inline constexpr unsigned int GetMemberCount() const { return N; }
+	inline constexpr unsigned int GetOffset(unsigned int member) const { return m_Members[member].Offset; }
+	inline constexpr unsigned int GetStride(unsigned int member) const { return m_Members[member].Stride; }
+	inline constexpr const UniformMember& operator[](unsigned int member) const { return m_Members[member]; }
+
+	/* @brief: Copies the struct at source into GetSize() bytes at destination, column by column. The padding between
+	   members is left as it is.
+	*/
+	void Pack(const void* source, void* destination) const
+	{
+		const char* src = (const char*)source;
+		char* dst = (char*)destination;
+		for (unsigned int i = 0; i < N; i++)
+		{
+			const UniformMember& member = m_Members[i];
+			unsigned int columns = member.Elements * member.Columns;
+			if (member.Stride == member.ColumnSize)
+			{
+				memcpy(dst + member.Offset, src + member.SourceOffset, columns * member.ColumnSize);
+				continue;
+			}
+			for (unsigned int column = 0; column < columns; column++)
+				memcpy(dst + member.Offset + column * member.Stride, src + member.SourceOffset + column * member.ColumnSize, member.ColumnSize);
+		}
+	}
+};
+
+template<typename T>
+constexpr UniformMember MakeUniformMember(unsigned int sourceOffset)
+{
+	typedef UniformComponent<T> Component;
+	static_assert(sizeof(T) == Component::Elements * Component::Columns * Component::ColumnSize,
+		"The member type isn't tightly packed, its size doesn't match its columns");
+	return { sourceOffset, Component::ColumnSize, Component::ColumnAlign, Component::Columns, Component::Elements, Component::Array, 0, 0 };
+}
+
+#define UNIFORM_MEMBER(Struct, Member) MakeUniformMember<decltype(Struct::Member)>((unsigned int)offsetof(Struct, Member))
+
+template<typename Struct, typename... Members>
+constexpr UniformBlockLayout<sizeof...(Members)> MakeUniformBlockLayout(UniformPacking packing, Members... members)
+{
+	return UniformBlockLayout<sizeof...(Members)>(packing, (unsigned int)sizeof(Struct), members...);
+}
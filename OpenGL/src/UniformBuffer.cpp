@@ -0,0 +1,276 @@
+#include "UniformBuffer.h"
+#include "Renderer.h"
+#include "GLFence.h"
+#include "StreamingVertexBuffer.h"
+
+#include <iostream>
+#include <unordered_map>
+
+static const GLbitfield s_PersistentFlags = GL_MAP_WRITE_BIT | GL_MAP_PERSISTENT_BIT | GL_MAP_COHERENT_BIT;
+
+UniformBuffer::UniformBuffer(unsigned int size)
+{
+    m_RendererID = BufferUploader::CreateBuffer();
+    //Updated between draws reading it, never through a mapping
+    BufferUploader::Get().Allocate(m_RendererID, m_Storage, size, nullptr, BufferUsage::Dynamic);
+}
+
+UniformBuffer::~UniformBuffer()
+{
+    Destroy();
+}
+
+UniformBuffer::UniformBuffer(UniformBuffer&& other) noexcept
+    : m_RendererID(other.m_RendererID), m_Storage(other.m_Storage), m_Packed(std::move(other.m_Packed))
+{
+    other.m_RendererID = 0;
+    other.m_Storage = BufferStorage();
+}
+
+UniformBuffer& UniformBuffer::operator=(UniformBuffer&& other) noexcept
+{
+    if (this != &other)
+    {
+        Destroy();
+        m_RendererID = other.m_RendererID;
+        m_Storage = other.m_Storage;
+        m_Packed = std::move(other.m_Packed);
+        other.m_RendererID = 0;
+        other.m_Storage = BufferStorage();
+    }
+    return *this;
+}
+
+void UniformBuffer::Destroy()
+{
+    if (m_RendererID == 0)
+        return;
+    BufferUploader::Get().Release(m_RendererID, m_Storage);
+    GLStateCache::Get().OnBufferDeleted(m_RendererID);
+    GLCall(glDeleteBuffers(1, &m_RendererID));
+    m_RendererID = 0;
+}
+
+void UniformBuffer::Update(unsigned int offset, const void* data, unsigned int size)
+{
+    BufferUploader::Get().Update(m_RendererID, m_Storage, offset, data, size);
+}
+
+void UniformBuffer::Bind(unsigned int binding) const
+{
+    GLStateCache::Get().BindUniformBuffer(binding, m_RendererID);
+}
+
+unsigned int UniformBuffer::GetBindingPoint(const std::string& blockName)
+{
+    static std::unordered_map<std::string, unsigned int> s_BindingPoints;
+    auto it = s_BindingPoints.find(blockName);
+    if (it != s_BindingPoints.end())
+        return it->second;
+
+    unsigned int binding = (unsigned int)s_BindingPoints.size();
+    ASSERT(binding < GLStateCache::MaxUniformBindings);
+    s_BindingPoints[blockName] = binding;
+    return binding;
+}
+
+unsigned int UniformBuffer::GetOffsetAlignment()
+{
+    static int s_Alignment = 0;
+    if (s_Alignment == 0)
+    {
+        GLCall(glGetIntegerv(GL_UNIFORM_BUFFER_OFFSET_ALIGNMENT, &s_Alignment));
+        if (s_Alignment <= 0)
+            s_Alignment = 256;
+    }
+    return (unsigned int)s_Alignment;
+}
+
+UniformRingBuffer::UniformRingBuffer(unsigned int regionSize, unsigned int regionCount, bool allowPersistent)
+    : m_RendererID(0), m_RegionSize(0), m_RegionCount(regionCount), m_Alignment(UniformBuffer::GetOffsetAlignment()), m_Region(0),
+      m_Offset(0), m_Flushed(0), m_Persistent(allowPersistent && StreamingVertexBuffer::IsPersistentMappingSupported()), m_Mapped(nullptr),
+      m_FlushCount(0), m_StallCount(0), m_StallMs(0.0)
+{
+    ASSERT(regionCount > 0 && regionCount <= MaxRegions);
+    for (unsigned int i = 0; i < MaxRegions; i++)
+        m_Fences[i] = nullptr;
+
+    //Regions have to start on a bindable offset
+    m_RegionSize = RoundUpUniformOffset(regionSize, m_Alignment);
+    if (m_Persistent)
+    {
+        GLsizeiptr size = (GLsizeiptr)m_RegionSize * m_RegionCount;
+        m_RendererID = BufferUploader::CreateBuffer();
+        if (GLDirectStateAccessActive())
+        {
+            GLCall(glNamedBufferStorage(m_RendererID, size, nullptr, s_PersistentFlags));
+            GLCall(m_Mapped = (char*)glMapNamedBufferRange(m_RendererID, 0, size, s_PersistentFlags));
+        }
+        else
+        {
+            GLCall(glBindBuffer(GL_COPY_WRITE_BUFFER, m_RendererID));
+            GLCall(glBufferStorage(GL_COPY_WRITE_BUFFER, size, nullptr, s_PersistentFlags));
+            GLCall(m_Mapped = (char*)glMapBufferRange(GL_COPY_WRITE_BUFFER, 0, size, s_PersistentFlags));
+        }
+        if (m_Mapped)
+            return;
+
+        //Immutable storage can't be respecified, the staging path gets a buffer of its own
+        GLStateCache::Get().OnBufferDeleted(m_RendererID);
+        GLCall(glDeleteBuffers(1, &m_RendererID));
+        m_Persistent = false;
+    }
+
+    //A single region, orphaned every time it fills up
+    m_RegionCount = 1;
+    m_Staging.resize(m_RegionSize);
+    m_RendererID = BufferUploader::CreateBuffer();
+    if (GLDirectStateAccessActive())
+    {
+        GLCall(glNamedBufferData(m_RendererID, m_RegionSize, nullptr, GL_STREAM_DRAW));
+    }
+    else
+    {
+        GLCall(glBindBuffer(GL_COPY_WRITE_BUFFER, m_RendererID));
+        GLCall(glBufferData(GL_COPY_WRITE_BUFFER, m_RegionSize, nullptr, GL_STREAM_DRAW));
+    }
+}
+
+UniformRingBuffer::~UniformRingBuffer()
+{
+    for (unsigned int i = 0; i < MaxRegions; i++)
+    {
+        if (m_Fences[i])
+        {
+            GLCall(glDeleteSync(m_Fences[i]));
+        }
+    }
+    if (m_Mapped)
+    {
+        if (GLDirectStateAccessActive())
+        {
+            GLCall(glUnmapNamedBuffer(m_RendererID));
+        }
+        else
+        {
+            GLCall(glBindBuffer(GL_COPY_WRITE_BUFFER, m_RendererID));
+            GLCall(glUnmapBuffer(GL_COPY_WRITE_BUFFER));
+        }
+    }
+    GLStateCache::Get().OnBufferDeleted(m_RendererID);
+    GLCall(glDeleteBuffers(1, &m_RendererID));
+}
+
+/* @brief: Allocations start on GL_UNIFORM_BUFFER_OFFSET_ALIGNMENT, one that doesn't fit moves on to the next region.
+           Returns nullptr for a block bigger than a region, it can't be stored at all.
+*/
+void* UniformRingBuffer::Allocate(unsigned int size, unsigned int& offset)
+{
+    if (size > m_RegionSize)
+    {
+        std::cout << "Error: uniform block of " << size << " bytes doesn't fit in a " << m_RegionSize << " bytes region" << std::endl;
+        ASSERT(false);
+        offset = 0;
+        return nullptr;
+    }
+    unsigned int start = RoundUpUniformOffset(m_Offset, m_Alignment);
+    if (start + size > m_RegionSize)
+    {
+        NextRegion();
+        start = 0;
+    }
+    m_Offset = start + size;
+
+    offset = m_Region * m_RegionSize + start;
+    if (m_Persistent)
+        return m_Mapped + offset;
+    return m_Staging.data() + start;
+}
+
+unsigned int UniformRingBuffer::Push(const void* data, unsigned int size)
+{
+    unsigned int offset = 0;
+    void* destination = Allocate(size, offset);
+    if (destination)
+        memcpy(destination, data, size);
+    return offset;
+}
+
+/* @brief: Uploads everything pushed since the last flush in one call. The persistent mapping is coherent, there's
+           nothing to do then.
+*/
+void UniformRingBuffer::Flush()
+{
+    if (m_Persistent || m_Flushed == m_Offset)
+    {
+        m_Flushed = m_Offset;
+        return;
+    }
+
+    if (GLDirectStateAccessActive())
+    {
+        //Starting over from the beginning, the storage still used by previous draws is given back to the driver
+        if (m_Flushed == 0)
+        {
+            GLCall(glNamedBufferData(m_RendererID, m_RegionSize, nullptr, GL_STREAM_DRAW));
+        }
+        GLCall(glNamedBufferSubData(m_RendererID, m_Flushed, m_Offset - m_Flushed, m_Staging.data() + m_Flushed));
+    }
+    else
+    {
+        GLCall(glBindBuffer(GL_COPY_WRITE_BUFFER, m_RendererID));
+        if (m_Flushed == 0)
+        {
+            GLCall(glBufferData(GL_COPY_WRITE_BUFFER, m_RegionSize, nullptr, GL_STREAM_DRAW));
+        }
+        GLCall(glBufferSubData(GL_COPY_WRITE_BUFFER, m_Flushed, m_Offset - m_Flushed, m_Staging.data() + m_Flushed));
+    }
+    m_Flushed = m_Offset;
+    m_FlushCount++;
+}
+
+/* @brief: Binds size bytes from offset (returned by Push) to a uniform block binding point
+*/
+void UniformRingBuffer::Bind(unsigned int binding, unsigned int offset, unsigned int size)
+{
+    //Never stored, Allocate already reported it
+    if (size > m_RegionSize)
+        return;
+    if (!m_Persistent && offset + size > m_Flushed)
+        Flush();
+    GLStateCache::Get().BindUniformBuffer(binding, m_RendererID, offset, size);
+}
+
+/* @brief: Moves on to the next region so the next frame doesn't write where this one's draws read from
+*/
+void UniformRingBuffer::EndFrame()
+{
+    if (m_Offset > 0)
+        NextRegion();
+}
+
+/* @brief: Fences the draws issued from the current region and waits until the GPU is done with the next one
+*/
+void UniformRingBuffer::NextRegion()
+{
+    Flush();
+    m_Offset = 0;
+    m_Flushed = 0;
+    if (!m_Persistent)
+        return;
+
+    GLCall(m_Fences[m_Region] = glFenceSync(GL_SYNC_GPU_COMMANDS_COMPLETE, 0));
+    m_Region = (m_Region + 1) % m_RegionCount;
+
+    GLsync fence = m_Fences[m_Region];
+    if (!fence)
+        return;
+    m_Fences[m_Region] = nullptr;
+
+    double stallMs = WaitForFence(fence);
+    if (stallMs > 0.0)
+    {
+        m_StallCount++;
+        m_StallMs += stallMs;
+    }
+}
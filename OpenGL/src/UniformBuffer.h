@@ -0,0 +1,118 @@
+#pragma once
+#include <GL/glew.h>
+#include <string>
+#include <vector>
+
+#include "BufferUploader.h"
+#include "UniformBlockLayout.h"
+
+/* A uniform block shared by every program that declares it, e.g. the camera: updated once per frame and bound once
+   to its binding point instead of set on each program with glUniform*. Shader::SetUniformBlockBinding connects the
+   block of a program to the binding point.
+   The buffer is BufferUsage::Dynamic, updates go through glBufferSubData so updating between draws is safe but each
+   update is a driver copy: data changing per draw belongs in a UniformRingBuffer. */
+class UniformBuffer {
+private:
+	unsigned int m_RendererID;
+	BufferStorage m_Storage;
+	std::vector<char> m_Packed;
+
+	void Destroy();
+
+public:
+	UniformBuffer(unsigned int size);
+	~UniformBuffer();
+	UniformBuffer(const UniformBuffer&) = delete;
+	UniformBuffer& operator=(const UniformBuffer&) = delete;
+	UniformBuffer(UniformBuffer&& other) noexcept;
+	UniformBuffer& operator=(UniformBuffer&& other) noexcept;
+
+	void Update(unsigned int offset, const void* data, unsigned int size);
+
+	//Packs the struct at source with layout and writes it at offset
+	template<unsigned int N>
+	void SetData(const void* source, const UniformBlockLayout<N>& layout, unsigned int offset = 0)
+	{
+		m_Packed.resize(layout.GetSize());
+		layout.Pack(source, m_Packed.data());
+		Update(offset, m_Packed.data(), layout.GetSize());
+	}
+
+	void Bind(unsigned int binding) const;
+	inline unsigned int GetSize() const { return m_Storage.Size; }
+	inline unsigned int GetRendererID() const { return m_RendererID; }
+
+	/* @brief: The binding point of a block name, handed out in order on first use. Programs declaring the same block
+	   all get it on the same point, see Shader::SetUniformBlockBinding.
+	*/
+	static unsigned int GetBindingPoint(const std::string& blockName);
+	//GL_UNIFORM_BUFFER_OFFSET_ALIGNMENT, glBindBufferRange offsets are multiples of it
+	static unsigned int GetOffsetAlignment();
+};
+
+/* Per draw (or per material) blocks of a frame written one after the other into one buffer, each bound with
+   glBindBufferRange, instead of a glUniform* call per uniform per draw.
+   Like StreamingVertexBuffer, with GL 4.4 / ARB_buffer_storage the buffer is split into regionCount persistently
+   mapped regions guarded by fences, and Push writes straight into the mapping. Without it Push writes to a staging
+   copy and Flush uploads everything pushed since the previous flush with a single glBufferSubData, the buffer being
+   orphaned each time writing starts over from the beginning. It is also the path taken when the mapping fails.
+   Bind flushes by itself when the range hasn't been uploaded yet, pushing everything before the first Bind of the
+   frame gets the whole frame uploaded at once. An offset stays valid until the region it is in gets reused, so a
+   frame must fit in a region. */
+class UniformRingBuffer {
+public:
+	static const unsigned int MaxRegions = 8;
+
+private:
+	unsigned int m_RendererID;
+	unsigned int m_RegionSize;
+	unsigned int m_RegionCount;
+	unsigned int m_Alignment;
+	unsigned int m_Region;
+	unsigned int m_Offset;
+	unsigned int m_Flushed;
+
+	bool m_Persistent;
+	char* m_Mapped;
+	std::vector<char> m_Staging;
+	GLsync m_Fences[MaxRegions];
+
+	unsigned int m_FlushCount;
+	unsigned int m_StallCount;
+	double m_StallMs;
+
+	void NextRegion();
+
+public:
+	UniformRingBuffer(unsigned int regionSize, unsigned int regionCount = 3, bool allowPersistent = true);
+	~UniformRingBuffer();
+	UniformRingBuffer(const UniformRingBuffer&) = delete;
+	UniformRingBuffer& operator=(const UniformRingBuffer&) = delete;
+
+	//Returns where to write size bytes, offset gets the buffer offset to Bind them from. nullptr when size is over a region
+	void* Allocate(unsigned int size, unsigned int& offset);
+	unsigned int Push(const void* data, unsigned int size);
+
+	//Packs the struct at source with layout, returns the offset to Bind it from
+	template<unsigned int N>
+	unsigned int Push(const void* source, const UniformBlockLayout<N>& layout)
+	{
+		unsigned int offset = 0;
+		void* destination = Allocate(layout.GetSize(), offset);
+		if (destination)
+			layout.Pack(source, destination);
+		return offset;
+	}
+
+	void Flush();
+	void Bind(unsigned int binding, unsigned int offset, unsigned int size);
+	void EndFrame();
+
+	inline bool IsPersistent() const { return m_Persistent; }
+	inline unsigned int GetRegionSize() const { return m_RegionSize; }
+	inline unsigned int GetRendererID() const { return m_RendererID; }
+	inline unsigned int GetFlushCount() const { return m_FlushCount; }
+	inline unsigned int GetStallCount() const { return m_StallCount; }
+	inline double GetStallMs() const { return m_StallMs; }
+	inline void ResetStats() { m_FlushCount = 0; m_StallCount = 0; m_StallMs = 0.0; }
+};
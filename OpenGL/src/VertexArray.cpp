@@ -3,40 +3,126 @@
 #include "VertexBufferLayout.h"
 
 VertexArray::VertexArray()
+    : m_AttribCount(0)
 {
-    GLCall(glGenVertexArrays(1, &m_RendererID));
+    if (GLDirectStateAccessActive())
+    {
+        GLCall(glCreateVertexArrays(1, &m_RendererID));
+    }
+    else
+    {
+        GLCall(glGenVertexArrays(1, &m_RendererID));
+    }
 }
 
 VertexArray::~VertexArray()
 {
+    Destroy();
+}
+
+VertexArray::VertexArray(VertexArray&& other) noexcept
+    : m_RendererID(other.m_RendererID), m_AttribCount(other.m_AttribCount)
+{
+    other.m_RendererID = 0;
+    other.m_AttribCount = 0;
+}
+
+VertexArray& VertexArray::operator=(VertexArray&& other) noexcept
+{
+    if (this != &other)
+    {
+        Destroy();
+        m_RendererID = other.m_RendererID;
+        m_AttribCount = other.m_AttribCount;
+        other.m_RendererID = 0;
+        other.m_AttribCount = 0;
+    }
+    return *this;
+}
+
+void VertexArray::Destroy()
+{
+    if (m_RendererID == 0)
+        return;
+    GLStateCache::Get().OnVertexArrayDeleted(m_RendererID);
     GLCall(glDeleteVertexArrays(1, &m_RendererID));
+    m_RendererID = 0;
 }
 
 void VertexArray::Bind() const
 {
-    GLCall(glBindVertexArray(m_RendererID));
+    GLStateCache::Get().BindVertexArray(m_RendererID);
 }
 
 void VertexArray::Unbind() const
 {
-    GLCall(glBindVertexArray(0));
+    GLStateCache::Get().BindVertexArray(0);
 }
 
 /* @brief: Binds thevertex array and the vertex buffer we want to set up with it. Also sets the vb layout
+           Attributes continue after the ones of the previous buffers, so a per-vertex buffer followed by a
+           per-instance buffer gets locations 0..n-1 then n..
 */
 
 void VertexArray::AddBuffer(const VertexBuffer& vb, const VertexBufferLayout& layout)
 {
+    AddBuffer(vb, layout, m_AttribCount);
+}
+
+/* @brief: Same as above with the first attribute location given explicitly, to match the layout(location = n) of a shader
+*/
+void VertexArray::AddBuffer(const VertexBuffer& vb, const VertexBufferLayout& layout, unsigned int attribBase)
+{
+    const std::vector<VertexBufferElement>& elements = layout.GetElements();
+    AddElements(vb, elements.data(), (unsigned int)elements.size(), layout.GetStride(), attribBase);
+}
+
+//What both kinds of layout come down to, count elements at their offset in a vertex of stride bytes
+void VertexArray::AddElements(const VertexBuffer& vb, const VertexBufferElement* elements, unsigned int count, unsigned int stride, unsigned int attribBase)
+{
+    if (GLDirectStateAccessActive())
+    {
+        AddElementsNamed(vb, elements, count, stride, attribBase);
+        return;
+    }
+
     Bind();
 	vb.Bind();
-    const std::vector<VertexBufferElement>& elements = layout.GetElements();
-    unsigned int offset = 0;
-    for (unsigned int i = 0; i < elements.size(); i++) 
+    for (unsigned int i = 0; i < count; i++) 
     {
         const auto& element = elements[i];
-        GLCall(glEnableVertexAttribArray(i));
-        GLCall(glVertexAttribPointer(i, element.count,  element.type,  element.normalized,
-            layout.GetStride(), (const void*) offset));
-        offset += element.count * VertexBufferElement::GetSizeOfType(element.type);
+        unsigned int index = attribBase + i;
+        GLCall(glEnableVertexAttribArray(index));
+        GLCall(glVertexAttribPointer(index, element.count,  element.type,  element.normalized,
+            stride, (const void*) element.offset));
+        GLCall(glVertexAttribDivisor(index, element.divisor));
     }
+
+    if (attribBase + count > m_AttribCount)
+        m_AttribCount = attribBase + count;
+}
+
+/* @brief: The DSA version, the buffer goes to binding point attribBase and its attributes read from there. The divisor
+           belongs to the binding point, so all the elements of the layout have to share it.
+*/
+void VertexArray::AddElementsNamed(const VertexBuffer& vb, const VertexBufferElement* elements, unsigned int count, unsigned int stride, unsigned int attribBase)
+{
+    unsigned int binding = attribBase;
+    for (unsigned int i = 0; i < count; i++)
+    {
+        const auto& element = elements[i];
+        unsigned int index = attribBase + i;
+        ASSERT(element.divisor == elements[0].divisor);
+        GLCall(glEnableVertexArrayAttrib(m_RendererID, index));
+        GLCall(glVertexArrayAttribFormat(m_RendererID, index, element.count, element.type, element.normalized, element.offset));
+        GLCall(glVertexArrayAttribBinding(m_RendererID, index, binding));
+    }
+    GLCall(glVertexArrayVertexBuffer(m_RendererID, binding, vb.GetRendererID(), 0, stride));
+    if (count > 0)
+    {
+        GLCall(glVertexArrayBindingDivisor(m_RendererID, binding, elements[0].divisor));
+    }
+
+    if (attribBase + count > m_AttribCount)
+        m_AttribCount = attribBase + count;
 }
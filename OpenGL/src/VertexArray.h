@@ -2,15 +2,42 @@
 #include"VertexBuffer.h"
 
 class VertexBufferLayout;
+struct VertexBufferElement;
+template<unsigned int N> class StaticVertexLayout;
 
 class VertexArray {
 private:
 	unsigned int m_RendererID;
+	unsigned int m_AttribCount;
+
+	void Destroy();
+	void AddElements(const VertexBuffer& vb, const VertexBufferElement* elements, unsigned int count, unsigned int stride, unsigned int attribBase);
+	void AddElementsNamed(const VertexBuffer& vb, const VertexBufferElement* elements, unsigned int count, unsigned int stride, unsigned int attribBase);
 public:
 	VertexArray();
 	~VertexArray();
+	VertexArray(const VertexArray&) = delete;
+	VertexArray& operator=(const VertexArray&) = delete;
+	VertexArray(VertexArray&& other) noexcept;
+	VertexArray& operator=(VertexArray&& other) noexcept;
 	void Bind() const;
 	void Unbind() const;
+	inline unsigned int GetRendererID() const { return m_RendererID; }
 
 	void AddBuffer(const VertexBuffer& vb, const VertexBufferLayout& layout);
+	void AddBuffer(const VertexBuffer& vb, const VertexBufferLayout& layout, unsigned int attribBase);
+
+	template<unsigned int N>
+	void AddBuffer(const VertexBuffer& vb, const StaticVertexLayout<N>& layout)
+	{
+		AddElements(vb, layout.GetElements(), N, layout.GetStride(), m_AttribCount);
+	}
+
+	template<unsigned int N>
+	void AddBuffer(const VertexBuffer& vb, const StaticVertexLayout<N>& layout, unsigned int attribBase)
+	{
+		AddElements(vb, layout.GetElements(), N, layout.GetStride(), attribBase);
+	}
+
+	inline unsigned int GetAttribCount() const { return m_AttribCount; }
 };
\ No newline at end of file
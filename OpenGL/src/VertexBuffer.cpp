@@ -3,22 +3,76 @@
 
 VertexBuffer::VertexBuffer(const void* data, unsigned int size)
 {
-    GLCall(glGenBuffers(1, &m_RendererID));
-    GLCall(glBindBuffer(GL_ARRAY_BUFFER,m_RendererID));
-    GLCall(glBufferData(GL_ARRAY_BUFFER, size, data, GL_STATIC_DRAW));
+    m_RendererID = BufferUploader::CreateBuffer();
+    BufferUploader::Get().Allocate(m_RendererID, m_Storage, size, data, BufferUsage::Static);
+}
+
+VertexBuffer::VertexBuffer()
+{
+    m_RendererID = BufferUploader::CreateBuffer();
+}
+
+/* @brief: Allocates an empty buffer meant to be refilled through Update or SetData, see BufferUsage
+*/
+VertexBuffer::VertexBuffer(unsigned int size, BufferUsage usage)
+{
+    m_RendererID = BufferUploader::CreateBuffer();
+    BufferUploader::Get().Allocate(m_RendererID, m_Storage, size, nullptr, usage);
 }
 
 VertexBuffer::~VertexBuffer()
 {
+    Destroy();
+}
+
+VertexBuffer::VertexBuffer(VertexBuffer&& other) noexcept
+    : m_RendererID(other.m_RendererID), m_Storage(other.m_Storage)
+{
+    other.m_RendererID = 0;
+    other.m_Storage = BufferStorage();
+}
+
+VertexBuffer& VertexBuffer::operator=(VertexBuffer&& other) noexcept
+{
+    if (this != &other)
+    {
+        Destroy();
+        m_RendererID = other.m_RendererID;
+        m_Storage = other.m_Storage;
+        other.m_RendererID = 0;
+        other.m_Storage = BufferStorage();
+    }
+    return *this;
+}
+
+void VertexBuffer::Destroy()
+{
+    if (m_RendererID == 0)
+        return;
+    BufferUploader::Get().Release(m_RendererID, m_Storage);
+    GLStateCache::Get().OnBufferDeleted(m_RendererID);
     GLCall(glDeleteBuffers(1, &m_RendererID));
+    m_RendererID = 0;
 }
 
 void VertexBuffer::Bind() const
 {
-    GLCall(glBindBuffer(GL_ARRAY_BUFFER, m_RendererID));
+    GLStateCache::Get().BindArrayBuffer(m_RendererID);
 }
 
 void VertexBuffer::Unbind() const
 {
-    GLCall(glBindBuffer(GL_ARRAY_BUFFER, 0));
+    GLStateCache::Get().BindArrayBuffer(0);
+}
+
+/* @brief: Writes size bytes at offset, through the upload strategy the buffer was created with
+*/
+void VertexBuffer::Update(unsigned int offset, const void* data, unsigned int size)
+{
+    BufferUploader::Get().Update(m_RendererID, m_Storage, offset, data, size);
+}
+
+void VertexBuffer::SetData(const void* data, unsigned int size)
+{
+    Update(0, data, size);
 }
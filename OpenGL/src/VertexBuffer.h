@@ -1,16 +1,35 @@
 #pragma once
+#include "BufferUploader.h"
 
+/* Owns its GL buffer: copies are deleted so the id is never deleted twice, a move leaves id 0 behind, which
+   deletes nothing. Same for IndexBuffer, VertexArray, Texture, Shader, IndirectDrawBuffer and Framebuffer. */
 class VertexBuffer {
 
-private:
+protected:
 	unsigned int m_RendererID;
+	BufferStorage m_Storage;
+
+	void Destroy();
+
+	//Generates the buffer without any storage, for buffers that allocate it differently
+	VertexBuffer();
 
 public:
 	VertexBuffer(const void* data, unsigned int size);
+	VertexBuffer(unsigned int size, BufferUsage usage = BufferUsage::Dynamic);
 	~VertexBuffer();
+	VertexBuffer(const VertexBuffer&) = delete;
+	VertexBuffer& operator=(const VertexBuffer&) = delete;
+	VertexBuffer(VertexBuffer&& other) noexcept;
+	VertexBuffer& operator=(VertexBuffer&& other) noexcept;
 
 	void Bind() const;
 	void Unbind() const;
 
+	void Update(unsigned int offset, const void* data, unsigned int size);
+	void SetData(const void* data, unsigned int size);
 
+	inline unsigned int GetRendererID() const { return m_RendererID; }
+	inline unsigned int GetSize() const { return m_Storage.Size; }
+	inline UploadStrategy GetUploadStrategy() const { return m_Storage.Strategy; }
 };
\ No newline at end of file
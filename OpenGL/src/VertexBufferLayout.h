@@ -1,7 +1,11 @@
 #pragma once
+#include <cstddef>
 #include <vector>
 #include "GL/glew.h"
 #include "Renderer.h"
+#include "VertexQuantization.h"
+
+#include "glm/glm.hpp"
 
 
 struct VertexBufferElement
@@ -9,19 +13,73 @@ struct VertexBufferElement
 	unsigned int type;
 	unsigned int count;
 	unsigned char normalized;
+	//0 advances the attribute per vertex, n advances it once every n instances
+	unsigned int divisor;
+	//Bytes from the start of the vertex
+	unsigned int offset;
 
-	static unsigned int GetSizeOfType(unsigned int type) 
+	static constexpr unsigned int GetSizeOfType(unsigned int type) 
 	{
 		switch (type)
 		{
-			case GL_FLOAT:         return 4;
-			case GL_UNSIGNED_INT:  return 4;
-			case GL_UNSIGNED_BYTE: return 1;
+			case GL_FLOAT:              return 4;
+			case GL_UNSIGNED_INT:       return 4;
+			case GL_UNSIGNED_BYTE:      return 1;
+			case GL_HALF_FLOAT:         return 2;
+			case GL_SHORT:              return 2;
+			case GL_UNSIGNED_SHORT:     return 2;
+			//The 4 components share one 32 bit value
+			case GL_INT_2_10_10_10_REV: return 4;
 		}
 		ASSERT(false);
+		return 0;
+	}
 
+	//Size of the whole attribute in a vertex
+	inline constexpr unsigned int GetSize() const
+	{
+		return type == GL_INT_2_10_10_10_REV ? GetSizeOfType(type) : count * GetSizeOfType(type);
 	}
 };
+
+/* GL type, component count and normalization of the types a vertex attribute can be made of, for Push<T> and
+   VERTEX_ATTRIBUTE. Anything else fails to compile. */
+template<typename T>
+struct VertexComponent
+{
+	static_assert(sizeof(T) == 0, "Unsupported vertex component type, add a VertexComponent specialization for it");
+};
+
+#define VERTEX_COMPONENT(T, glType, components, normalize) \
+	template<> struct VertexComponent<T> { \
+		static const unsigned int Type = glType; \
+		static const unsigned int Count = components; \
+		static const unsigned char Normalized = normalize; \
+	}
+
+VERTEX_COMPONENT(float,           GL_FLOAT,              1, GL_FALSE);
+VERTEX_COMPONENT(glm::vec2,       GL_FLOAT,              2, GL_FALSE);
+VERTEX_COMPONENT(glm::vec3,       GL_FLOAT,              3, GL_FALSE);
+VERTEX_COMPONENT(glm::vec4,       GL_FLOAT,              4, GL_FALSE);
+VERTEX_COMPONENT(unsigned int,    GL_UNSIGNED_INT,       1, GL_FALSE);
+VERTEX_COMPONENT(unsigned char,   GL_UNSIGNED_BYTE,      1, GL_TRUE);
+VERTEX_COMPONENT(Half,            GL_HALF_FLOAT,         1, GL_FALSE);
+VERTEX_COMPONENT(Snorm16,         GL_SHORT,              1, GL_TRUE);
+VERTEX_COMPONENT(Unorm16,         GL_UNSIGNED_SHORT,     1, GL_TRUE);
+VERTEX_COMPONENT(Snorm2_10_10_10, GL_INT_2_10_10_10_REV, 4, GL_TRUE);
+
+#undef VERTEX_COMPONENT
+
+//Arrays of components, e.g. float Position[3]
+template<typename T, size_t N>
+struct VertexComponent<T[N]>
+{
+	static_assert(VertexComponent<T>::Type != GL_INT_2_10_10_10_REV, "An attribute holds a single packed 2_10_10_10 value");
+	static const unsigned int Type = VertexComponent<T>::Type;
+	static const unsigned int Count = (unsigned int)N * VertexComponent<T>::Count;
+	static const unsigned char Normalized = VertexComponent<T>::Normalized;
+};
+
 class VertexBufferLayout 
 {
 private:
@@ -32,33 +90,70 @@ public:
 	VertexBufferLayout()
 		:m_Stride(0) {}
 
+	/* @brief: Adds an attribute of count components of type T, packed right after the previous one. Snorm2_10_10_10
+	   always has 4 components (a shader reading a vec3 ignores w), count has to be 4.
+	*/
 	template<typename T>
 	void Push(unsigned int count)
 	{
-		//static_assert(false);
+		typedef VertexComponent<T> Component;
+		bool packed = Component::Type == GL_INT_2_10_10_10_REV;
+		ASSERT(!packed || count == 4);
+		m_Elements.push_back({ Component::Type, packed ? 4u : count * Component::Count, Component::Normalized, 0, m_Stride });
+		m_Stride += m_Elements.back().GetSize();
 	}
 
-	template<>
-	void Push<float>(unsigned int count) 
+	/* @brief: Adds an attribute read once per instance (or every divisor instances) instead of once per vertex.
+	   A layout used for per-instance data should only contain instanced elements.
+	*/
+	template<typename T>
+	void PushInstanced(unsigned int count, unsigned int divisor = 1)
 	{
-		m_Elements.push_back({GL_FLOAT, count, GL_FALSE});
-		m_Stride += VertexBufferElement::GetSizeOfType(GL_FLOAT) * count;
+		Push<T>(count);
+		m_Elements.back().divisor = divisor;
 	}
 
-	template<>
-	void Push<unsigned int>(unsigned int count)
-	{
-		m_Elements.push_back({ GL_UNSIGNED_INT, count, GL_FALSE});
-		m_Stride += VertexBufferElement::GetSizeOfType(GL_UNSIGNED_INT) * count;
-	}
+	inline const std::vector<VertexBufferElement>& GetElements() const { return m_Elements; }
+	inline unsigned int GetStride() const { return m_Stride; }
+};
 
-	template<>
-	void Push<unsigned char>(unsigned int count)
-	{
-		m_Elements.push_back({ GL_UNSIGNED_BYTE, count, GL_TRUE });
-		m_Stride += VertexBufferElement::GetSizeOfType(GL_UNSIGNED_BYTE) * count;
-	}
+/* A layout fixed at compile time, made from a vertex struct with MakeVertexLayout:
+     constexpr auto layout = MakeVertexLayout<QuadVertex>(VERTEX_ATTRIBUTE(QuadVertex, Position),
+                                                          VERTEX_ATTRIBUTE(QuadVertex, TexCoord));
+   The attributes get their GL type from the member type, their offset from offsetof and the stride is the size of the
+   struct, so padding is taken into account. The elements are stored in the object, nothing is allocated. */
+template<unsigned int N>
+class StaticVertexLayout
+{
+private:
+	static_assert(N > 0, "A vertex layout needs at least one attribute");
+	VertexBufferElement m_Elements[N];
+	unsigned int m_Stride;
 
-	inline const std::vector<VertexBufferElement> GetElements() const& { return m_Elements; }
-	inline unsigned int GetStride() const { return m_Stride; }
-};
\ No newline at end of file
+public:
+	template<typename... Elements>
+	constexpr StaticVertexLayout(unsigned int stride, Elements... elements)
+		: m_Elements{ elements... }, m_Stride(stride) {}
+
+	inline constexpr const VertexBufferElement* GetElements() const { return m_Elements; }
+	inline constexpr unsigned int GetElementCount() const { return N; }
+	inline constexpr unsigned int GetStride() const { return m_Stride; }
+	inline constexpr const VertexBufferElement& operator[](unsigned int i) const { return m_Elements[i]; }
+};
+
+template<typename T>
+constexpr VertexBufferElement MakeVertexElement(unsigned int offset)
+{
+	typedef VertexComponent<T> Component;
+	static_assert(sizeof(T) == (Component::Type == GL_INT_2_10_10_10_REV ? 4 : Component::Count * VertexBufferElement::GetSizeOfType(Component::Type)),
+		"The member type isn't tightly packed, its size doesn't match its GL type");
+	return { Component::Type, Component::Count, Component::Normalized, 0, offset };
+}
+
+#define VERTEX_ATTRIBUTE(Vertex, Member) MakeVertexElement<decltype(Vertex::Member)>((unsigned int)offsetof(Vertex, Member))
+
+template<typename Vertex, typename... Elements>
+constexpr StaticVertexLayout<sizeof...(Elements)> MakeVertexLayout(Elements... elements)
+{
+	return StaticVertexLayout<sizeof...(Elements)>((unsigned int)sizeof(Vertex), elements...);
+}
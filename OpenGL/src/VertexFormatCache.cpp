@@ -0,0 +1,154 @@
+#include "VertexFormatCache.h"
+#include "Renderer.h"
+#include "VertexBuffer.h"
+
+//FNV-1a over the 32 bit words of the format
+static void HashWord(unsigned long long& hash, unsigned int word)
+{
+    for (unsigned int i = 0; i < 4; i++)
+    {
+        hash ^= (word >> (8 * i)) & 0xFF;
+        hash *= 1099511628211ull;
+    }
+}
+
+VertexFormat::VertexFormat(const VertexBufferElement* elements, unsigned int count, unsigned int stride)
+    : m_Elements(elements, elements + count), m_Stride(stride), m_Hash(14695981039346656037ull)
+{
+    for (const VertexBufferElement& element : m_Elements)
+    {
+        HashWord(m_Hash, element.type);
+        HashWord(m_Hash, element.count);
+        HashWord(m_Hash, element.normalized);
+        HashWord(m_Hash, element.divisor);
+        HashWord(m_Hash, element.offset);
+    }
+    HashWord(m_Hash, m_Stride);
+}
+
+VertexFormat::VertexFormat(const VertexBufferLayout& layout)
+    : VertexFormat(layout.GetElements().data(), (unsigned int)layout.GetElements().size(), layout.GetStride())
+{
+}
+
+bool VertexFormat::operator==(const VertexFormat& other) const
+{
+    if (m_Hash != other.m_Hash || m_Stride != other.m_Stride || m_Elements.size() != other.m_Elements.size())
+        return false;
+    for (unsigned int i = 0; i < m_Elements.size(); i++)
+    {
+        const VertexBufferElement& a = m_Elements[i];
+        const VertexBufferElement& b = other.m_Elements[i];
+        if (a.type != b.type || a.count != b.count || a.normalized != b.normalized || a.divisor != b.divisor || a.offset != b.offset)
+            return false;
+    }
+    return true;
+}
+
+VertexFormatCache::VertexFormatCache()
+    : m_AttribBinding(false)
+{
+    //GLTrace doesn't trace glBindVertexBuffer and glVertexAttribFormat, traced builds use attribute pointers
+#ifndef OGL_TRACE
+    m_AttribBinding = GLEW_VERSION_4_3 || GLEW_ARB_vertex_attrib_binding;
+#endif
+}
+
+VertexFormatCache& VertexFormatCache::Get()
+{
+    static VertexFormatCache cache;
+    return cache;
+}
+
+/* @brief: Creates the vertex array of a format with its attributes on binding point 0 and no buffer yet
+*/
+unsigned int VertexFormatCache::CreateVertexArray(const VertexFormat& format) const
+{
+    const std::vector<VertexBufferElement>& elements = format.GetElements();
+    unsigned int vertexArray;
+    if (GLDirectStateAccessActive())
+    {
+        GLCall(glCreateVertexArrays(1, &vertexArray));
+        for (unsigned int i = 0; i < elements.size(); i++)
+        {
+            const auto& element = elements[i];
+            ASSERT(element.divisor == elements[0].divisor);
+            GLCall(glEnableVertexArrayAttrib(vertexArray, i));
+            GLCall(glVertexArrayAttribFormat(vertexArray, i, element.count, element.type, element.normalized, element.offset));
+            GLCall(glVertexArrayAttribBinding(vertexArray, i, 0));
+        }
+        if (!elements.empty())
+        {
+            GLCall(glVertexArrayBindingDivisor(vertexArray, 0, elements[0].divisor));
+        }
+        return vertexArray;
+    }
+
+    GLCall(glGenVertexArrays(1, &vertexArray));
+    GLStateCache::Get().BindVertexArray(vertexArray);
+    for (unsigned int i = 0; i < elements.size(); i++)
+    {
+        const auto& element = elements[i];
+        ASSERT(element.divisor == elements[0].divisor);
+        GLCall(glEnableVertexAttribArray(i));
+        if (m_AttribBinding)
+        {
+            GLCall(glVertexAttribFormat(i, element.count, element.type, element.normalized, element.offset));
+            GLCall(glVertexAttribBinding(i, 0));
+        }
+        else
+        {
+            GLCall(glVertexAttribDivisor(i, element.divisor));
+        }
+    }
+    if (m_AttribBinding && !elements.empty())
+    {
+        GLCall(glVertexBindingDivisor(0, elements[0].divisor));
+    }
+    return vertexArray;
+}
+
+//Fallback without ARB_vertex_attrib_binding, the buffer is captured by glVertexAttribPointer
+void VertexFormatCache::SetAttribPointers(const VertexFormat& format, const VertexBuffer& vb) const
+{
+    vb.Bind();
+    const std::vector<VertexBufferElement>& elements = format.GetElements();
+    for (unsigned int i = 0; i < elements.size(); i++)
+    {
+        const auto& element = elements[i];
+        GLCall(glVertexAttribPointer(i, element.count, element.type, element.normalized, format.GetStride(), (const void*)(size_t)element.offset));
+    }
+}
+
+unsigned int VertexFormatCache::GetVertexArray(const VertexFormat& format)
+{
+    auto it = m_VertexArrays.find(format);
+    if (it != m_VertexArrays.end())
+        return it->second;
+    unsigned int vertexArray = CreateVertexArray(format);
+    m_VertexArrays.emplace(format, vertexArray);
+    return vertexArray;
+}
+
+/* @brief: Binds the vertex array of the format with vb as its vertex buffer. The element buffer binding is part of the
+           shared vertex array too, bind the index buffer after this.
+*/
+void VertexFormatCache::Bind(const VertexFormat& format, const VertexBuffer& vb)
+{
+    GLStateCache& state = GLStateCache::Get();
+    state.BindVertexArray(GetVertexArray(format));
+    if (m_AttribBinding)
+        state.BindVertexBuffer(vb.GetRendererID(), format.GetStride());
+    else
+        SetAttribPointers(format, vb);
+}
+
+void VertexFormatCache::Clear()
+{
+    for (auto& entry : m_VertexArrays)
+    {
+        GLStateCache::Get().OnVertexArrayDeleted(entry.second);
+        GLCall(glDeleteVertexArrays(1, &entry.second));
+    }
+    m_VertexArrays.clear();
+}
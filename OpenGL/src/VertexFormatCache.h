@@ -0,0 +1,60 @@
+#pragma once
+#include <unordered_map>
+#include <vector>
+
+#include "VertexBufferLayout.h"
+
+class VertexBuffer;
+
+/* The attribute formats of a VertexBufferLayout without any buffer, so meshes with the same layout compare equal.
+   The hash covers the type, count, normalization, divisor and offset of every element and the stride. */
+class VertexFormat {
+private:
+	std::vector<VertexBufferElement> m_Elements;
+	unsigned int m_Stride;
+	unsigned long long m_Hash;
+
+public:
+	VertexFormat(const VertexBufferElement* elements, unsigned int count, unsigned int stride);
+	explicit VertexFormat(const VertexBufferLayout& layout);
+	template<unsigned int N>
+	explicit VertexFormat(const StaticVertexLayout<N>& layout)
+		: VertexFormat(layout.GetElements(), N, layout.GetStride()) {}
+
+	bool operator==(const VertexFormat& other) const;
+	inline bool operator!=(const VertexFormat& other) const { return !(*this == other); }
+
+	inline const std::vector<VertexBufferElement>& GetElements() const { return m_Elements; }
+	inline unsigned int GetStride() const { return m_Stride; }
+	inline unsigned long long GetHash() const { return m_Hash; }
+};
+
+struct VertexFormatHash {
+	inline size_t operator()(const VertexFormat& format) const { return (size_t)format.GetHash(); }
+};
+
+/* One vertex array per VertexFormat, shared by every vertex buffer of that format. The attributes read from vertex
+   binding point 0 and Bind only swaps the buffer on it with glBindVertexBuffer (GL 4.3 / ARB_vertex_attrib_binding),
+   so switching between meshes of the same format is a single call, or none when GLStateCache sees it's redundant.
+   Without the extension the attribute pointers are set again on every Bind.
+   All the elements of a format share binding point 0, so they need the same divisor. */
+class VertexFormatCache {
+private:
+	std::unordered_map<VertexFormat, unsigned int, VertexFormatHash> m_VertexArrays;
+	bool m_AttribBinding;
+
+	VertexFormatCache();
+	unsigned int CreateVertexArray(const VertexFormat& format) const;
+	void SetAttribPointers(const VertexFormat& format, const VertexBuffer& vb) const;
+
+public:
+	static VertexFormatCache& Get();
+
+	unsigned int GetVertexArray(const VertexFormat& format);
+	void Bind(const VertexFormat& format, const VertexBuffer& vb);
+	//Deletes the vertex arrays, has to run while the context is still current
+	void Clear();
+
+	inline unsigned int GetVertexArrayCount() const { return (unsigned int)m_VertexArrays.size(); }
+	inline bool IsAttribBindingSupported() const { return m_AttribBinding; }
+};
@@ -0,0 +1,191 @@
+#include "VertexQuantization.h"
+
+#include <cmath>
+#include <cstring>
+
+#if defined(_M_X64) || defined(__SSE2__)
+#define OGL_QUANTIZATION_SSE2
+#include <emmintrin.h>
+#endif
+
+static inline float Clamp(float value, float min, float max)
+{
+    //Written so NaN ends up at min, like _mm_max_ps/_mm_min_ps do
+    value = value > min ? value : min;
+    return value < max ? value : max;
+}
+
+/* @brief: Rebiases the exponent from 127 to 15 and rounds on the 13 dropped mantissa bits, a carry into the exponent
+           is the correct rounding. Exponents under -14 go to 0, over 15 to infinity, NaN stays NaN.
+*/
+uint16_t VertexQuantization::FloatToHalf(float value)
+{
+    uint32_t bits;
+    memcpy(&bits, &value, sizeof(bits));
+
+    uint32_t sign = (bits >> 16) & 0x8000;
+    int32_t magnitude = bits & 0x7FFFFFFF;
+    int32_t half = (magnitude - (112 << 23) + (1 << 12)) >> 13;
+    half = magnitude < (113 << 23) ? 0 : half;
+    half = magnitude >= (143 << 23) - (1 << 12) ? 0x7C00 : half;
+    half = magnitude > (255 << 23) ? 0x7E00 : half;
+    return (uint16_t)(sign | half);
+}
+
+float VertexQuantization::HalfToFloat(uint16_t bits)
+{
+    uint32_t sign = (uint32_t)(bits & 0x8000) << 16;
+    uint32_t exponent = (bits >> 10) & 0x1F;
+    uint32_t mantissa = bits & 0x3FF;
+
+    float value;
+    if (exponent == 0)
+        value = std::ldexp((float)mantissa, -24);
+    else if (exponent == 31)
+        value = mantissa ? NAN : INFINITY;
+    else
+        value = std::ldexp((float)(mantissa | 0x400), (int)exponent - 25);
+    uint32_t result;
+    memcpy(&result, &value, sizeof(result));
+    result |= sign;
+    memcpy(&value, &result, sizeof(value));
+    return value;
+}
+
+int16_t VertexQuantization::FloatToSnorm16(float value)
+{
+    return (int16_t)std::lrint(Clamp(value, -1.0f, 1.0f) * 32767.0f);
+}
+
+uint16_t VertexQuantization::FloatToUnorm16(float value)
+{
+    return (uint16_t)std::lrint(Clamp(value, 0.0f, 1.0f) * 65535.0f);
+}
+
+uint32_t VertexQuantization::PackSnorm2_10_10_10(float x, float y, float z, float w)
+{
+    uint32_t ix = (uint32_t)std::lrint(Clamp(x, -1.0f, 1.0f) * 511.0f) & 0x3FF;
+    uint32_t iy = (uint32_t)std::lrint(Clamp(y, -1.0f, 1.0f) * 511.0f) & 0x3FF;
+    uint32_t iz = (uint32_t)std::lrint(Clamp(z, -1.0f, 1.0f) * 511.0f) & 0x3FF;
+    uint32_t iw = (uint32_t)std::lrint(Clamp(w, -1.0f, 1.0f)) & 0x3;
+    return ix | (iy << 10) | (iz << 20) | (iw << 30);
+}
+
+bool VertexQuantization::IsSimdEnabled()
+{
+#ifdef OGL_QUANTIZATION_SSE2
+    return true;
+#else
+    return false;
+#endif
+}
+
+#ifdef OGL_QUANTIZATION_SSE2
+//Keeps the low 16 bits of each lane through the signed saturation of _mm_packs_epi32
+static inline __m128i PackLow16(__m128i a, __m128i b)
+{
+    a = _mm_srai_epi32(_mm_slli_epi32(a, 16), 16);
+    b = _mm_srai_epi32(_mm_slli_epi32(b, 16), 16);
+    return _mm_packs_epi32(a, b);
+}
+
+static inline __m128i Select(__m128i mask, __m128i a, __m128i b)
+{
+    return _mm_or_si128(_mm_and_si128(mask, a), _mm_andnot_si128(mask, b));
+}
+
+//FloatToHalf on 4 lanes
+static inline __m128i FloatToHalf4(__m128 value)
+{
+    __m128i bits = _mm_castps_si128(value);
+    __m128i sign = _mm_and_si128(_mm_srli_epi32(bits, 16), _mm_set1_epi32(0x8000));
+    __m128i magnitude = _mm_and_si128(bits, _mm_set1_epi32(0x7FFFFFFF));
+    __m128i half = _mm_srai_epi32(_mm_add_epi32(magnitude, _mm_set1_epi32(-(112 << 23) + (1 << 12))), 13);
+    half = _mm_andnot_si128(_mm_cmplt_epi32(magnitude, _mm_set1_epi32(113 << 23)), half);
+    half = Select(_mm_cmpgt_epi32(magnitude, _mm_set1_epi32((143 << 23) - (1 << 12) - 1)), _mm_set1_epi32(0x7C00), half);
+    half = Select(_mm_cmpgt_epi32(magnitude, _mm_set1_epi32(255 << 23)), _mm_set1_epi32(0x7E00), half);
+    return _mm_or_si128(sign, half);
+}
+
+static inline __m128i Quantize4(__m128 value, float min, float max, float scale)
+{
+    value = _mm_min_ps(_mm_max_ps(value, _mm_set1_ps(min)), _mm_set1_ps(max));
+    return _mm_cvtps_epi32(_mm_mul_ps(value, _mm_set1_ps(scale)));
+}
+#endif
+
+void VertexQuantization::ToHalf(const float* src, Half* dst, unsigned int count)
+{
+    unsigned int i = 0;
+#ifdef OGL_QUANTIZATION_SSE2
+    for (; i + 8 <= count; i += 8)
+    {
+        __m128i packed = PackLow16(FloatToHalf4(_mm_loadu_ps(src + i)), FloatToHalf4(_mm_loadu_ps(src + i + 4)));
+        _mm_storeu_si128((__m128i*)(dst + i), packed);
+    }
+#endif
+    for (; i < count; i++)
+        dst[i].Bits = FloatToHalf(src[i]);
+}
+
+void VertexQuantization::ToSnorm16(const float* src, Snorm16* dst, unsigned int count)
+{
+    unsigned int i = 0;
+#ifdef OGL_QUANTIZATION_SSE2
+    for (; i + 8 <= count; i += 8)
+    {
+        __m128i a = Quantize4(_mm_loadu_ps(src + i), -1.0f, 1.0f, 32767.0f);
+        __m128i b = Quantize4(_mm_loadu_ps(src + i + 4), -1.0f, 1.0f, 32767.0f);
+        _mm_storeu_si128((__m128i*)(dst + i), _mm_packs_epi32(a, b));
+    }
+#endif
+    for (; i < count; i++)
+        dst[i].Value = FloatToSnorm16(src[i]);
+}
+
+void VertexQuantization::ToUnorm16(const float* src, Unorm16* dst, unsigned int count)
+{
+    unsigned int i = 0;
+#ifdef OGL_QUANTIZATION_SSE2
+    for (; i + 8 <= count; i += 8)
+    {
+        __m128i a = Quantize4(_mm_loadu_ps(src + i), 0.0f, 1.0f, 65535.0f);
+        __m128i b = Quantize4(_mm_loadu_ps(src + i + 4), 0.0f, 1.0f, 65535.0f);
+        _mm_storeu_si128((__m128i*)(dst + i), PackLow16(a, b));
+    }
+#endif
+    for (; i < count; i++)
+        dst[i].Value = FloatToUnorm16(src[i]);
+}
+
+/* @brief: The SIMD path works on 4 vectors at a time, one component of each per register
+*/
+void VertexQuantization::ToSnorm2_10_10_10(const float* src, Snorm2_10_10_10* dst, unsigned int vectorCount, unsigned int components)
+{
+    unsigned int i = 0;
+#ifdef OGL_QUANTIZATION_SSE2
+    for (; i + 4 <= vectorCount; i += 4)
+    {
+        const float* v = src + i * components;
+        unsigned int c = components;
+        __m128 x = _mm_setr_ps(v[0], v[c], v[2 * c], v[3 * c]);
+        __m128 y = _mm_setr_ps(v[1], v[c + 1], v[2 * c + 1], v[3 * c + 1]);
+        __m128 z = _mm_setr_ps(v[2], v[c + 2], v[2 * c + 2], v[3 * c + 2]);
+        __m128 w = c == 4 ? _mm_setr_ps(v[3], v[7], v[11], v[15]) : _mm_setzero_ps();
+
+        __m128i mask10 = _mm_set1_epi32(0x3FF);
+        __m128i ix = _mm_and_si128(Quantize4(x, -1.0f, 1.0f, 511.0f), mask10);
+        __m128i iy = _mm_and_si128(Quantize4(y, -1.0f, 1.0f, 511.0f), mask10);
+        __m128i iz = _mm_and_si128(Quantize4(z, -1.0f, 1.0f, 511.0f), mask10);
+        __m128i iw = Quantize4(w, -1.0f, 1.0f, 1.0f);
+        __m128i packed = _mm_or_si128(_mm_or_si128(ix, _mm_slli_epi32(iy, 10)),
+            _mm_or_si128(_mm_slli_epi32(iz, 20), _mm_slli_epi32(iw, 30)));
+        _mm_storeu_si128((__m128i*)(dst + i), packed);
+    }
+#endif
+    for (; i < vectorCount; i++)
+    {
+        const float* v = src + i * components;
+        dst[i].Bits = PackSnorm2_10_10_10(v[0], v[1], v[2], components == 4 ? v[3] : 0.0f);
+    }
+}
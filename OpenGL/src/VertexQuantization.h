@@ -0,0 +1,46 @@
+#pragma once
+#include <cstdint>
+
+/* Compact vertex component types, VertexBufferLayout::Push<T> maps each one to its GL type and normalization.
+   They are plain storage, VertexQuantization fills them from float streams. */
+
+//IEEE 754 binary16, read as a float by the GPU (GL_HALF_FLOAT). ~3 significant digits, good for UVs in [0, 1] and colors
+struct Half {
+	uint16_t Bits;
+};
+
+//[-1, 1] in 16 bit (GL_SHORT normalized), positions inside a known bounding box or signed UVs
+struct Snorm16 {
+	int16_t Value;
+};
+
+//[0, 1] in 16 bit (GL_UNSIGNED_SHORT normalized), UVs and weights
+struct Unorm16 {
+	uint16_t Value;
+};
+
+//4 signed components in 32 bit, 10 bits for xyz and 2 for w (GL_INT_2_10_10_10_REV normalized), normals and tangents
+struct Snorm2_10_10_10 {
+	uint32_t Bits;
+};
+
+/* Float stream to compact stream conversions. All of them round to nearest and clamp to the range of the format,
+   the half conversion also flushes values under the smallest normal half (6.1e-5) to 0 and saturates to infinity.
+   SSE2 does 4 or 8 values at a time where available, the scalar path gives the same bits. */
+class VertexQuantization {
+public:
+	static void ToHalf(const float* src, Half* dst, unsigned int count);
+	static void ToSnorm16(const float* src, Snorm16* dst, unsigned int count);
+	static void ToUnorm16(const float* src, Unorm16* dst, unsigned int count);
+	//src holds vectorCount vectors of components (3 or 4) floats, a missing w is 0
+	static void ToSnorm2_10_10_10(const float* src, Snorm2_10_10_10* dst, unsigned int vectorCount, unsigned int components);
+
+	//Single values, what the SIMD paths compute for each lane
+	static uint16_t FloatToHalf(float value);
+	static float HalfToFloat(uint16_t bits);
+	static int16_t FloatToSnorm16(float value);
+	static uint16_t FloatToUnorm16(float value);
+	static uint32_t PackSnorm2_10_10_10(float x, float y, float z, float w);
+
+	static bool IsSimdEnabled();
+};